@@ -18,8 +18,23 @@ target_link_libraries(${TGT1} PRIVATE
   # Static Libraries
   CppUTest
   adesto_common_tests
+  adesto_async
+  adesto_batch
+  adesto_completion
   adesto_core
+  adesto_erase_map
+  adesto_erase_pool
+  adesto_littlefs
+  adesto_sfdp
+  adesto_sfdp_spi
+  adesto_stream
+  adesto_stream_spi
+  adesto_trace
+  adesto_txn
+  adesto_wear
+  adesto_workload
   aurora_core
+  lfs_core
   chimera_src
   freertos_cfg
   freertos_core
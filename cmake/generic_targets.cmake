@@ -0,0 +1,189 @@
+# ====================================================
+# Host Only Libraries
+# ====================================================
+add_subdirectory("${PROJECT_ROOT}/src/sim")
+
+# ====================================================
+# Host Tools
+# ====================================================
+set(TGT1 trace_decode)
+add_executable(${TGT1} "${PROJECT_ROOT}/tools/${TGT1}/${TGT1}.cpp")
+target_include_directories(${TGT1} PRIVATE ${PROJECT_ROOT})
+
+set(TGT2 trace_replay)
+add_executable(${TGT2} "${PROJECT_ROOT}/tools/${TGT2}/${TGT2}.cpp")
+target_link_libraries(${TGT2} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_erase_map
+  adesto_sim
+  adesto_trace_replay
+  aurora_core
+)
+target_include_directories(${TGT2} PRIVATE ${PROJECT_ROOT})
+
+set(TGT3 workload)
+add_executable(${TGT3} "${PROJECT_ROOT}/tools/${TGT3}/${TGT3}.cpp")
+target_link_libraries(${TGT3} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_erase_map
+  adesto_sim
+  adesto_workload
+  aurora_core
+)
+target_include_directories(${TGT3} PRIVATE ${PROJECT_ROOT})
+
+set(TGT4 wear)
+add_executable(${TGT4} "${PROJECT_ROOT}/tools/${TGT4}/${TGT4}.cpp")
+target_link_libraries(${TGT4} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_sim
+  adesto_stream
+  adesto_wear
+  aurora_core
+)
+target_include_directories(${TGT4} PRIVATE ${PROJECT_ROOT})
+
+set(TGT5 fs_bench)
+add_executable(${TGT5} "${PROJECT_ROOT}/tools/${TGT5}/${TGT5}.cpp")
+target_link_libraries(${TGT5} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+  lfs_inc
+
+  # Static Libraries
+  adesto_littlefs
+  adesto_sim
+  aurora_core
+  lfs_core
+)
+target_include_directories(${TGT5} PRIVATE ${PROJECT_ROOT})
+
+set(TGT6 power_fail)
+add_executable(${TGT6} "${PROJECT_ROOT}/tools/${TGT6}/${TGT6}.cpp")
+target_link_libraries(${TGT6} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_sim
+  adesto_stream
+  adesto_txn
+  aurora_core
+)
+target_include_directories(${TGT6} PRIVATE ${PROJECT_ROOT})
+
+set(TGT7 endurance)
+add_executable(${TGT7} "${PROJECT_ROOT}/tools/${TGT7}/${TGT7}.cpp")
+target_link_libraries(${TGT7} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_sim
+  adesto_stream
+  adesto_txn
+  aurora_core
+)
+target_include_directories(${TGT7} PRIVATE ${PROJECT_ROOT})
+
+# ====================================================
+# Host Tests
+# ====================================================
+set(TGT8 test_host)
+add_executable(${TGT8}
+  "${PROJECT_ROOT}/tests/host/${TGT8}.cpp"
+  "${PROJECT_ROOT}/tests/host/test_async.cpp"
+  "${PROJECT_ROOT}/tests/host/test_batch.cpp"
+  "${PROJECT_ROOT}/tests/host/test_completion.cpp"
+  "${PROJECT_ROOT}/tests/host/test_erase_map.cpp"
+  "${PROJECT_ROOT}/tests/host/test_erase_pool.cpp"
+  "${PROJECT_ROOT}/tests/host/test_sfdp.cpp"
+  "${PROJECT_ROOT}/tests/host/test_sim_endurance.cpp"
+  "${PROJECT_ROOT}/tests/host/test_stream.cpp"
+  "${PROJECT_ROOT}/tests/host/test_trace.cpp"
+  "${PROJECT_ROOT}/tests/host/test_txn.cpp"
+  "${PROJECT_ROOT}/tests/host/test_wear.cpp"
+)
+target_link_libraries(${TGT8} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+  CppUTest_inc
+
+  # Static Libraries
+  CppUTest
+  adesto_async
+  adesto_batch
+  adesto_completion
+  adesto_erase_map
+  adesto_erase_pool
+  adesto_sfdp
+  adesto_sim
+  adesto_stream
+  adesto_trace
+  adesto_txn
+  adesto_wear
+  aurora_core
+)
+target_include_directories(${TGT8} PRIVATE ${PROJECT_ROOT})
+add_test(NAME ${TGT8} COMMAND ${TGT8})
+
+# ====================================================
+# Performance Gate
+#   Fails on simulated time only. CPU time is reported
+#   against a Release baseline; pass --gate-cpu to the
+#   executable to fail on it as well.
+# ====================================================
+set(TGT9 perf_gate)
+add_executable(${TGT9} "${PROJECT_ROOT}/tests/perf/${TGT9}.cpp")
+target_link_libraries(${TGT9} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_sim
+  adesto_stream
+  adesto_wear
+  aurora_core
+)
+target_include_directories(${TGT9} PRIVATE ${PROJECT_ROOT})
+add_test(
+  NAME ${TGT9}
+  COMMAND ${TGT9} --baseline "${PROJECT_ROOT}/tests/perf/baseline.txt"
+)
+set_tests_properties(${TGT9} PROPERTIES LABELS perf RUN_SERIAL TRUE)
+
+# ====================================================
+# Batch Overhead Comparison
+#   Report only, not registered with ctest
+# ====================================================
+set(TGT10 batch_bench)
+add_executable(${TGT10} "${PROJECT_ROOT}/tools/${TGT10}/${TGT10}.cpp")
+target_link_libraries(${TGT10} PRIVATE
+  # Public Includes
+  aurora_inc
+  chimera_inc
+
+  # Static Libraries
+  adesto_batch
+  adesto_completion
+  adesto_sim
+  aurora_core
+)
+target_include_directories(${TGT10} PRIVATE ${PROJECT_ROOT})
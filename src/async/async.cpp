@@ -0,0 +1,383 @@
+/********************************************************************************
+ *  File Name:
+ *    async.cpp
+ *
+ *  Description:
+ *    Coroutine executor implementation
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstdlib>
+
+/* Adesto Includes */
+#include <src/async/async.hpp>
+
+namespace Adesto::Async
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static Event completionEvent( const OpType type )
+  {
+    switch ( type )
+    {
+      case OpType::READ:
+        return Event::MEM_READ_COMPLETE;
+
+      case OpType::WRITE:
+        return Event::MEM_WRITE_COMPLETE;
+
+      case OpType::ERASE:
+      case OpType::ERASE_CHIP:
+      default:
+        return Event::MEM_ERASE_COMPLETE;
+    }
+  }
+
+  /*-------------------------------------------------------------------------------
+  Task Implementation
+  -------------------------------------------------------------------------------*/
+  Task Task::promise_type::get_return_object() noexcept
+  {
+    return Task( Handle::from_promise( *this ) );
+  }
+
+
+  Task Task::promise_type::get_return_object_on_allocation_failure() noexcept
+  {
+    return Task();
+  }
+
+
+  std::suspend_always Task::promise_type::initial_suspend() noexcept
+  {
+    return {};
+  }
+
+
+  void Task::promise_type::return_void() noexcept
+  {
+  }
+
+
+  void Task::promise_type::unhandled_exception() noexcept
+  {
+    /*-------------------------------------------------
+    Only reachable on builds with exceptions enabled.
+    There is nobody to report to, so stop hard.
+    -------------------------------------------------*/
+    abort();
+  }
+
+
+  Task::Task() noexcept : mHandle( nullptr )
+  {
+  }
+
+
+  Task::Task( Handle handle ) noexcept : mHandle( handle )
+  {
+  }
+
+
+  Task::Task( Task &&other ) noexcept : mHandle( other.release() )
+  {
+  }
+
+
+  Task::~Task()
+  {
+    /*-------------------------------------------------
+    Never handed to an executor, so never started
+    -------------------------------------------------*/
+    if ( mHandle )
+    {
+      mHandle.destroy();
+    }
+  }
+
+
+  bool Task::valid() const noexcept
+  {
+    return static_cast<bool>( mHandle );
+  }
+
+
+  Task::Handle Task::release() noexcept
+  {
+    Handle handle = mHandle;
+    mHandle       = nullptr;
+    return handle;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Operation Implementation
+  -------------------------------------------------------------------------------*/
+  Operation::Operation( Executor &executor, const OpType type, const size_t address, void *const data,
+                        const size_t length ) :
+      mExecutor( executor ), mType( type ), mAddress( address ), mData( data ), mLength( length ), mResult( Status::ERR_OK ),
+      mWaiter( nullptr ), mNext( nullptr )
+  {
+  }
+
+
+  bool Operation::await_ready() const noexcept
+  {
+    return false;
+  }
+
+
+  void Operation::await_suspend( Task::Handle handle ) noexcept
+  {
+    mWaiter = handle;
+    mExecutor.enqueue( *this );
+  }
+
+
+  Status Operation::await_resume() const noexcept
+  {
+    return mResult;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Executor Implementation
+  -------------------------------------------------------------------------------*/
+  Executor::Executor( IGenericDevice_sPtr device ) :
+      mDevice( device ), mReadyHead( nullptr ), mReadyTail( nullptr ), mQueueHead( nullptr ), mQueueTail( nullptr ),
+      mInFlight( nullptr ), mActive( 0 )
+  {
+  }
+
+
+  Executor::~Executor()
+  {
+    /*-------------------------------------------------
+    Drop any jobs that never ran to completion. Frames
+    suspended on an operation are reachable through it.
+    -------------------------------------------------*/
+    while ( mReadyHead )
+    {
+      auto promise = mReadyHead;
+      mReadyHead   = promise->next;
+      Task::Handle::from_promise( *promise ).destroy();
+    }
+
+    if ( mInFlight )
+    {
+      mInFlight->mWaiter.destroy();
+    }
+
+    while ( mQueueHead )
+    {
+      auto op    = mQueueHead;
+      mQueueHead = op->mNext;
+      op->mWaiter.destroy();
+    }
+  }
+
+
+  Status Executor::spawn( Task &&task )
+  {
+    if ( !task.valid() )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    auto handle               = task.release();
+    handle.promise().executor = this;
+    handle.promise().next     = nullptr;
+
+    mActive++;
+    makeReady( handle.promise() );
+    return Status::ERR_OK;
+  }
+
+
+  void Executor::run()
+  {
+    while ( poll( WAIT_FOREVER ) )
+    {
+      continue;
+    }
+  }
+
+
+  bool Executor::poll( const size_t timeout )
+  {
+    /*-------------------------------------------------
+    Wait on the device only when nothing else can make
+    progress, otherwise just check on it.
+    -------------------------------------------------*/
+    if ( mInFlight )
+    {
+      const Status result = mDevice->pendEvent( completionEvent( mInFlight->mType ), mReadyHead ? DONT_WAIT : timeout );
+      if ( result != Status::ERR_TIMEOUT )
+      {
+        complete( result );
+        issue();
+      }
+    }
+
+    /*-------------------------------------------------
+    Run everything that's ready. Jobs readied during
+    this pass wait for the next one, so a job that
+    keeps hitting in-memory work can't starve the
+    device.
+    -------------------------------------------------*/
+    auto tail = mReadyTail;
+    while ( mReadyHead )
+    {
+      auto promise = mReadyHead;
+      mReadyHead   = promise->next;
+      if ( !mReadyHead )
+      {
+        mReadyTail = nullptr;
+      }
+
+      Task::Handle::from_promise( *promise ).resume();
+
+      if ( promise == tail )
+      {
+        break;
+      }
+    }
+
+    issue();
+    return mActive != 0;
+  }
+
+
+  size_t Executor::active() const
+  {
+    return mActive;
+  }
+
+
+  Operation Executor::read( const size_t address, void *const data, const size_t length )
+  {
+    return Operation( *this, OpType::READ, address, data, length );
+  }
+
+
+  Operation Executor::write( const size_t address, const void *const data, const size_t length )
+  {
+    return Operation( *this, OpType::WRITE, address, const_cast<void *>( data ), length );
+  }
+
+
+  Operation Executor::erase( const size_t address, const size_t length )
+  {
+    return Operation( *this, OpType::ERASE, address, nullptr, length );
+  }
+
+
+  Operation Executor::eraseChip()
+  {
+    return Operation( *this, OpType::ERASE_CHIP, 0, nullptr, 0 );
+  }
+
+
+  void Executor::makeReady( Task::promise_type &promise )
+  {
+    promise.next = nullptr;
+
+    if ( mReadyTail )
+    {
+      mReadyTail->next = &promise;
+    }
+    else
+    {
+      mReadyHead = &promise;
+    }
+
+    mReadyTail = &promise;
+  }
+
+
+  void Executor::enqueue( Operation &op )
+  {
+    op.mNext = nullptr;
+
+    if ( mQueueTail )
+    {
+      mQueueTail->mNext = &op;
+    }
+    else
+    {
+      mQueueHead = &op;
+    }
+
+    mQueueTail = &op;
+    issue();
+  }
+
+
+  void Executor::issue()
+  {
+    /*-------------------------------------------------
+    Start queued operations until one of them leaves
+    the device busy. Reads finish inside the call, so
+    they complete on the spot.
+    -------------------------------------------------*/
+    while ( !mInFlight && mQueueHead )
+    {
+      mInFlight  = mQueueHead;
+      mQueueHead = mInFlight->mNext;
+      if ( !mQueueHead )
+      {
+        mQueueTail = nullptr;
+      }
+
+      auto &op      = *mInFlight;
+      Status result = Status::ERR_OK;
+
+      switch ( op.mType )
+      {
+        case OpType::READ:
+          complete( mDevice->read( op.mAddress, op.mData, op.mLength ) );
+          continue;
+
+        case OpType::WRITE:
+          result = mDevice->write( op.mAddress, op.mData, op.mLength );
+          break;
+
+        case OpType::ERASE:
+          result = mDevice->erase( op.mAddress, op.mLength );
+          break;
+
+        case OpType::ERASE_CHIP:
+          result = mDevice->eraseChip();
+          break;
+
+        default:
+          result = Status::ERR_BAD_ARG;
+          break;
+      }
+
+      if ( result != Status::ERR_OK )
+      {
+        complete( result );
+      }
+    }
+  }
+
+
+  void Executor::complete( const Status result )
+  {
+    auto op     = mInFlight;
+    mInFlight   = nullptr;
+    op->mResult = result;
+    makeReady( op->mWaiter.promise() );
+  }
+
+
+  void Executor::retire( Task::Handle handle )
+  {
+    handle.destroy();
+    mActive--;
+  }
+}  // namespace Adesto::Async
@@ -0,0 +1,236 @@
+/********************************************************************************
+ *  File Name:
+ *    async.hpp
+ *
+ *  Description:
+ *    C++20 coroutine interface to a generic memory device. Device operations
+ *    become awaitables and a single executor task drives any number of jobs,
+ *    issuing their operations back to back so the part never sits idle while
+ *    there is queued work.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_ASYNC_HPP
+#define ADESTO_ASYNC_HPP
+
+/* STL Includes */
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::Async
+{
+  /*-------------------------------------------------------------------------------
+  Forward Declarations
+  -------------------------------------------------------------------------------*/
+  class Executor;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t WAIT_FOREVER = std::numeric_limits<size_t>::max();
+  static constexpr size_t DONT_WAIT    = 0;
+
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  enum class OpType : uint8_t
+  {
+    READ,
+    WRITE,
+    ERASE,
+    ERASE_CHIP,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Return type of a flash job. Jobs are created suspended and only begin to
+   *  run once handed to Executor::spawn(), which then owns the frame.
+   *
+   *  Coroutine frames come from the heap. Without exceptions, a failed frame
+   *  allocation yields an empty Task that spawn() will reject.
+   */
+  class Task
+  {
+  public:
+    struct promise_type
+    {
+      Executor *executor;
+      promise_type *next; /**< Executor ready list linkage */
+
+      Task get_return_object() noexcept;
+      static Task get_return_object_on_allocation_failure() noexcept;
+      std::suspend_always initial_suspend() noexcept;
+      auto final_suspend() noexcept;
+      void return_void() noexcept;
+      void unhandled_exception() noexcept;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() noexcept;
+    Task( Task &&other ) noexcept;
+    Task( const Task & ) = delete;
+    Task &operator=( const Task & ) = delete;
+    ~Task();
+
+    /**
+     *  Whether the coroutine frame was allocated
+     *
+     *  @return bool
+     */
+    bool valid() const noexcept;
+
+  private:
+    friend class Executor;
+    explicit Task( Handle handle ) noexcept;
+
+    Handle release() noexcept;
+    Handle mHandle;
+  };
+
+
+  /**
+   *  Awaitable for one device operation. Lives in the awaiting coroutine's
+   *  frame while suspended, so queueing an operation never allocates.
+   */
+  class Operation
+  {
+  public:
+    Operation( Executor &executor, const OpType type, const size_t address, void *const data, const size_t length );
+
+    bool await_ready() const noexcept;
+    void await_suspend( Task::Handle handle ) noexcept;
+    Aurora::Memory::Status await_resume() const noexcept;
+
+  private:
+    friend class Executor;
+
+    Executor &mExecutor;
+    OpType mType;
+    size_t mAddress;
+    void *mData;
+    size_t mLength;
+    Aurora::Memory::Status mResult;
+    Task::Handle mWaiter;
+    Operation *mNext;
+  };
+
+
+  /**
+   *  Multiplexes flash jobs onto one device from a single task. Not thread
+   *  safe: spawn() and run() must be called from the task that owns it.
+   */
+  class Executor
+  {
+  public:
+    /**
+     *  @param[in]  device    Device the jobs operate on
+     */
+    Executor( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Executor();
+
+    /**
+     *  Queues a job to start on the next pass of the executor
+     *
+     *  @param[in]  task      Job to take ownership of
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status spawn( Task &&task );
+
+    /**
+     *  Runs ready jobs and services the device until every job has finished
+     *
+     *  @return void
+     */
+    void run();
+
+    /**
+     *  Performs a single scheduling pass: completes the operation in flight
+     *  if the device is done, issues the next queued operation, then resumes
+     *  every job that is ready.
+     *
+     *  @param[in]  timeout   How long to wait on the device when no job is ready
+     *  @return bool          True while jobs remain
+     */
+    bool poll( const size_t timeout );
+
+    /**
+     *  Number of spawned jobs that haven't finished
+     *
+     *  @return size_t
+     */
+    size_t active() const;
+
+    /*-------------------------------------------------
+    Awaitable device operations. Each completes with
+    the operation's final status, including the wait
+    for the matching MEM_*_COMPLETE event.
+    -------------------------------------------------*/
+    Operation read( const size_t address, void *const data, const size_t length );
+    Operation write( const size_t address, const void *const data, const size_t length );
+    Operation erase( const size_t address, const size_t length );
+    Operation eraseChip();
+
+  private:
+    friend class Operation;
+    friend struct Task::promise_type;
+
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Task::promise_type *mReadyHead;
+    Task::promise_type *mReadyTail;
+    Operation *mQueueHead;
+    Operation *mQueueTail;
+    Operation *mInFlight;
+    size_t mActive;
+
+    void makeReady( Task::promise_type &promise );
+    void enqueue( Operation &op );
+    void issue();
+    void complete( const Aurora::Memory::Status result );
+    void retire( Task::Handle handle );
+  };
+
+  /*-------------------------------------------------------------------------------
+  Inline Implementation
+  -------------------------------------------------------------------------------*/
+  inline auto Task::promise_type::final_suspend() noexcept
+  {
+    /*-------------------------------------------------
+    Hand the finished frame back to the executor, which
+    destroys it. Suspending keeps the frame valid until
+    that happens.
+    -------------------------------------------------*/
+    struct FinalAwaiter
+    {
+      bool await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void await_suspend( Handle handle ) noexcept
+      {
+        handle.promise().executor->retire( handle );
+      }
+
+      void await_resume() const noexcept
+      {
+      }
+    };
+
+    return FinalAwaiter{};
+  }
+}  // namespace Adesto::Async
+
+#endif /* !ADESTO_ASYNC_HPP */
@@ -0,0 +1,339 @@
+/********************************************************************************
+ *  File Name:
+ *    batch.cpp
+ *
+ *  Description:
+ *    Implementation of the command list engine
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/batch/batch.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/common>
+
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+/* STL Includes */
+#include <chrono>
+#endif
+
+namespace Adesto::Batch
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t STOP_POLL_MS = 1;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static Event completionEvent( const CmdType type )
+  {
+    switch ( type )
+    {
+      case CmdType::READ:
+        return Event::MEM_READ_COMPLETE;
+
+      case CmdType::WRITE:
+        return Event::MEM_WRITE_COMPLETE;
+
+      case CmdType::ERASE:
+      default:
+        return Event::MEM_ERASE_COMPLETE;
+    }
+  }
+
+
+  static uint32_t nowUs()
+  {
+#if defined( EMBEDDED )
+    return static_cast<uint32_t>( Chimera::micros() );
+#else
+    using namespace std::chrono;
+    return static_cast<uint32_t>( duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count() );
+#endif
+  }
+
+
+  static Status issue( IGenericDevice &device, const Command &cmd )
+  {
+    Status result = Status::ERR_BAD_ARG;
+
+    switch ( cmd.type )
+    {
+      case CmdType::READ:
+        /*-------------------------------------------------
+        Reads finish inside the call, there is no event
+        -------------------------------------------------*/
+        return device.read( cmd.address, cmd.data, cmd.length );
+
+      case CmdType::WRITE:
+        result = device.write( cmd.address, cmd.data, cmd.length );
+        break;
+
+      case CmdType::ERASE:
+        result = device.erase( cmd.address, cmd.length );
+        break;
+
+      default:
+        return Status::ERR_BAD_ARG;
+    }
+
+    if ( result == Status::ERR_OK )
+    {
+      result = device.pendEvent( completionEvent( cmd.type ), Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    return result;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Engine Implementation
+  -------------------------------------------------------------------------------*/
+  Engine::Engine( IGenericDevice_sPtr device ) :
+      mDevice( device ), mLists( 0 ), mCommands( 0 ), mFailedLists( 0 ), mRunning( false ),
+#if defined( EMBEDDED )
+      mExited( true )
+#else
+      mPending( false )
+#endif
+  {
+  }
+
+
+  Engine::~Engine()
+  {
+    stop();
+  }
+
+
+  Status Engine::start()
+  {
+    if ( !mDevice )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( mRunning )
+    {
+      return Status::ERR_OK;
+    }
+
+    mRunning = true;
+
+#if defined( EMBEDDED )
+    using namespace Chimera::Threading;
+
+    /*-------------------------------------------------
+    Above the callers, so the next command issues as
+    soon as the device finishes the last one.
+    -------------------------------------------------*/
+    mExited = false;
+    mThread.initialize( workerTask, this, Priority::LEVEL_3, STACK_KILOBYTES( WORKER_STACK_KB ), "batch" );
+    mThread.start();
+#else
+    mThread = std::thread( [ this ]() { workerLoop(); } );
+#endif
+
+    return Status::ERR_OK;
+  }
+
+
+  void Engine::stop()
+  {
+    if ( !mRunning )
+    {
+      return;
+    }
+
+    mRunning = false;
+    wake();
+
+#if defined( EMBEDDED )
+    while ( !mExited )
+    {
+      Chimera::delayMilliseconds( STOP_POLL_MS );
+    }
+#else
+    mThread.join();
+#endif
+  }
+
+
+  Status Engine::submit( List &list )
+  {
+    if ( !mRunning )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( !list.commands && list.count )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    list.id       = mCompletions.nextId();
+    list.executed = 0;
+
+    if ( !mSubmitted.push( &list ) )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    wake();
+    return Status::ERR_OK;
+  }
+
+
+  Status Engine::wait( List &list, const size_t timeout )
+  {
+    Completion::Record record;
+
+    const auto result = mCompletions.waitFor( list.id, record, timeout );
+    if ( result != Status::ERR_OK )
+    {
+      return result;
+    }
+
+    return static_cast<Status>( record.status );
+  }
+
+
+  Status Engine::execute( List &list, const size_t timeout )
+  {
+    const auto result = submit( list );
+    return ( result == Status::ERR_OK ) ? wait( list, timeout ) : result;
+  }
+
+
+  Stats Engine::getStats() const
+  {
+    return { mLists.load(), mCommands.load(), mFailedLists.load() };
+  }
+
+
+  void Engine::lockDevice()
+  {
+    mDeviceLock.lock();
+  }
+
+
+  void Engine::unlockDevice()
+  {
+    mDeviceLock.unlock();
+  }
+
+
+#if defined( EMBEDDED )
+  void Engine::workerTask( void *arg )
+  {
+    auto engine = static_cast<Engine *>( arg );
+    engine->workerLoop();
+
+    /*-------------------------------------------------
+    The engine may be gone as soon as it sees mExited
+    -------------------------------------------------*/
+    engine->mExited = true;
+    vTaskDelete( nullptr );
+  }
+#endif
+
+
+  void Engine::workerLoop()
+  {
+    while ( true )
+    {
+      List *list = nullptr;
+      while ( mSubmitted.pop( list ) )
+      {
+        runList( *list );
+      }
+
+      /*-------------------------------------------------
+      Everything queued before stop() has been run
+      -------------------------------------------------*/
+      if ( !mRunning )
+      {
+        return;
+      }
+
+      sleep();
+    }
+  }
+
+
+  void Engine::wake()
+  {
+#if defined( EMBEDDED )
+    mWake.release();
+#else
+    std::lock_guard<std::mutex> lock( mLock );
+    mPending = true;
+    mWake.notify_one();
+#endif
+  }
+
+
+  void Engine::sleep()
+  {
+#if defined( EMBEDDED )
+    mWake.acquire();
+#else
+    std::unique_lock<std::mutex> lock( mLock );
+    mWake.wait( lock, [ this ]() { return mPending; } );
+    mPending = false;
+#endif
+  }
+
+
+  void Engine::runList( List &list )
+  {
+    Status result = Status::ERR_OK;
+    Event last    = Event::MEM_READ_COMPLETE;
+
+    /*-------------------------------------------------
+    Hold the device for the whole list, so no one else
+    sharing it can interleave commands or consume one
+    of its completion events.
+    -------------------------------------------------*/
+    mDeviceLock.lock();
+
+    for ( size_t x = 0; ( x < list.count ) && ( result == Status::ERR_OK ); x++ )
+    {
+      auto &cmd  = list.commands[ x ];
+      cmd.status = issue( *mDevice, cmd );
+      result     = cmd.status;
+      last       = completionEvent( cmd.type );
+      list.executed++;
+    }
+
+    mDeviceLock.unlock();
+
+    mLists++;
+    mCommands += list.executed;
+    mFailedLists += ( result != Status::ERR_OK );
+
+    /*-------------------------------------------------
+    One completion for the whole list. Posting releases
+    the list's results to the waiting task.
+    -------------------------------------------------*/
+    Completion::Record record;
+    record.id        = list.id;
+    record.event     = static_cast<uint8_t>( last );
+    record.status    = static_cast<uint8_t>( result );
+    record.timestamp = nowUs();
+
+    mCompletions.post( record );
+  }
+}  // namespace Adesto::Batch
@@ -0,0 +1,31 @@
+/********************************************************************************
+ *  File Name:
+ *    clock.hpp
+ *
+ *  Description:
+ *    Pluggable time source used by the measurement tooling. On hardware this
+ *    reads the system clock, on the simulator it reads the virtual device clock
+ *    so that results are deterministic.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_COMMON_CLOCK_HPP
+#define ADESTO_COMMON_CLOCK_HPP
+
+/* STL Includes */
+#include <cstdint>
+
+namespace Adesto
+{
+  /**
+   *  Returns the current time in microseconds
+   *
+   *  @param[in]  context   User data registered alongside the function
+   *  @return uint64_t
+   */
+  using ClockFunc = uint64_t ( * )( void *context );
+}  // namespace Adesto
+
+#endif /* !ADESTO_COMMON_CLOCK_HPP */
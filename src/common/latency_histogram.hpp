@@ -0,0 +1,170 @@
+/********************************************************************************
+ *  File Name:
+ *    latency_histogram.hpp
+ *
+ *  Description:
+ *    Fixed size log-linear histogram for latency samples. Memory use does not
+ *    grow with the number of samples, so it can sit on the target alongside
+ *    a long running workload and still answer percentile queries. Each power
+ *    of two is split into four buckets, giving a worst case error of 25%.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_COMMON_LATENCY_HISTOGRAM_HPP
+#define ADESTO_COMMON_LATENCY_HISTOGRAM_HPP
+
+/* STL Includes */
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Adesto
+{
+  class LatencyHistogram
+  {
+  public:
+    static constexpr size_t SUB_BITS    = 2;
+    static constexpr size_t SUB_BUCKETS = 1u << SUB_BITS;
+    static constexpr size_t NUM_BUCKETS = ( 32 - SUB_BITS + 1 ) * SUB_BUCKETS;
+
+    LatencyHistogram()
+    {
+      clear();
+    }
+
+    void clear()
+    {
+      mBuckets.fill( 0 );
+      mCount = 0;
+      mTotal = 0;
+      mMin   = std::numeric_limits<uint32_t>::max();
+      mMax   = 0;
+    }
+
+    /**
+     *  Adds a sample to the histogram
+     *
+     *  @param[in]  value     Sample, typically in microseconds
+     *  @return void
+     */
+    void record( const uint32_t value )
+    {
+      mBuckets[ bucketIndex( value ) ]++;
+      mCount++;
+      mTotal += value;
+      mMin = std::min( mMin, value );
+      mMax = std::max( mMax, value );
+    }
+
+    /**
+     *  Folds another histogram's samples into this one
+     *
+     *  @param[in]  other     Histogram to merge
+     *  @return void
+     */
+    void merge( const LatencyHistogram &other )
+    {
+      for ( size_t x = 0; x < NUM_BUCKETS; x++ )
+      {
+        mBuckets[ x ] += other.mBuckets[ x ];
+      }
+
+      mCount += other.mCount;
+      mTotal += other.mTotal;
+      mMin = std::min( mMin, other.mMin );
+      mMax = std::max( mMax, other.mMax );
+    }
+
+    /**
+     *  Estimates the value below which the given fraction of samples fall.
+     *  Returns the upper edge of the bucket, clamped to the largest sample.
+     *
+     *  @param[in]  fraction  Value in [0, 1], ie 0.99 for p99
+     *  @return uint32_t
+     */
+    uint32_t percentile( const double fraction ) const
+    {
+      if ( !mCount )
+      {
+        return 0;
+      }
+
+      const uint64_t target = static_cast<uint64_t>( fraction * static_cast<double>( mCount ) + 0.5 );
+      uint64_t seen         = 0;
+
+      for ( size_t x = 0; x < NUM_BUCKETS; x++ )
+      {
+        seen += mBuckets[ x ];
+        if ( seen && ( seen >= target ) )
+        {
+          const uint64_t upper = ( x + 1 < NUM_BUCKETS ) ? bucketLowerBound( x + 1 ) - 1 : mMax;
+          return static_cast<uint32_t>( std::clamp<uint64_t>( upper, mMin, mMax ) );
+        }
+      }
+
+      return mMax;
+    }
+
+    uint64_t count() const
+    {
+      return mCount;
+    }
+
+    uint64_t total() const
+    {
+      return mTotal;
+    }
+
+    uint32_t min() const
+    {
+      return mCount ? mMin : 0;
+    }
+
+    uint32_t max() const
+    {
+      return mMax;
+    }
+
+    double mean() const
+    {
+      return mCount ? static_cast<double>( mTotal ) / static_cast<double>( mCount ) : 0.0;
+    }
+
+  private:
+    std::array<uint32_t, NUM_BUCKETS> mBuckets;
+    uint64_t mCount;
+    uint64_t mTotal;
+    uint32_t mMin;
+    uint32_t mMax;
+
+    static size_t bucketIndex( const uint32_t value )
+    {
+      if ( value < SUB_BUCKETS )
+      {
+        return value;
+      }
+
+      const size_t msb = 31u - static_cast<size_t>( __builtin_clz( value ) );
+      const size_t sub = ( value >> ( msb - SUB_BITS ) ) & ( SUB_BUCKETS - 1 );
+      return ( ( msb - SUB_BITS + 1 ) * SUB_BUCKETS ) + sub;
+    }
+
+    static uint64_t bucketLowerBound( const size_t index )
+    {
+      if ( index < SUB_BUCKETS )
+      {
+        return index;
+      }
+
+      const size_t msb = ( index / SUB_BUCKETS ) + SUB_BITS - 1;
+      const size_t sub = index % SUB_BUCKETS;
+      return static_cast<uint64_t>( SUB_BUCKETS + sub ) << ( msb - SUB_BITS );
+    }
+  };
+}  // namespace Adesto
+
+#endif /* !ADESTO_COMMON_LATENCY_HISTOGRAM_HPP */
@@ -0,0 +1,114 @@
+/********************************************************************************
+ *  File Name:
+ *    spsc_ring.hpp
+ *
+ *  Description:
+ *    Lock-free single producer, single consumer ring buffer. Safe to push from
+ *    one context (thread or ISR) while popping from another without any RTOS
+ *    primitives, provided each side only ever has one caller.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_COMMON_SPSC_RING_HPP
+#define ADESTO_COMMON_SPSC_RING_HPP
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Adesto
+{
+  /**
+   *  Fixed capacity ring with free running 32-bit indices. The capacity must
+   *  be a power of two so that index wrap-around stays consistent.
+   *
+   *  @tparam T       Element type (should be trivially copyable)
+   *  @tparam SIZE    Number of elements the ring can hold
+   */
+  template<typename T, size_t SIZE>
+  class SPSCRing
+  {
+    static_assert( SIZE && !( SIZE & ( SIZE - 1 ) ), "Ring size must be a power of two" );
+
+  public:
+    SPSCRing() : mHead( 0 ), mTail( 0 )
+    {
+    }
+
+    /**
+     *  Inserts an element. Must only be called from the producer context.
+     *
+     *  @param[in]  item      The element to insert
+     *  @return bool          False if the ring was full and the item dropped
+     */
+    bool push( const T &item )
+    {
+      const uint32_t head = mHead.load( std::memory_order_relaxed );
+      const uint32_t tail = mTail.load( std::memory_order_acquire );
+
+      if ( ( head - tail ) >= SIZE )
+      {
+        return false;
+      }
+
+      mData[ head & MASK ] = item;
+      mHead.store( head + 1, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  Removes the oldest element. Must only be called from the consumer context.
+     *
+     *  @param[out] item      Where to place the removed element
+     *  @return bool          False if the ring was empty
+     */
+    bool pop( T &item )
+    {
+      const uint32_t tail = mTail.load( std::memory_order_relaxed );
+      const uint32_t head = mHead.load( std::memory_order_acquire );
+
+      if ( head == tail )
+      {
+        return false;
+      }
+
+      item = mData[ tail & MASK ];
+      mTail.store( tail + 1, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  Number of elements currently queued. Only a snapshot when called from
+     *  outside the producer or consumer contexts.
+     *
+     *  @return size_t
+     */
+    size_t size() const
+    {
+      return mHead.load( std::memory_order_acquire ) - mTail.load( std::memory_order_acquire );
+    }
+
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+    static constexpr size_t capacity()
+    {
+      return SIZE;
+    }
+
+  private:
+    static constexpr uint32_t MASK = SIZE - 1;
+
+    std::array<T, SIZE> mData;
+    std::atomic<uint32_t> mHead;
+    std::atomic<uint32_t> mTail;
+  };
+}  // namespace Adesto
+
+#endif /* !ADESTO_COMMON_SPSC_RING_HPP */
@@ -0,0 +1,301 @@
+/********************************************************************************
+ *  File Name:
+ *    completion_queue.cpp
+ *
+ *  Description:
+ *    Completion queue implementation. Wake-ups are FreeRTOS direct-to-task
+ *    notifications on target and a condition variable on the host.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* Adesto Includes */
+#include <src/completion/completion_queue.hpp>
+
+#if defined( EMBEDDED )
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+static_assert( Adesto::Completion::NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+#else
+/* STL Includes */
+#include <chrono>
+#endif
+
+namespace Adesto::Completion
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static size_t nowMs()
+  {
+#if defined( EMBEDDED )
+    return static_cast<size_t>( xTaskGetTickCount() ) * portTICK_PERIOD_MS;
+#else
+    using namespace std::chrono;
+    return static_cast<size_t>( duration_cast<milliseconds>( steady_clock::now().time_since_epoch() ).count() );
+#endif
+  }
+
+  /*-------------------------------------------------------------------------------
+  Queue Implementation
+  -------------------------------------------------------------------------------*/
+  Queue::Queue() : mNumHeld( 0 ), mNextId( INVALID_ID ), mOutstanding( 0 ), mDropped( 0 ), mLossy( false )
+  {
+#if defined( EMBEDDED )
+    mWaiter = nullptr;
+#else
+    mNotifications = 0;
+#endif
+  }
+
+
+  Queue::~Queue()
+  {
+  }
+
+
+  uint16_t Queue::nextId()
+  {
+    if ( ++mNextId == INVALID_ID )
+    {
+      ++mNextId;
+    }
+
+    return mNextId;
+  }
+
+
+  bool Queue::post( const Record &record )
+  {
+    return push( record, false );
+  }
+
+
+  bool Queue::postFromISR( const Record &record )
+  {
+    return push( record, true );
+  }
+
+
+  Status Queue::wait( Record &record, const size_t timeout )
+  {
+    return waitFor( INVALID_ID, record, timeout );
+  }
+
+
+  Status Queue::waitFor( const uint16_t id, Record &record, const size_t timeout )
+  {
+#if defined( EMBEDDED )
+    /*-------------------------------------------------
+    Register before checking the ring so a completion
+    posted in between still leaves a pending notify.
+    -------------------------------------------------*/
+    mWaiter = xTaskGetCurrentTaskHandle();
+#endif
+
+    const size_t start = nowMs();
+    Status result      = Status::ERR_TIMEOUT;
+
+    while ( true )
+    {
+      if ( take( id, record ) )
+      {
+        result = Status::ERR_OK;
+        break;
+      }
+
+      /*-------------------------------------------------
+      Once a completion has been refused there's no way
+      to tell whether this one was it, so don't block.
+      -------------------------------------------------*/
+      if ( mLossy )
+      {
+        result = Status::ERR_FAIL;
+        break;
+      }
+
+      /*-------------------------------------------------
+      Wake-ups for other requests' completions count
+      against the same overall timeout.
+      -------------------------------------------------*/
+      size_t remaining = WAIT_FOREVER;
+      if ( timeout != WAIT_FOREVER )
+      {
+        const size_t elapsed = nowMs() - start;
+        if ( elapsed >= timeout )
+        {
+          break;
+        }
+
+        remaining = timeout - elapsed;
+      }
+
+      if ( !block( remaining ) )
+      {
+        result = take( id, record ) ? Status::ERR_OK : ( mLossy ? Status::ERR_FAIL : Status::ERR_TIMEOUT );
+        break;
+      }
+    }
+
+#if defined( EMBEDDED )
+    /*-------------------------------------------------
+    Posts made while nobody waits must not notify a
+    task that has moved on to something else.
+    -------------------------------------------------*/
+    mWaiter = nullptr;
+#endif
+
+    return result;
+  }
+
+
+  void Queue::reset()
+  {
+    Record discard;
+    while ( mRing.pop( discard ) )
+    {
+      mOutstanding--;
+    }
+
+    mOutstanding -= mNumHeld;
+    mNumHeld = 0;
+    mLossy   = false;
+
+#if !defined( EMBEDDED )
+    std::lock_guard<std::mutex> lock( mLock );
+    mNotifications = 0;
+#endif
+  }
+
+
+  size_t Queue::dropped() const
+  {
+    return mDropped;
+  }
+
+
+  bool Queue::push( const Record &record, const bool fromISR )
+  {
+    /*-------------------------------------------------
+    Only the consumer lowers the count, so a check then
+    increment from the single producer can't overshoot.
+    Counting before the push keeps the consumer's take
+    from ever seeing the record ahead of its count. The
+    bound also means the ring and hold() have room.
+    -------------------------------------------------*/
+    if ( mOutstanding.load() >= QUEUE_DEPTH )
+    {
+      mDropped++;
+      mLossy = true;
+      notify( fromISR );
+      return false;
+    }
+
+    mOutstanding++;
+    mRing.push( record );
+    notify( fromISR );
+    return true;
+  }
+
+
+  bool Queue::take( const uint16_t id, Record &record )
+  {
+    /*-------------------------------------------------
+    Held completions arrived first, so check them first
+    -------------------------------------------------*/
+    for ( size_t x = 0; x < mNumHeld; x++ )
+    {
+      if ( ( id == INVALID_ID ) || ( mHeld[ x ].id == id ) )
+      {
+        record = mHeld[ x ];
+        for ( size_t y = x + 1; y < mNumHeld; y++ )
+        {
+          mHeld[ y - 1 ] = mHeld[ y ];
+        }
+
+        mNumHeld--;
+        mOutstanding--;
+        return true;
+      }
+    }
+
+    /*-------------------------------------------------
+    Drain the ring until the wanted record turns up
+    -------------------------------------------------*/
+    Record next;
+    while ( mRing.pop( next ) )
+    {
+      if ( ( id == INVALID_ID ) || ( next.id == id ) )
+      {
+        record = next;
+        mOutstanding--;
+        return true;
+      }
+
+      hold( next );
+    }
+
+    return false;
+  }
+
+
+  void Queue::hold( const Record &record )
+  {
+    mHeld[ mNumHeld++ ] = record;
+  }
+
+
+  void Queue::notify( const bool fromISR )
+  {
+#if defined( EMBEDDED )
+    auto waiter = static_cast<TaskHandle_t>( mWaiter.load() );
+    if ( !waiter )
+    {
+      return;
+    }
+
+    if ( fromISR )
+    {
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveIndexedFromISR( waiter, NOTIFY_INDEX, &woken );
+      portYIELD_FROM_ISR( woken );
+    }
+    else
+    {
+      xTaskNotifyGiveIndexed( waiter, NOTIFY_INDEX );
+    }
+#else
+    std::lock_guard<std::mutex> lock( mLock );
+    mNotifications++;
+    mSignal.notify_one();
+#endif
+  }
+
+
+  bool Queue::block( const size_t timeout )
+  {
+#if defined( EMBEDDED )
+    const TickType_t ticks = ( timeout == WAIT_FOREVER ) ? portMAX_DELAY : pdMS_TO_TICKS( timeout );
+    return ulTaskNotifyTakeIndexed( NOTIFY_INDEX, pdTRUE, ticks ) != 0;
+#else
+    std::unique_lock<std::mutex> lock( mLock );
+    auto ready = [ this ]() { return mNotifications != 0; };
+
+    if ( timeout == WAIT_FOREVER )
+    {
+      mSignal.wait( lock, ready );
+    }
+    else if ( !mSignal.wait_for( lock, std::chrono::milliseconds( timeout ), ready ) )
+    {
+      return false;
+    }
+
+    mNotifications = 0;
+    return true;
+#endif
+  }
+}  // namespace Adesto::Completion
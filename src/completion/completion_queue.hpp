@@ -0,0 +1,175 @@
+/********************************************************************************
+ *  File Name:
+ *    completion_queue.hpp
+ *
+ *  Description:
+ *    Lock-free completion channel between a driver's interrupt handlers and
+ *    the task waiting on its operations. Completion records are tagged with
+ *    the id of the request they finish, so several requests can be in flight
+ *    and each waiter picks out its own result. The consumer is woken with a
+ *    direct-to-task notification rather than a queue or semaphore.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_COMPLETION_QUEUE_HPP
+#define ADESTO_COMPLETION_QUEUE_HPP
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/spsc_ring.hpp>
+
+#if !defined( EMBEDDED )
+/* STL Includes */
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace Adesto::Completion
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t QUEUE_DEPTH  = 32; /**< Completions posted but not yet taken, held ones included */
+  static constexpr size_t WAIT_FOREVER = std::numeric_limits<size_t>::max();
+  static constexpr uint16_t INVALID_ID = 0;
+  static constexpr size_t NOTIFY_INDEX = 1; /**< Task notification slot used on target, index 0 stays with the application */
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  One finished request. Kept to 8 bytes so posting from an ISR is a couple
+   *  of word stores.
+   */
+  struct Record
+  {
+    uint16_t id;        /**< Request id handed out by Queue::nextId() */
+    uint8_t event;      /**< Aurora::Memory::Event that completed */
+    uint8_t status;     /**< Aurora::Memory::Status of the operation */
+    uint32_t timestamp; /**< Producer's timestamp, typically microseconds */
+  };
+  static_assert( sizeof( Record ) == 8 );
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Single producer (the driver's ISR, or one task) and single consumer (the
+   *  task waiting on completions). Neither side takes a lock on target.
+   *
+   *  The consumer is woken through its NOTIFY_INDEX task notification, so the
+   *  target build needs configTASK_NOTIFICATION_ARRAY_ENTRIES above that. The
+   *  queue owns that slot's value while a waitFor() is in progress; nothing
+   *  else may give or take it for the waiting task.
+   *
+   *  Completions only leave the queue through wait() or waitFor(), so at most
+   *  QUEUE_DEPTH can be outstanding. A post beyond that is refused and the
+   *  queue marks itself lossy: from then on a waiter whose completion isn't
+   *  already queued gets ERR_FAIL rather than blocking on a record that may
+   *  never come, until reset().
+   */
+  class Queue
+  {
+  public:
+    Queue();
+    ~Queue();
+
+    /**
+     *  Hands out the id to tag the next request with. Never returns INVALID_ID.
+     *  Consumer side only.
+     *
+     *  @return uint16_t
+     */
+    uint16_t nextId();
+
+    /**
+     *  Posts a completion from task context
+     *
+     *  @param[in]  record    Completion to post
+     *  @return bool          False if the queue was full and the record dropped
+     */
+    bool post( const Record &record );
+
+    /**
+     *  Posts a completion from an interrupt handler. Requests a context switch
+     *  on exit if the woken consumer outranks the interrupted task.
+     *
+     *  @param[in]  record    Completion to post
+     *  @return bool          False if the queue was full and the record dropped
+     */
+    bool postFromISR( const Record &record );
+
+    /**
+     *  Takes the oldest completion, blocking until one arrives. Consumer only.
+     *
+     *  @param[out] record    The completion
+     *  @param[in]  timeout   Milliseconds to wait
+     *  @return Aurora::Memory::Status  ERR_TIMEOUT if nothing arrived in time, ERR_FAIL once lossy
+     */
+    Aurora::Memory::Status wait( Record &record, const size_t timeout );
+
+    /**
+     *  Waits for the completion of one particular request. Completions for
+     *  other requests that turn up first are held for their own waitFor().
+     *  Consumer only.
+     *
+     *  @param[in]  id        Request to wait on
+     *  @param[out] record    The completion
+     *  @param[in]  timeout   Milliseconds to wait
+     *  @return Aurora::Memory::Status  ERR_TIMEOUT if nothing arrived in time, ERR_FAIL once lossy
+     */
+    Aurora::Memory::Status waitFor( const uint16_t id, Record &record, const size_t timeout );
+
+    /**
+     *  Discards every queued completion and clears the lossy state. Only call
+     *  once the producer is idle and every request in flight is abandoned.
+     *  Consumer only.
+     *
+     *  @return void
+     */
+    void reset();
+
+    /**
+     *  Completions refused because QUEUE_DEPTH were already outstanding
+     *
+     *  @return size_t
+     */
+    size_t dropped() const;
+
+  private:
+    SPSCRing<Record, QUEUE_DEPTH> mRing;
+    std::array<Record, QUEUE_DEPTH> mHeld;
+    size_t mNumHeld;
+    uint16_t mNextId;
+    std::atomic<size_t> mOutstanding; /**< Posted and not yet taken, ring and hold area together */
+    std::atomic<size_t> mDropped;
+    std::atomic<bool> mLossy;
+
+#if defined( EMBEDDED )
+    std::atomic<void *> mWaiter; /**< TaskHandle_t of the consumer */
+#else
+    std::mutex mLock;
+    std::condition_variable mSignal;
+    uint32_t mNotifications;
+#endif
+
+    bool push( const Record &record, const bool fromISR );
+    bool take( const uint16_t id, Record &record );
+    void hold( const Record &record );
+    void notify( const bool fromISR );
+    bool block( const size_t timeout );
+  };
+}  // namespace Adesto::Completion
+
+#endif /* !ADESTO_COMPLETION_QUEUE_HPP */
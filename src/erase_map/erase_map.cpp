@@ -0,0 +1,588 @@
+/********************************************************************************
+ *  File Name:
+ *    erase_map.cpp
+ *
+ *  Description:
+ *    Implementation of the erase state bitmap and its device decorator
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/erase_map/erase_map.hpp>
+
+namespace Adesto::EraseMap
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static inline bool testBit( const uint8_t *const plane, const size_t bit )
+  {
+    return plane[ bit >> 3 ] & ( 1u << ( bit & 7u ) );
+  }
+
+
+  static inline void setBit( uint8_t *const plane, const size_t bit )
+  {
+    plane[ bit >> 3 ] |= ( 1u << ( bit & 7u ) );
+  }
+
+
+  static inline void clearBit( uint8_t *const plane, const size_t bit )
+  {
+    plane[ bit >> 3 ] &= ~( 1u << ( bit & 7u ) );
+  }
+
+
+  static inline size_t planeBytes( const size_t bits )
+  {
+    return ( bits + 7u ) / 8u;
+  }
+
+
+  static bool isBlank( const uint8_t *const data, const size_t length )
+  {
+    for ( size_t x = 0; x < length; x++ )
+    {
+      if ( data[ x ] != 0xFF )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Bitmap Implementation
+  -------------------------------------------------------------------------------*/
+  Bitmap::Bitmap() :
+      mStorage( nullptr ), mPageBits( nullptr ), mUnitBits( nullptr ), mPageSize( 0 ), mUnitSize( 0 ), mNumPages( 0 ),
+      mNumUnits( 0 ), mPagesPerUnit( 0 )
+  {
+  }
+
+
+  Bitmap::~Bitmap()
+  {
+  }
+
+
+  bool Bitmap::init( const size_t pageSize, const size_t unitSize, const size_t deviceSize )
+  {
+    reset();
+
+    if ( !pageSize || !unitSize || !deviceSize || ( unitSize % pageSize ) || ( deviceSize % unitSize ) )
+    {
+      return false;
+    }
+
+    mPageSize     = pageSize;
+    mUnitSize     = unitSize;
+    mNumPages     = deviceSize / pageSize;
+    mNumUnits     = deviceSize / unitSize;
+    mPagesPerUnit = unitSize / pageSize;
+
+    const size_t pageBytes = planeBytes( mNumPages );
+    const size_t unitBytes = planeBytes( mNumUnits );
+
+    mStorage.reset( new ( std::nothrow ) uint8_t[ pageBytes + unitBytes ] );
+    if ( !mStorage )
+    {
+      reset();
+      return false;
+    }
+
+    mPageBits = mStorage.get();
+    mUnitBits = mStorage.get() + pageBytes;
+    invalidate();
+    return true;
+  }
+
+
+  void Bitmap::reset()
+  {
+    mStorage.reset();
+    mPageBits     = nullptr;
+    mUnitBits     = nullptr;
+    mPageSize     = 0;
+    mUnitSize     = 0;
+    mNumPages     = 0;
+    mNumUnits     = 0;
+    mPagesPerUnit = 0;
+  }
+
+
+  void Bitmap::invalidate()
+  {
+    if ( mStorage )
+    {
+      memset( mStorage.get(), 0, footprint() );
+    }
+  }
+
+
+  size_t Bitmap::footprint() const
+  {
+    return planeBytes( mNumPages ) + planeBytes( mNumUnits );
+  }
+
+
+  bool Bitmap::isUnitClean( const size_t unit ) const
+  {
+    if ( unit >= mNumUnits )
+    {
+      return false;
+    }
+
+    const size_t firstPage = unit * mPagesPerUnit;
+    for ( size_t page = firstPage; page < ( firstPage + mPagesPerUnit ); page++ )
+    {
+      if ( !testBit( mPageBits, page ) )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  bool Bitmap::isUnitKnown( const size_t unit ) const
+  {
+    return ( unit < mNumUnits ) && testBit( mUnitBits, unit );
+  }
+
+
+  bool Bitmap::isPageClean( const size_t page ) const
+  {
+    return ( page < mNumPages ) && testBit( mPageBits, page );
+  }
+
+
+  void Bitmap::markUnitErased( const size_t unit )
+  {
+    if ( unit >= mNumUnits )
+    {
+      return;
+    }
+
+    const size_t firstPage = unit * mPagesPerUnit;
+    for ( size_t page = firstPage; page < ( firstPage + mPagesPerUnit ); page++ )
+    {
+      setBit( mPageBits, page );
+    }
+
+    setBit( mUnitBits, unit );
+  }
+
+
+  void Bitmap::markUnitKnown( const size_t unit )
+  {
+    if ( unit < mNumUnits )
+    {
+      setBit( mUnitBits, unit );
+    }
+  }
+
+
+  void Bitmap::markPageClean( const size_t page )
+  {
+    if ( page < mNumPages )
+    {
+      setBit( mPageBits, page );
+    }
+  }
+
+
+  void Bitmap::markRangeDirty( const size_t address, const size_t length )
+  {
+    if ( !mStorage || !length )
+    {
+      return;
+    }
+
+    const size_t firstPage = address / mPageSize;
+    const size_t lastPage  = ( address + length - 1 ) / mPageSize;
+
+    for ( size_t page = firstPage; ( page <= lastPage ) && ( page < mNumPages ); page++ )
+    {
+      clearBit( mPageBits, page );
+    }
+  }
+
+
+  void Bitmap::markAllErased()
+  {
+    if ( mStorage )
+    {
+      memset( mStorage.get(), 0xFF, footprint() );
+    }
+  }
+
+  /*-------------------------------------------------------------------------------
+  Device Implementation
+  -------------------------------------------------------------------------------*/
+  Device::Device( IGenericDevice_sPtr device ) :
+      mDevice( device ), mTracking( false ), mBlankCheck( true ), mEraseInFlight( false )
+  {
+    mStats.clear();
+  }
+
+
+  Device::~Device()
+  {
+  }
+
+
+  void Device::blankCheckOnErase( const bool state )
+  {
+    mBlankCheck = state;
+  }
+
+
+  void Device::invalidate()
+  {
+    mMap.invalidate();
+  }
+
+
+  Stats Device::getStats() const
+  {
+    return mStats;
+  }
+
+
+  void Device::clearStats()
+  {
+    mStats.clear();
+  }
+
+
+  Status Device::open()
+  {
+    auto result = mDevice->open();
+    if ( result != Status::ERR_OK )
+    {
+      return result;
+    }
+
+    /*-------------------------------------------------
+    Size the map off the smallest erase unit. If that
+    can't be done, fall back to a plain pass-through.
+    -------------------------------------------------*/
+    mProps    = mDevice->getDeviceProperties();
+    mTracking = mMap.init( mProps.pageSize, chunkSize( mProps, mProps.eraseChunk ), mProps.pageSize * mProps.numPages );
+    return result;
+  }
+
+
+  Status Device::close()
+  {
+    mMap.reset();
+    mTracking      = false;
+    mEraseInFlight = false;
+    return mDevice->close();
+  }
+
+
+  Status Device::write( const size_t address, const void *const data, const size_t length )
+  {
+    /*-------------------------------------------------
+    Dirty the map first. Even a failed program may have
+    flipped some bits.
+    -------------------------------------------------*/
+    if ( mTracking )
+    {
+      mMap.markRangeDirty( address, length );
+    }
+
+    return mDevice->write( address, data, length );
+  }
+
+
+  Status Device::read( const size_t address, void *const data, const size_t length )
+  {
+    auto result = mDevice->read( address, data, length );
+
+    if ( mTracking && ( result == Status::ERR_OK ) )
+    {
+      learnFromRead( address, data, length );
+    }
+
+    return result;
+  }
+
+
+  Status Device::erase( const size_t address, const size_t length )
+  {
+    if ( !mTracking )
+    {
+      return mDevice->erase( address, length );
+    }
+
+    /*-------------------------------------------------
+    Unaligned requests go straight through. The driver
+    will either reject them or erase a superset, and in
+    both cases the map stays conservative.
+    -------------------------------------------------*/
+    const size_t unitSize = mMap.unitSize();
+    if ( !length || ( address % unitSize ) || ( length % unitSize ) )
+    {
+      return mDevice->erase( address, length );
+    }
+
+    /*-------------------------------------------------
+    Walk the units, coalescing runs of dirty ones into a
+    single erase command so the driver can still pick
+    its largest erase opcode.
+    -------------------------------------------------*/
+    const size_t firstUnit = address / unitSize;
+    const size_t lastUnit  = firstUnit + ( length / unitSize );
+    size_t runStart        = 0;
+    size_t runLength       = 0;
+    auto result            = Status::ERR_OK;
+
+    for ( size_t unit = firstUnit; unit <= lastUnit; unit++ )
+    {
+      bool clean = false;
+
+      if ( unit < lastUnit )
+      {
+        mStats.erasesRequested++;
+        clean = mMap.isUnitClean( unit );
+
+        if ( !clean && mBlankCheck && !mMap.isUnitKnown( unit ) )
+        {
+          clean = blankCheckUnit( unit );
+        }
+
+        if ( clean )
+        {
+          mStats.erasesSkipped++;
+        }
+        else
+        {
+          runStart = runLength ? runStart : unit;
+          runLength++;
+          continue;
+        }
+      }
+
+      /*-------------------------------------------------
+      Hit a clean unit or the end of the range, so issue
+      whatever dirty run has accumulated.
+      -------------------------------------------------*/
+      if ( runLength )
+      {
+        if ( mEraseInFlight )
+        {
+          pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+        }
+
+        result = mDevice->erase( runStart * unitSize, runLength * unitSize );
+        if ( result != Status::ERR_OK )
+        {
+          mMap.invalidate();
+          return result;
+        }
+
+        mStats.erasesIssued++;
+
+        for ( size_t x = runStart; x < ( runStart + runLength ); x++ )
+        {
+          mMap.markUnitErased( x );
+        }
+
+        mEraseInFlight = true;
+        runLength      = 0;
+      }
+    }
+
+    return result;
+  }
+
+
+  Status Device::erase( const Chunk chunk, const size_t id )
+  {
+    /*-------------------------------------------------
+    mProps is only valid once open() set up tracking
+    -------------------------------------------------*/
+    if ( !mTracking )
+    {
+      return mDevice->erase( chunk, id );
+    }
+
+    return erase( chunkStartAddress( mProps, chunk, id ), chunkSize( mProps, chunk ) );
+  }
+
+
+  Status Device::eraseChip()
+  {
+    auto result = mDevice->eraseChip();
+
+    if ( !mTracking )
+    {
+      return result;
+    }
+
+    if ( result == Status::ERR_OK )
+    {
+      mStats.erasesIssued++;
+      mMap.markAllErased();
+      mEraseInFlight = true;
+    }
+    else
+    {
+      mMap.invalidate();
+    }
+
+    return result;
+  }
+
+
+  Properties Device::getDeviceProperties()
+  {
+    return mDevice->getDeviceProperties();
+  }
+
+
+  Status Device::pendEvent( const Event event, const size_t timeout )
+  {
+    if ( !mTracking || ( event != Event::MEM_ERASE_COMPLETE ) )
+    {
+      return mDevice->pendEvent( event, timeout );
+    }
+
+    /*-------------------------------------------------
+    Every unit was already clean, so there is nothing
+    for the device to signal.
+    -------------------------------------------------*/
+    if ( !mEraseInFlight )
+    {
+      return Status::ERR_OK;
+    }
+
+    auto result = mDevice->pendEvent( event, timeout );
+    if ( result == Status::ERR_OK )
+    {
+      mEraseInFlight = false;
+    }
+    else if ( result != Status::ERR_TIMEOUT )
+    {
+      // The erase failed, so the optimistic marks made when it was issued are wrong
+      mMap.invalidate();
+      mEraseInFlight = false;
+    }
+
+    return result;
+  }
+
+
+  bool Device::blankCheckUnit( const size_t unit )
+  {
+    if ( mEraseInFlight )
+    {
+      pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    mStats.blankChecks++;
+
+    /*-------------------------------------------------
+    Units in use are usually written from the front, so
+    one chunk from the first page not already learned
+    clean rules most dirty units out before paying for
+    a read of the whole thing.
+    -------------------------------------------------*/
+    const size_t pageSize  = mMap.pageSize();
+    const size_t firstPage = unit * mMap.pagesPerUnit();
+    const size_t endPage   = firstPage + mMap.pagesPerUnit();
+
+    size_t probePage = firstPage;
+    while ( ( probePage < endPage ) && mMap.isPageClean( probePage ) )
+    {
+      probePage++;
+    }
+
+    if ( probePage == endPage )
+    {
+      return true;
+    }
+
+    const size_t probe = std::min( mScratch.size(), pageSize );
+    if ( ( mDevice->read( probePage * pageSize, mScratch.data(), probe ) != Status::ERR_OK )
+         || !isBlank( mScratch.data(), probe ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------
+    Read the rest back a chunk at a time, recording the
+    state of each page along the way so a partially
+    dirty unit still seeds the map.
+    -------------------------------------------------*/
+    bool unitClean = true;
+
+    for ( size_t page = probePage; page < endPage; page++ )
+    {
+      if ( mMap.isPageClean( page ) )
+      {
+        continue;
+      }
+
+      bool pageClean     = true;
+      const size_t start = ( page == probePage ) ? probe : 0;
+
+      for ( size_t offset = start; ( offset < pageSize ) && pageClean; offset += mScratch.size() )
+      {
+        const size_t chunk = std::min( mScratch.size(), pageSize - offset );
+        if ( mDevice->read( ( page * pageSize ) + offset, mScratch.data(), chunk ) != Status::ERR_OK )
+        {
+          return false;
+        }
+
+        pageClean = isBlank( mScratch.data(), chunk );
+      }
+
+      if ( pageClean )
+      {
+        mMap.markPageClean( page );
+      }
+
+      unitClean &= pageClean;
+    }
+
+    mMap.markUnitKnown( unit );
+    return unitClean;
+  }
+
+
+  void Device::learnFromRead( const size_t address, const void *const data, const size_t length )
+  {
+    /*-------------------------------------------------
+    Only pages fully covered by the read can be learned
+    -------------------------------------------------*/
+    const size_t pageSize = mMap.pageSize();
+    const size_t first    = ( address + pageSize - 1 ) / pageSize;
+    const size_t end      = ( address + length ) / pageSize;
+    auto bytes            = reinterpret_cast<const uint8_t *>( data );
+
+    for ( size_t page = first; page < end; page++ )
+    {
+      if ( !mMap.isPageClean( page ) && isBlank( bytes + ( page * pageSize ) - address, pageSize ) )
+      {
+        mMap.markPageClean( page );
+      }
+    }
+  }
+}  // namespace Adesto::EraseMap
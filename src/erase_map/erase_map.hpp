@@ -0,0 +1,206 @@
+/********************************************************************************
+ *  File Name:
+ *    erase_map.hpp
+ *
+ *  Description:
+ *    RAM only record of which regions of a NOR device are known to be in the
+ *    erased state. Wrapping a driver with EraseMap::Device turns redundant
+ *    erases (ie defensive erase-before-write right after an eraseChip()) into
+ *    no-ops. Nothing is persisted, so losing the map on reset only costs some
+ *    blank checks the next time a region is erased.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_ERASE_MAP_HPP
+#define ADESTO_ERASE_MAP_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::EraseMap
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t BLANK_CHECK_CHUNK = 256; /**< Bytes read per blank check transfer */
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct Stats
+  {
+    size_t erasesRequested; /**< Erase units the user asked to erase */
+    size_t erasesSkipped;   /**< Erase units that were already known to be clean */
+    size_t erasesIssued;    /**< Erase commands the device accepted while tracking */
+    size_t blankChecks;     /**< Erase units that had to be read back to learn their state */
+
+    void clear()
+    {
+      erasesRequested = 0;
+      erasesSkipped   = 0;
+      erasesIssued    = 0;
+      blankChecks     = 0;
+    }
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Two bit planes describing device state:
+   *    - Page plane: A set bit means the page is definitely erased.
+   *    - Unit plane: A set bit means the page bits inside that erase unit are
+   *      authoritative, so a clear page bit means "dirty" rather than "unknown".
+   *
+   *  Everything starts unknown, which is always a safe assumption.
+   */
+  class Bitmap
+  {
+  public:
+    Bitmap();
+    ~Bitmap();
+
+    /**
+     *  Sizes the bitmap for a device and resets everything to unknown
+     *
+     *  @param[in]  pageSize    Size of a program page in bytes
+     *  @param[in]  unitSize    Size of the smallest erase unit in bytes
+     *  @param[in]  deviceSize  Total size of the device in bytes
+     *  @return bool            False if the storage could not be allocated
+     */
+    bool init( const size_t pageSize, const size_t unitSize, const size_t deviceSize );
+
+    /**
+     *  Releases the bitmap storage
+     *
+     *  @return void
+     */
+    void reset();
+
+    /**
+     *  Forgets everything, returning all regions to the unknown state
+     *
+     *  @return void
+     */
+    void invalidate();
+
+    /**
+     *  Memory consumed by the bit planes
+     *
+     *  @return size_t
+     */
+    size_t footprint() const;
+
+    bool isUnitClean( const size_t unit ) const;
+    bool isUnitKnown( const size_t unit ) const;
+    bool isPageClean( const size_t page ) const;
+
+    void markUnitErased( const size_t unit );
+    void markUnitKnown( const size_t unit );
+    void markPageClean( const size_t page );
+    void markRangeDirty( const size_t address, const size_t length );
+    void markAllErased();
+
+    size_t pageSize() const
+    {
+      return mPageSize;
+    }
+
+    size_t unitSize() const
+    {
+      return mUnitSize;
+    }
+
+    size_t numUnits() const
+    {
+      return mNumUnits;
+    }
+
+    size_t pagesPerUnit() const
+    {
+      return mPagesPerUnit;
+    }
+
+  private:
+    std::unique_ptr<uint8_t[]> mStorage;
+    uint8_t *mPageBits;
+    uint8_t *mUnitBits;
+    size_t mPageSize;
+    size_t mUnitSize;
+    size_t mNumPages;
+    size_t mNumUnits;
+    size_t mPagesPerUnit;
+  };
+
+
+  /**
+   *  Decorator that filters erase requests through a Bitmap before passing
+   *  them on to the real device. Writes clear the map, erases set it, and
+   *  unknown erase units are blank checked on first erase.
+   */
+  class Device : public Aurora::Memory::IGenericDevice
+  {
+  public:
+    Device( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Device();
+
+    /**
+     *  Controls whether unknown erase units are read back before erasing.
+     *  A single BLANK_CHECK_CHUNK probe rules out most dirty units, and pages
+     *  already seen blank by read() are never read again. Reading a unit is
+     *  much cheaper than erasing it on NOR parts, but this can be disabled
+     *  when the access pattern makes a hit unlikely.
+     *
+     *  @param[in]  state       Enable or disable blank checking
+     *  @return void
+     */
+    void blankCheckOnErase( const bool state );
+
+    /**
+     *  Drops all knowledge of device state, ie if something else may have
+     *  modified the device behind this object's back.
+     *
+     *  @return void
+     */
+    void invalidate();
+
+    Stats getStats() const;
+    void clearStats();
+
+    /*-------------------------------------------------
+    Generic Device Interface
+    -------------------------------------------------*/
+    Aurora::Memory::Status open() override;
+    Aurora::Memory::Status close() override;
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length ) override;
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length ) override;
+    Aurora::Memory::Status erase( const size_t address, const size_t length ) override;
+    Aurora::Memory::Status erase( const Aurora::Memory::Chunk chunk, const size_t id ) override;
+    Aurora::Memory::Status eraseChip() override;
+    Aurora::Memory::Properties getDeviceProperties() override;
+    Aurora::Memory::Status pendEvent( const Aurora::Memory::Event event, const size_t timeout ) override;
+
+  private:
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Aurora::Memory::Properties mProps;
+    Bitmap mMap;
+    Stats mStats;
+    bool mTracking;
+    bool mBlankCheck;
+    bool mEraseInFlight;
+    std::array<uint8_t, BLANK_CHECK_CHUNK> mScratch;
+
+    bool blankCheckUnit( const size_t unit );
+    void learnFromRead( const size_t address, const void *const data, const size_t length );
+  };
+}  // namespace Adesto::EraseMap
+
+#endif /* !ADESTO_ERASE_MAP_HPP */
@@ -0,0 +1,485 @@
+/********************************************************************************
+ *  File Name:
+ *    erase_pool.cpp
+ *
+ *  Description:
+ *    Implementation of the pre-erased sector pool
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/erase_pool/erase_pool.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/common>
+
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+/* STL Includes */
+#include <chrono>
+#endif
+
+namespace Adesto::ErasePool
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t STOP_POLL_MS   = 1;
+  static constexpr size_t MIN_BACKOFF_MS = 1;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static size_t nowMs()
+  {
+#if defined( EMBEDDED )
+    return Chimera::millis();
+#else
+    using namespace std::chrono;
+    return static_cast<size_t>( duration_cast<milliseconds>( steady_clock::now().time_since_epoch() ).count() );
+#endif
+  }
+
+  /*-------------------------------------------------------------------------------
+  Service Implementation
+  -------------------------------------------------------------------------------*/
+  Service::Service( IGenericDevice_sPtr device ) :
+      mDevice( device ), mConfig{}, mSectorSize( 0 ), mAcquired( 0 ), mReleased( 0 ), mStalls( 0 ), mErases( 0 ),
+      mYields( 0 ), mFailedErases( 0 ), mLowWater( 0 ), mRunning( false ), mUrgent( false ), mForeground( 0 ),
+      mLastForeground( 0 ),
+#if defined( EMBEDDED )
+      mExited( true )
+#else
+      mWakePending( false ), mReadyPending( false )
+#endif
+  {
+  }
+
+
+  Service::~Service()
+  {
+    stop();
+  }
+
+
+  Status Service::open( const Config &config )
+  {
+    if ( !mDevice || mRunning )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Validate the region against the device
+    -------------------------------------------------*/
+    auto props         = mDevice->getDeviceProperties();
+    const size_t unit  = chunkSize( props, props.eraseChunk );
+    const size_t limit = props.pageSize * props.numPages;
+
+    if ( !unit || ( config.baseAddress % unit ) || !config.numSectors || ( config.numSectors > MAX_SECTORS )
+         || !config.depth || ( config.depth > config.numSectors ) || ( config.baseAddress > limit )
+         || ( config.numSectors > ( ( limit - config.baseAddress ) / unit ) ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    mConfig     = config;
+    mSectorSize = unit;
+
+    /*-------------------------------------------------
+    Nothing is known about the region yet, so every
+    sector has to go through the worker once.
+    -------------------------------------------------*/
+    uint16_t sector = 0;
+    while ( mClean.pop( sector ) || mDirty.pop( sector ) )
+    {
+    }
+
+    for ( size_t x = 0; x < config.numSectors; x++ )
+    {
+      mDirty.push( static_cast<uint16_t>( x ) );
+    }
+
+    mUrgent = false;
+    clearStats();
+    return Status::ERR_OK;
+  }
+
+
+  Status Service::start()
+  {
+    if ( !mSectorSize )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( mRunning )
+    {
+      return Status::ERR_OK;
+    }
+
+    mRunning = true;
+
+#if defined( EMBEDDED )
+    using namespace Chimera::Threading;
+
+    /*-------------------------------------------------
+    Lowest application priority. Anything with real
+    work to do preempts the worker between erases.
+    -------------------------------------------------*/
+    mExited = false;
+    mThread.initialize( workerTask, this, Priority::LEVEL_1, STACK_KILOBYTES( WORKER_STACK_KB ), "erase_pool" );
+    mThread.start();
+#else
+    mThread = std::thread( [ this ]() { workerLoop(); } );
+#endif
+
+    return Status::ERR_OK;
+  }
+
+
+  void Service::stop()
+  {
+    if ( !mRunning )
+    {
+      return;
+    }
+
+    mRunning = false;
+    wake();
+
+#if defined( EMBEDDED )
+    while ( !mExited )
+    {
+      Chimera::delayMilliseconds( STOP_POLL_MS );
+    }
+#else
+    mThread.join();
+#endif
+  }
+
+
+  Status Service::acquire( size_t &address, const size_t timeout )
+  {
+    uint16_t sector = 0;
+
+    if ( !mClean.pop( sector ) )
+    {
+      mStalls++;
+      if ( !mRunning )
+      {
+        return Status::ERR_FAIL;
+      }
+
+      /*-------------------------------------------------
+      Someone is waiting now, skip the idle holdoff
+      -------------------------------------------------*/
+      mUrgent = true;
+      wake();
+
+      const size_t start = nowMs();
+      while ( !mClean.pop( sector ) )
+      {
+        const size_t elapsed = nowMs() - start;
+        if ( ( timeout != WAIT_FOREVER ) && ( elapsed >= timeout ) )
+        {
+          return Status::ERR_TIMEOUT;
+        }
+
+        waitReady( ( timeout == WAIT_FOREVER ) ? WAIT_FOREVER : ( timeout - elapsed ) );
+      }
+    }
+
+    mAcquired++;
+    mLowWater = std::min<size_t>( mLowWater, mClean.size() );
+    wake();
+
+    address = mConfig.baseAddress + ( sector * mSectorSize );
+    return Status::ERR_OK;
+  }
+
+
+  Status Service::release( const size_t address )
+  {
+    if ( !mSectorSize || ( address < mConfig.baseAddress ) || ( ( address - mConfig.baseAddress ) % mSectorSize ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    const size_t sector = ( address - mConfig.baseAddress ) / mSectorSize;
+    if ( sector >= mConfig.numSectors )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( !mDirty.push( static_cast<uint16_t>( sector ) ) )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    mReleased++;
+    wake();
+    return Status::ERR_OK;
+  }
+
+
+  Status Service::read( const size_t address, void *const data, const size_t length )
+  {
+    beginForeground();
+    const auto result = mDevice->read( address, data, length );
+    endForeground();
+    return result;
+  }
+
+
+  Status Service::write( const size_t address, const void *const data, const size_t length )
+  {
+    beginForeground();
+
+    auto result = mDevice->write( address, data, length );
+    if ( result == Status::ERR_OK )
+    {
+      result = mDevice->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    endForeground();
+    return result;
+  }
+
+
+  size_t Service::depth() const
+  {
+    return mClean.size();
+  }
+
+
+  Stats Service::getStats() const
+  {
+    Stats stats;
+    stats.acquired     = mAcquired;
+    stats.released     = mReleased;
+    stats.stalls       = mStalls;
+    stats.erases       = mErases;
+    stats.yields       = mYields;
+    stats.failedErases = mFailedErases;
+    stats.lowWater     = mLowWater;
+    return stats;
+  }
+
+
+  void Service::clearStats()
+  {
+    mAcquired     = 0;
+    mReleased     = 0;
+    mStalls       = 0;
+    mErases       = 0;
+    mYields       = 0;
+    mFailedErases = 0;
+    mLowWater     = mConfig.depth;
+  }
+
+
+#if defined( EMBEDDED )
+  void Service::workerTask( void *arg )
+  {
+    auto service = static_cast<Service *>( arg );
+    service->workerLoop();
+
+    /*-------------------------------------------------
+    The service may be gone as soon as it sees mExited
+    -------------------------------------------------*/
+    service->mExited = true;
+    vTaskDelete( nullptr );
+  }
+#endif
+
+
+  void Service::workerLoop()
+  {
+    while ( mRunning )
+    {
+      if ( !needsErase() )
+      {
+        sleep( WAIT_FOREVER );
+        continue;
+      }
+
+      /*-------------------------------------------------
+      Hold off until the bus has been quiet for a while,
+      unless a writer is already stalled on the pool.
+      -------------------------------------------------*/
+      if ( !mUrgent )
+      {
+        const size_t quiet = nowMs() - mLastForeground;
+        if ( mForeground || ( quiet < mConfig.idleMs ) )
+        {
+          const size_t remaining = mForeground ? mConfig.idleMs : ( mConfig.idleMs - quiet );
+
+          mYields++;
+          sleep( std::max( remaining, MIN_BACKOFF_MS ) );
+          continue;
+        }
+      }
+
+      eraseOne();
+    }
+  }
+
+
+  void Service::eraseOne()
+  {
+    mBus.lock();
+
+    /*-------------------------------------------------
+    Foreground work queued up behind the lock goes
+    first, the erase would block it for its duration.
+    -------------------------------------------------*/
+    uint16_t sector = 0;
+    if ( ( mForeground && !mUrgent ) || !mDirty.pop( sector ) )
+    {
+      mBus.unlock();
+      mYields += ( mForeground != 0 );
+      return;
+    }
+
+    const size_t address = mConfig.baseAddress + ( sector * mSectorSize );
+
+    auto result = mDevice->erase( address, mSectorSize );
+    if ( result == Status::ERR_OK )
+    {
+      result = mDevice->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    mBus.unlock();
+
+    /*-------------------------------------------------
+    A sector that won't erase is retired for good
+    -------------------------------------------------*/
+    if ( result == Status::ERR_OK )
+    {
+      mClean.push( sector );
+      mErases++;
+      mUrgent = false;
+      signalReady();
+    }
+    else
+    {
+      mFailedErases++;
+    }
+  }
+
+
+  bool Service::needsErase() const
+  {
+    return ( mClean.size() < mConfig.depth ) && !mDirty.empty();
+  }
+
+
+  void Service::beginForeground()
+  {
+    mForeground++;
+    mBus.lock();
+  }
+
+
+  void Service::endForeground()
+  {
+    mLastForeground = nowMs();
+    mBus.unlock();
+    mForeground--;
+  }
+
+
+  void Service::wake()
+  {
+#if defined( EMBEDDED )
+    mWake.release();
+#else
+    std::lock_guard<std::mutex> lock( mLock );
+    mWakePending = true;
+    mWake.notify_one();
+#endif
+  }
+
+
+  void Service::sleep( const size_t timeout )
+  {
+#if defined( EMBEDDED )
+    if ( timeout == WAIT_FOREVER )
+    {
+      mWake.acquire();
+    }
+    else
+    {
+      mWake.try_acquire_for( timeout );
+    }
+#else
+    std::unique_lock<std::mutex> lock( mLock );
+    auto pending = [ this ]() { return mWakePending; };
+
+    if ( timeout == WAIT_FOREVER )
+    {
+      mWake.wait( lock, pending );
+    }
+    else
+    {
+      mWake.wait_for( lock, std::chrono::milliseconds( timeout ), pending );
+    }
+
+    mWakePending = false;
+#endif
+  }
+
+
+  void Service::signalReady()
+  {
+#if defined( EMBEDDED )
+    mReady.release();
+#else
+    std::lock_guard<std::mutex> lock( mLock );
+    mReadyPending = true;
+    mReady.notify_one();
+#endif
+  }
+
+
+  void Service::waitReady( const size_t timeout )
+  {
+#if defined( EMBEDDED )
+    if ( timeout == WAIT_FOREVER )
+    {
+      mReady.acquire();
+    }
+    else
+    {
+      mReady.try_acquire_for( timeout );
+    }
+#else
+    std::unique_lock<std::mutex> lock( mLock );
+    auto pending = [ this ]() { return mReadyPending; };
+
+    if ( timeout == WAIT_FOREVER )
+    {
+      mReady.wait( lock, pending );
+    }
+    else
+    {
+      mReady.wait_for( lock, std::chrono::milliseconds( timeout ), pending );
+    }
+
+    mReadyPending = false;
+#endif
+  }
+}  // namespace Adesto::ErasePool
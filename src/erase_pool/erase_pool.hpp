@@ -0,0 +1,206 @@
+/********************************************************************************
+ *  File Name:
+ *    erase_pool.hpp
+ *
+ *  Description:
+ *    Background service keeping a pool of pre-erased sectors ready for
+ *    writers. Sectors are erased while the bus is idle, so a writer moving
+ *    on to a new sector takes one from the pool instead of sitting through
+ *    the erase.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_ERASE_POOL_HPP
+#define ADESTO_ERASE_POOL_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/spsc_ring.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/thread>
+#else
+/* STL Includes */
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace Adesto::ErasePool
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t MAX_SECTORS     = 256; /**< Sectors one pool can manage */
+  static constexpr size_t WORKER_STACK_KB = 2;
+  static constexpr size_t WAIT_FOREVER    = std::numeric_limits<size_t>::max();
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct Config
+  {
+    size_t baseAddress; /**< Start of the managed region, erase unit aligned */
+    size_t numSectors;  /**< Erase units in the region */
+    size_t depth;       /**< Pre-erased sectors to keep ready */
+    size_t idleMs;      /**< Bus quiet time required before a background erase */
+  };
+
+  struct Stats
+  {
+    size_t acquired;     /**< Sectors handed out */
+    size_t released;     /**< Sectors handed back for recycling */
+    size_t stalls;       /**< Acquires that found the pool empty */
+    size_t erases;       /**< Background erases completed */
+    size_t yields;       /**< Times the worker backed off for foreground traffic */
+    size_t failedErases; /**< Sectors retired after their erase failed */
+    size_t lowWater;     /**< Smallest pool depth seen right after an acquire */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Owns a region of erase units and a low priority worker that erases them.
+   *  Every sector is either dirty (waiting on the worker), clean (in the pool)
+   *  or held by the writer between acquire() and release().
+   *
+   *  acquire() and release() must always be called from the same task. Any
+   *  task may use read() and write(), which is how the worker learns about
+   *  foreground traffic; going around them to the device is not safe while
+   *  the service runs.
+   */
+  class Service
+  {
+  public:
+    Service( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Service();
+
+    /**
+     *  Sets up the region. Every sector starts out dirty. Only valid while
+     *  the service is stopped.
+     *
+     *  @param[in]  config    Region and pool settings
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status open( const Config &config );
+
+    /**
+     *  Creates the worker. On the target it runs below the foreground tasks.
+     *
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status start();
+
+    /**
+     *  Shuts the worker down, letting an erase in progress finish first
+     *
+     *  @return void
+     */
+    void stop();
+
+    /**
+     *  Takes a clean sector from the pool. If the pool is empty this counts
+     *  as a stall, and the worker erases straight away instead of waiting
+     *  for the bus to go quiet.
+     *
+     *  @param[in]  address   Start address of the sector
+     *  @param[in]  timeout   Milliseconds to wait when the pool is empty
+     *  @return Aurora::Memory::Status  ERR_TIMEOUT if nothing was ready in time
+     */
+    Aurora::Memory::Status acquire( size_t &address, const size_t timeout );
+
+    /**
+     *  Hands a sector back to be erased and reused
+     *
+     *  @param[in]  address   Start address from acquire()
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status release( const size_t address );
+
+    /**
+     *  Foreground accesses, holding the bus for the duration so background
+     *  erases stay out of the way. A write waits for MEM_WRITE_COMPLETE. A
+     *  read finishes inside IGenericDevice::read() and pends no event, the
+     *  same contract as the wear, txn, littlefs, async and batch layers.
+     *
+     *  @param[in]  address   Device address
+     *  @param[in]  data      Data buffer
+     *  @param[in]  length    Bytes to transfer
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length );
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length );
+
+    /**
+     *  Clean sectors ready to hand out
+     *
+     *  @return size_t
+     */
+    size_t depth() const;
+
+    Stats getStats() const;
+    void clearStats();
+
+  private:
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Config mConfig;
+    size_t mSectorSize;
+    SPSCRing<uint16_t, MAX_SECTORS> mClean; /**< Worker to writer */
+    SPSCRing<uint16_t, MAX_SECTORS> mDirty; /**< Writer to worker */
+
+    std::atomic<size_t> mAcquired;
+    std::atomic<size_t> mReleased;
+    std::atomic<size_t> mStalls;
+    std::atomic<size_t> mErases;
+    std::atomic<size_t> mYields;
+    std::atomic<size_t> mFailedErases;
+    std::atomic<size_t> mLowWater;
+
+    std::atomic<bool> mRunning;
+    std::atomic<bool> mUrgent;       /**< A writer is stalled on an empty pool */
+    std::atomic<size_t> mForeground; /**< Foreground accesses waiting on or holding the bus */
+    std::atomic<size_t> mLastForeground;
+
+#if defined( EMBEDDED )
+    Chimera::Threading::Thread mThread;
+    Chimera::Threading::Mutex mBus;
+    Chimera::Threading::BinarySemaphore mWake;
+    Chimera::Threading::BinarySemaphore mReady;
+    std::atomic<bool> mExited;
+
+    static void workerTask( void *arg );
+#else
+    std::thread mThread;
+    std::mutex mBus;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mReady;
+    bool mWakePending;
+    bool mReadyPending;
+#endif
+
+    void workerLoop();
+    void eraseOne();
+    bool needsErase() const;
+    void beginForeground();
+    void endForeground();
+    void wake();
+    void sleep( const size_t timeout );
+    void signalReady();
+    void waitReady( const size_t timeout );
+  };
+}  // namespace Adesto::ErasePool
+
+#endif /* !ADESTO_ERASE_POOL_HPP */
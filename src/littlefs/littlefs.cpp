@@ -0,0 +1,181 @@
+/********************************************************************************
+ *  File Name:
+ *    littlefs.cpp
+ *
+ *  Description:
+ *    Implementation of the littlefs block device adapter
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/littlefs/littlefs.hpp>
+
+namespace Adesto::LittleFS
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static inline int toError( const Status status )
+  {
+    return ( status == Status::ERR_OK ) ? LFS_ERR_OK : LFS_ERR_IO;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Callbacks
+  -------------------------------------------------------------------------------*/
+  struct Callbacks
+  {
+    static inline Adapter *adapter( const lfs_config *c )
+    {
+      return static_cast<Adapter *>( c->context );
+    }
+
+
+    static int read( const lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size )
+    {
+      auto self = adapter( c );
+      self->mStats.reads++;
+      self->mStats.readBytes += size;
+
+      return toError( self->mDevice->read( ( block * c->block_size ) + off, buffer, size ) );
+    }
+
+
+    static int prog( const lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size )
+    {
+      auto self = adapter( c );
+      self->mStats.progs++;
+      self->mStats.progBytes += size;
+
+      auto result = self->mDevice->write( ( block * c->block_size ) + off, buffer, size );
+      if ( result == Status::ERR_OK )
+      {
+        result = self->mDevice->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+      }
+
+      return toError( result );
+    }
+
+
+    static int erase( const lfs_config *c, lfs_block_t block )
+    {
+      auto self = adapter( c );
+      self->mStats.erases++;
+
+      auto result = self->mDevice->erase( block * c->block_size, c->block_size );
+      if ( result == Status::ERR_OK )
+      {
+        result = self->mDevice->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+      }
+
+      return toError( result );
+    }
+
+
+    static int sync( const lfs_config *c )
+    {
+      /*-------------------------------------------------
+      Nothing is buffered below littlefs
+      -------------------------------------------------*/
+      adapter( c )->mStats.syncs++;
+      return LFS_ERR_OK;
+    }
+  };
+
+  /*-------------------------------------------------------------------------------
+  Adapter Implementation
+  -------------------------------------------------------------------------------*/
+  Adapter::Adapter( IGenericDevice_sPtr device ) : mDevice( device ), mConfig{}, mStats{}
+  {
+  }
+
+
+  Adapter::~Adapter()
+  {
+  }
+
+
+  Status Adapter::configure( const int32_t blockCycles )
+  {
+    if ( !mDevice )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Derive the geometry
+    -------------------------------------------------*/
+    auto props             = mDevice->getDeviceProperties();
+    const size_t blockSize = chunkSize( props, props.eraseChunk );
+    const size_t devSize   = props.pageSize * props.numPages;
+
+    if ( !props.pageSize || !blockSize || ( blockSize % props.pageSize ) || ( devSize < ( 2 * blockSize ) ) )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    const size_t ioSize     = std::min( MAX_IO_SIZE, props.pageSize );
+    const size_t blockCount = devSize / blockSize;
+    const size_t lookahead  = std::min( MAX_LOOKAHEAD, ( ( blockCount + 63 ) / 64 ) * 8 );
+
+    /*-------------------------------------------------
+    Buffers littlefs would otherwise malloc
+    -------------------------------------------------*/
+    mReadBuffer.reset( new ( std::nothrow ) uint8_t[ props.pageSize ] );
+    mProgBuffer.reset( new ( std::nothrow ) uint8_t[ props.pageSize ] );
+    mLookahead.reset( new ( std::nothrow ) uint32_t[ lookahead / sizeof( uint32_t ) ] );
+
+    if ( !mReadBuffer || !mProgBuffer || !mLookahead )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    memset( &mConfig, 0, sizeof( mConfig ) );
+    mConfig.context          = this;
+    mConfig.read             = Callbacks::read;
+    mConfig.prog             = Callbacks::prog;
+    mConfig.erase            = Callbacks::erase;
+    mConfig.sync             = Callbacks::sync;
+    mConfig.read_size        = static_cast<lfs_size_t>( ioSize );
+    mConfig.prog_size        = static_cast<lfs_size_t>( ioSize );
+    mConfig.block_size       = static_cast<lfs_size_t>( blockSize );
+    mConfig.block_count      = static_cast<lfs_size_t>( blockCount );
+    mConfig.block_cycles     = blockCycles;
+    mConfig.cache_size       = static_cast<lfs_size_t>( props.pageSize );
+    mConfig.lookahead_size   = static_cast<lfs_size_t>( lookahead );
+    mConfig.read_buffer      = mReadBuffer.get();
+    mConfig.prog_buffer      = mProgBuffer.get();
+    mConfig.lookahead_buffer = mLookahead.get();
+
+    return Status::ERR_OK;
+  }
+
+
+  const lfs_config *Adapter::config() const
+  {
+    return mConfig.context ? &mConfig : nullptr;
+  }
+
+
+  Stats Adapter::getStats() const
+  {
+    return mStats;
+  }
+
+
+  void Adapter::clearStats()
+  {
+    mStats = {};
+  }
+}  // namespace Adesto::LittleFS
@@ -0,0 +1,109 @@
+/********************************************************************************
+ *  File Name:
+ *    littlefs.hpp
+ *
+ *  Description:
+ *    Block device adapter running littlefs on top of any IGenericDevice. The
+ *    littlefs geometry is derived from the device properties and littlefs's
+ *    own buffers are handed straight to the driver, so the adapter never
+ *    copies file data.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_LITTLEFS_HPP
+#define ADESTO_LITTLEFS_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* littlefs Includes */
+#include "lfs.h"
+
+namespace Adesto::LittleFS
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t MAX_IO_SIZE           = 16;  /**< Largest read/prog granularity given to littlefs */
+  static constexpr size_t MAX_LOOKAHEAD         = 128; /**< Bytes of lookahead bitmap, each covers 8 blocks */
+  static constexpr int32_t DEFAULT_BLOCK_CYCLES = 500; /**< Erases before littlefs moves a metadata pair */
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct Stats
+  {
+    size_t reads;
+    size_t progs;
+    size_t erases;
+    size_t syncs;
+    uint64_t readBytes;
+    uint64_t progBytes;
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Owns an lfs_config wired to a device. Tuning, all derived from the
+   *  device properties:
+   *    - block_size is the erase unit, so every littlefs erase is one command.
+   *    - read_size/prog_size stay small. NOR has no real granularity and
+   *      littlefs pads each metadata commit out to prog_size.
+   *    - cache_size is the program page, so a full cache flush is a single
+   *      page program and a cache fill a single read.
+   *    - lookahead_size covers the whole device when that fits in
+   *      MAX_LOOKAHEAD, which saves rescans when allocating blocks.
+   *
+   *  The read, program and lookahead buffers are allocated here so littlefs
+   *  never calls malloc for them. Program and erase wait on the driver's
+   *  completion events, which makes sync() a no-op.
+   *
+   *  Not thread safe, littlefs must be serialized by the caller.
+   */
+  class Adapter
+  {
+  public:
+    Adapter( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Adapter();
+
+    /**
+     *  Derives the littlefs geometry from the device and allocates buffers.
+     *  The device must already be open.
+     *
+     *  @param[in]  blockCycles   Passed through to lfs_config::block_cycles
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status configure( const int32_t blockCycles = DEFAULT_BLOCK_CYCLES );
+
+    /**
+     *  Configuration to pass to lfs_format() and lfs_mount(). Stays valid
+     *  until the adapter is destroyed or configured again.
+     *
+     *  @return const lfs_config*
+     */
+    const lfs_config *config() const;
+
+    Stats getStats() const;
+    void clearStats();
+
+  private:
+    friend struct Callbacks;
+
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    lfs_config mConfig;
+    Stats mStats;
+    std::unique_ptr<uint8_t[]> mReadBuffer;
+    std::unique_ptr<uint8_t[]> mProgBuffer;
+    std::unique_ptr<uint32_t[]> mLookahead; /**< Word aligned, as littlefs requires */
+  };
+}  // namespace Adesto::LittleFS
+
+#endif /* !ADESTO_LITTLEFS_HPP */
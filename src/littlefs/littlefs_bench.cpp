@@ -0,0 +1,311 @@
+/********************************************************************************
+ *  File Name:
+ *    littlefs_bench.cpp
+ *
+ *  Description:
+ *    Implementation of the littlefs benchmark
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstdio>
+#include <memory>
+#include <new>
+
+/* Adesto Includes */
+#include <src/littlefs/littlefs_bench.hpp>
+
+namespace Adesto::LittleFS
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t LINE_SIZE = 160;
+  static constexpr size_t NAME_SIZE = 16;
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Everything too large for a task stack
+   */
+  struct Workspace
+  {
+    lfs_t fs;
+    lfs_file_t file;
+    lfs_file_config fileConfig;
+  };
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static inline uint8_t pattern( const size_t file, const size_t offset )
+  {
+    return static_cast<uint8_t>( ( file * 31u ) + offset );
+  }
+
+
+  static uint64_t perSecond( const uint64_t amount, const uint64_t elapsedUs )
+  {
+    return elapsedUs ? ( amount * 1000000u ) / elapsedUs : 0;
+  }
+
+
+  static const char *phaseName( const size_t phase )
+  {
+    switch ( static_cast<Phase>( phase ) )
+    {
+      case Phase::FORMAT:
+        return "format";
+
+      case Phase::CREATE:
+        return "create";
+
+      case Phase::APPEND:
+        return "append";
+
+      case Phase::READ:
+        return "read";
+
+      case Phase::MOUNT:
+        return "mount";
+
+      default:
+        return "?";
+    }
+  }
+
+
+  /**
+   *  Brackets one phase on the clock and the adapter's traffic counters
+   */
+  class Timer
+  {
+  public:
+    Timer( Adapter &adapter, ClockFunc clock, void *context, PhaseStats &stats ) :
+        mAdapter( adapter ), mClock( clock ), mContext( context ), mStats( stats )
+    {
+      mAdapter.clearStats();
+      mStart = mClock( mContext );
+    }
+
+    ~Timer()
+    {
+      mStats.elapsedUs = mClock( mContext ) - mStart;
+      mStats.device    = mAdapter.getStats();
+    }
+
+  private:
+    Adapter &mAdapter;
+    ClockFunc mClock;
+    void *mContext;
+    PhaseStats &mStats;
+    uint64_t mStart;
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  Status runBenchmark( const BenchConfig &config, IGenericDevice_sPtr device, ClockFunc clock, void *clockContext,
+                       BenchResult &result )
+  {
+    result = {};
+
+    if ( !device || !clock || !config.numFiles || !config.appendSize || ( config.fileSize % config.appendSize ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Set up the adapter and the buffers littlefs and the
+    benchmark itself write from and read into.
+    -------------------------------------------------*/
+    Adapter adapter( device );
+    if ( adapter.configure() != Status::ERR_OK )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    const lfs_config *cfg = adapter.config();
+    std::unique_ptr<Workspace> ws( new ( std::nothrow ) Workspace() );
+    std::unique_ptr<uint8_t[]> fileCache( new ( std::nothrow ) uint8_t[ cfg->cache_size ] );
+    std::unique_ptr<uint8_t[]> data( new ( std::nothrow ) uint8_t[ config.appendSize ] );
+
+    if ( !ws || !fileCache || !data )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    ws->fileConfig.buffer = fileCache.get();
+    char name[ NAME_SIZE ];
+
+    /*-------------------------------------------------
+    Format
+    -------------------------------------------------*/
+    {
+      auto &stats = result.phases[ static_cast<size_t>( Phase::FORMAT ) ];
+      Timer timer( adapter, clock, clockContext, stats );
+
+      stats.ops = 1;
+      if ( lfs_format( &ws->fs, cfg ) != LFS_ERR_OK )
+      {
+        return Status::ERR_FAIL;
+      }
+    }
+
+    if ( lfs_mount( &ws->fs, cfg ) != LFS_ERR_OK )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Create
+    -------------------------------------------------*/
+    {
+      auto &stats = result.phases[ static_cast<size_t>( Phase::CREATE ) ];
+      Timer timer( adapter, clock, clockContext, stats );
+
+      for ( size_t file = 0; file < config.numFiles; file++ )
+      {
+        snprintf( name, sizeof( name ), "f%u", static_cast<unsigned>( file ) );
+
+        const int flags = LFS_O_WRONLY | LFS_O_CREAT | LFS_O_EXCL;
+        if ( lfs_file_opencfg( &ws->fs, &ws->file, name, flags, &ws->fileConfig ) != LFS_ERR_OK )
+        {
+          result.errors++;
+          continue;
+        }
+
+        result.errors += ( lfs_file_close( &ws->fs, &ws->file ) != LFS_ERR_OK );
+        stats.ops++;
+      }
+    }
+
+    /*-------------------------------------------------
+    Append
+    -------------------------------------------------*/
+    {
+      auto &stats = result.phases[ static_cast<size_t>( Phase::APPEND ) ];
+      Timer timer( adapter, clock, clockContext, stats );
+
+      for ( size_t file = 0; file < config.numFiles; file++ )
+      {
+        snprintf( name, sizeof( name ), "f%u", static_cast<unsigned>( file ) );
+
+        if ( lfs_file_opencfg( &ws->fs, &ws->file, name, LFS_O_WRONLY | LFS_O_APPEND, &ws->fileConfig ) != LFS_ERR_OK )
+        {
+          result.errors++;
+          continue;
+        }
+
+        for ( size_t offset = 0; offset < config.fileSize; offset += config.appendSize )
+        {
+          for ( size_t x = 0; x < config.appendSize; x++ )
+          {
+            data[ x ] = pattern( file, offset + x );
+          }
+
+          const auto written = lfs_file_write( &ws->fs, &ws->file, data.get(), config.appendSize );
+          if ( written != static_cast<lfs_ssize_t>( config.appendSize ) )
+          {
+            result.errors++;
+            break;
+          }
+
+          stats.bytes += config.appendSize;
+        }
+
+        result.errors += ( lfs_file_close( &ws->fs, &ws->file ) != LFS_ERR_OK );
+        stats.ops++;
+      }
+    }
+
+    /*-------------------------------------------------
+    Read
+    -------------------------------------------------*/
+    {
+      auto &stats = result.phases[ static_cast<size_t>( Phase::READ ) ];
+      Timer timer( adapter, clock, clockContext, stats );
+
+      for ( size_t file = 0; file < config.numFiles; file++ )
+      {
+        snprintf( name, sizeof( name ), "f%u", static_cast<unsigned>( file ) );
+
+        if ( lfs_file_opencfg( &ws->fs, &ws->file, name, LFS_O_RDONLY, &ws->fileConfig ) != LFS_ERR_OK )
+        {
+          result.errors++;
+          continue;
+        }
+
+        for ( size_t offset = 0; offset < config.fileSize; offset += config.appendSize )
+        {
+          const auto read = lfs_file_read( &ws->fs, &ws->file, data.get(), config.appendSize );
+          if ( read != static_cast<lfs_ssize_t>( config.appendSize ) )
+          {
+            result.errors++;
+            break;
+          }
+
+          for ( size_t x = 0; x < config.appendSize; x++ )
+          {
+            result.errors += ( data[ x ] != pattern( file, offset + x ) );
+          }
+
+          stats.bytes += config.appendSize;
+        }
+
+        result.errors += ( lfs_file_close( &ws->fs, &ws->file ) != LFS_ERR_OK );
+        stats.ops++;
+      }
+    }
+
+    /*-------------------------------------------------
+    Mount, now that there is something to scan
+    -------------------------------------------------*/
+    result.errors += ( lfs_unmount( &ws->fs ) != LFS_ERR_OK );
+
+    {
+      auto &stats = result.phases[ static_cast<size_t>( Phase::MOUNT ) ];
+      Timer timer( adapter, clock, clockContext, stats );
+
+      stats.ops = 1;
+      if ( lfs_mount( &ws->fs, cfg ) != LFS_ERR_OK )
+      {
+        return Status::ERR_FAIL;
+      }
+    }
+
+    result.errors += ( lfs_unmount( &ws->fs ) != LFS_ERR_OK );
+    return result.errors ? Status::ERR_FAIL : Status::ERR_OK;
+  }
+
+
+  void report( const BenchConfig &config, const BenchResult &result, EmitFunc emit )
+  {
+    /*-------------------------------------------------
+    Integer math only, see Workload::report()
+    -------------------------------------------------*/
+    char line[ LINE_SIZE ];
+
+    snprintf( line, sizeof( line ), "littlefs: files=%u size=%u append=%u errors=%u",
+              static_cast<unsigned>( config.numFiles ), static_cast<unsigned>( config.fileSize ),
+              static_cast<unsigned>( config.appendSize ), static_cast<unsigned>( result.errors ) );
+    emit( line );
+
+    for ( size_t phase = 0; phase < result.phases.size(); phase++ )
+    {
+      auto &stats = result.phases[ phase ];
+
+      snprintf( line, sizeof( line ), "  %-6s time=%luus ops/s=%lu bw=%luKiB/s dev reads=%u progs=%u erases=%u",
+                phaseName( phase ), static_cast<unsigned long>( stats.elapsedUs ),
+                static_cast<unsigned long>( perSecond( stats.ops, stats.elapsedUs ) ),
+                static_cast<unsigned long>( perSecond( stats.bytes, stats.elapsedUs ) / 1024u ),
+                static_cast<unsigned>( stats.device.reads ), static_cast<unsigned>( stats.device.progs ),
+                static_cast<unsigned>( stats.device.erases ) );
+      emit( line );
+    }
+  }
+}  // namespace Adesto::LittleFS
@@ -0,0 +1,103 @@
+/********************************************************************************
+ *  File Name:
+ *    littlefs_bench.hpp
+ *
+ *  Description:
+ *    Filesystem level benchmark of littlefs through the block device adapter.
+ *    Shared by the board tests and the host tool, which differ only in the
+ *    device and clock they pass in.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_LITTLEFS_BENCH_HPP
+#define ADESTO_LITTLEFS_BENCH_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/clock.hpp>
+#include <src/littlefs/littlefs.hpp>
+
+namespace Adesto::LittleFS
+{
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  enum class Phase : uint8_t
+  {
+    FORMAT,
+    CREATE, /**< Empty files, all metadata */
+    APPEND, /**< Grows each file in appendSize writes */
+    READ,   /**< Reads every file back and checks it */
+    MOUNT,  /**< Remount of the populated filesystem */
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct BenchConfig
+  {
+    size_t numFiles;
+    size_t fileSize;   /**< Bytes per file, multiple of appendSize */
+    size_t appendSize; /**< Bytes per write and per read */
+  };
+
+  struct PhaseStats
+  {
+    uint64_t elapsedUs;
+    uint64_t bytes;
+    size_t ops;   /**< Files touched, or one for format and mount */
+    Stats device; /**< Traffic the phase caused below littlefs */
+  };
+
+  struct BenchResult
+  {
+    std::array<PhaseStats, static_cast<size_t>( Phase::NUM_OPTIONS )> phases;
+    size_t errors; /**< Failed calls plus bytes that read back wrong */
+  };
+
+  /**
+   *  Receives one line of report text at a time, without a trailing newline
+   */
+  using EmitFunc = void ( * )( const char *const line );
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Formats the device and runs each phase in order. Destroys any data on
+   *  the device. The device must already be open.
+   *
+   *  @param[in]  config        What to run
+   *  @param[in]  device        Device under test
+   *  @param[in]  clock         Time source for the phases
+   *  @param[in]  clockContext  Passed through to the clock
+   *  @param[out] result        Per phase statistics
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status runBenchmark( const BenchConfig &config, Aurora::Memory::IGenericDevice_sPtr device, ClockFunc clock,
+                                       void *clockContext, BenchResult &result );
+
+  /**
+   *  Formats a summary of a benchmark result
+   *
+   *  @param[in]  config    Benchmark that was run
+   *  @param[in]  result    Its results
+   *  @param[in]  emit      Called once per line of output
+   *  @return void
+   */
+  void report( const BenchConfig &config, const BenchResult &result, EmitFunc emit );
+}  // namespace Adesto::LittleFS
+
+#endif /* !ADESTO_LITTLEFS_BENCH_HPP */
@@ -0,0 +1,390 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp.cpp
+ *
+ *  Description:
+ *    SFDP parser implementation. Field positions follow JESD216 and are
+ *    referenced by their 1-based DWORD number, as the standard does.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+
+namespace Adesto::SFDP
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr uint8_t FAST_READ_OPCODE = 0x0B;
+  static constexpr uint8_t FAST_READ_DUMMY  = 8;
+  static constexpr uint32_t DEFAULT_PAGE    = 256;
+
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  struct BusWidth
+  {
+    const char *name;
+    uint8_t command;
+    uint8_t address;
+    uint8_t data;
+  };
+
+  static const BusWidth sWidths[ static_cast<size_t>( ReadMode::NUM_OPTIONS ) ] = {
+    { "1-1-1", 1, 1, 1 }, { "1-1-2", 1, 1, 2 }, { "1-2-2", 1, 2, 2 }, { "2-2-2", 2, 2, 2 },
+    { "1-1-4", 1, 1, 4 }, { "1-4-4", 1, 4, 4 }, { "4-4-4", 4, 4, 4 },
+  };
+
+  /*-------------------------------------------------
+  Time unit tables, indexed by the unit field
+  -------------------------------------------------*/
+  static constexpr uint32_t sEraseUnitsUs[]     = { 1000, 16000, 128000, 1000000 };
+  static constexpr uint32_t sChipEraseUnitsUs[] = { 16000, 256000, 4000000, 64000000 };
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static constexpr uint32_t bits( const uint32_t dword, const size_t msb, const size_t lsb )
+  {
+    return ( dword >> lsb ) & ( ( 1u << ( msb - lsb + 1 ) ) - 1u );
+  }
+
+
+  static uint32_t readLE32( const uint8_t *const data )
+  {
+    return static_cast<uint32_t>( data[ 0 ] ) | ( static_cast<uint32_t>( data[ 1 ] ) << 8 )
+           | ( static_cast<uint32_t>( data[ 2 ] ) << 16 ) | ( static_cast<uint32_t>( data[ 3 ] ) << 24 );
+  }
+
+
+  /**
+   *  Typical time times a max multiplier, saturating rather than wrapping.
+   *  The largest chip erase a table can describe overflows 32 bits.
+   */
+  static uint32_t scaleUs( const uint32_t typicalUs, const uint32_t multiplier )
+  {
+    const uint64_t scaled = static_cast<uint64_t>( typicalUs ) * multiplier;
+    return static_cast<uint32_t>( std::min<uint64_t>( scaled, std::numeric_limits<uint32_t>::max() ) );
+  }
+
+
+  static FastRead decodeRead( const uint32_t field )
+  {
+    /*-------------------------------------------------
+    Each 16 bit half of DWORDs 3, 4, 6 and 7 is laid
+    out as opcode[15:8] mode[7:5] dummy[4:0].
+    -------------------------------------------------*/
+    FastRead read;
+    read.supported   = true;
+    read.opcode      = static_cast<uint8_t>( bits( field, 15, 8 ) );
+    read.modeCycles  = static_cast<uint8_t>( bits( field, 7, 5 ) );
+    read.dummyCycles = static_cast<uint8_t>( bits( field, 4, 0 ) );
+    return read;
+  }
+
+
+  static void setRead( Info &info, const ReadMode mode, const bool supported, const uint32_t field )
+  {
+    if ( supported )
+    {
+      info.reads[ static_cast<size_t>( mode ) ] = decodeRead( field );
+    }
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  void Info::clear()
+  {
+    memset( this, 0, sizeof( Info ) );
+    addressBytes = 3;
+    pageSize     = DEFAULT_PAGE;
+    fastestRead  = ReadMode::READ_1_1_1;
+  }
+
+
+  Status parse( ReadFunc read, void *context, Info &info )
+  {
+    info.clear();
+
+    if ( !read )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    SFDP header
+    -------------------------------------------------*/
+    uint8_t header[ HEADER_SIZE ];
+    if ( ( read( context, 0, header, sizeof( header ) ) != Status::ERR_OK ) || ( readLE32( header ) != SIGNATURE ) )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    info.minorRev           = header[ 4 ];
+    info.majorRev           = header[ 5 ];
+    const size_t numHeaders = std::min<size_t>( header[ 6 ] + 1u, MAX_PARAM_HEADERS );
+
+    /*-------------------------------------------------
+    Find the newest BFPT. The first parameter header is
+    required to be the BFPT, but later revisions may be
+    listed after it.
+    -------------------------------------------------*/
+    uint32_t tableAddress = 0;
+    size_t tableDwords    = 0;
+    uint16_t bestRev      = 0;
+
+    for ( size_t x = 0; x < numHeaders; x++ )
+    {
+      uint8_t param[ PARAM_HEADER_SIZE ];
+      if ( read( context, HEADER_SIZE + ( x * PARAM_HEADER_SIZE ), param, sizeof( param ) ) != Status::ERR_OK )
+      {
+        return Status::ERR_FAIL;
+      }
+
+      const uint16_t id  = static_cast<uint16_t>( ( param[ 7 ] << 8 ) | param[ 0 ] );
+      const uint16_t rev = static_cast<uint16_t>( ( param[ 2 ] << 8 ) | param[ 1 ] );
+
+      if ( ( id == BFPT_ID ) && ( !tableDwords || ( rev > bestRev ) ) )
+      {
+        bestRev      = rev;
+        tableDwords  = param[ 3 ];
+        tableAddress = static_cast<uint32_t>( param[ 4 ] ) | ( static_cast<uint32_t>( param[ 5 ] ) << 8 )
+                       | ( static_cast<uint32_t>( param[ 6 ] ) << 16 );
+      }
+    }
+
+    if ( tableDwords < BFPT_MIN_DWORDS )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Pull in the table and decode it
+    -------------------------------------------------*/
+    std::array<uint8_t, BFPT_MAX_DWORDS * sizeof( uint32_t )> raw;
+    std::array<uint32_t, BFPT_MAX_DWORDS> dwords;
+    tableDwords = std::min( tableDwords, BFPT_MAX_DWORDS );
+
+    if ( read( context, tableAddress, raw.data(), tableDwords * sizeof( uint32_t ) ) != Status::ERR_OK )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    for ( size_t x = 0; x < tableDwords; x++ )
+    {
+      dwords[ x ] = readLE32( raw.data() + ( x * sizeof( uint32_t ) ) );
+    }
+
+    const uint8_t majorRev = info.majorRev;
+    const uint8_t minorRev = info.minorRev;
+    const auto result      = parseBFPT( dwords.data(), tableDwords, info );
+
+    info.majorRev = majorRev;
+    info.minorRev = minorRev;
+    return result;
+  }
+
+
+  Status parseBFPT( const uint32_t *const dwords, const size_t count, Info &info )
+  {
+    info.clear();
+
+    if ( !dwords || ( count < BFPT_MIN_DWORDS ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /* Standard numbers the DWORDs from one */
+    auto dw = [ dwords ]( const size_t num ) { return dwords[ num - 1 ]; };
+
+    /*-------------------------------------------------
+    DWORD 2: Density, either in bits minus one or as a
+    power of two for parts of 4Gbit and larger.
+    -------------------------------------------------*/
+    const uint32_t density = dw( 2 );
+    if ( density & 0x80000000u )
+    {
+      const uint32_t exponent = bits( density, 30, 0 );
+      info.density            = ( exponent >= 3 && exponent < 67 ) ? ( 1ull << ( exponent - 3 ) ) : 0;
+    }
+    else
+    {
+      info.density = ( static_cast<uint64_t>( density ) + 1u ) / 8u;
+    }
+
+    if ( !info.density )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    DWORD 1: Address width and which of the multi-IO
+    reads exist. DWORDs 3-7 give their opcodes.
+    -------------------------------------------------*/
+    const uint32_t dw1 = dw( 1 );
+    info.addressBytes  = ( bits( dw1, 18, 17 ) == 0x2 ) ? 4 : 3;
+
+    info.reads[ static_cast<size_t>( ReadMode::READ_1_1_1 ) ] = { true, FAST_READ_OPCODE, FAST_READ_DUMMY, 0 };
+    setRead( info, ReadMode::READ_1_1_2, bits( dw1, 16, 16 ), bits( dw( 4 ), 15, 0 ) );
+    setRead( info, ReadMode::READ_1_2_2, bits( dw1, 20, 20 ), bits( dw( 4 ), 31, 16 ) );
+    setRead( info, ReadMode::READ_1_4_4, bits( dw1, 21, 21 ), bits( dw( 3 ), 15, 0 ) );
+    setRead( info, ReadMode::READ_1_1_4, bits( dw1, 22, 22 ), bits( dw( 3 ), 31, 16 ) );
+    setRead( info, ReadMode::READ_2_2_2, bits( dw( 5 ), 0, 0 ), bits( dw( 6 ), 31, 16 ) );
+    setRead( info, ReadMode::READ_4_4_4, bits( dw( 5 ), 4, 4 ), bits( dw( 7 ), 31, 16 ) );
+
+    /*-------------------------------------------------
+    DWORDs 8-9: Erase types as (size exponent, opcode)
+    pairs. DWORD 10 holds their typical times and the
+    max multiplier on JESD216A and later.
+    -------------------------------------------------*/
+    const bool hasTiming     = ( count >= BFPT_TIMING_DWORDS );
+    const uint32_t dw10      = hasTiming ? dw( 10 ) : 0;
+    const uint32_t eraseMult = 2u * ( bits( dw10, 3, 0 ) + 1u );
+
+    for ( size_t x = 0; x < MAX_ERASE_TYPES; x++ )
+    {
+      const uint32_t pair     = bits( dw( 8 + ( x / 2 ) ), ( ( x % 2 ) * 16 ) + 15, ( x % 2 ) * 16 );
+      const uint32_t exponent = bits( pair, 7, 0 );
+
+      if ( !exponent || ( exponent > 31 ) )
+      {
+        continue;
+      }
+
+      EraseType &erase = info.erase[ info.numEraseTypes++ ];
+      erase.size       = 1u << exponent;
+      erase.opcode     = static_cast<uint8_t>( bits( pair, 15, 8 ) );
+
+      if ( hasTiming )
+      {
+        const size_t lsb = 4 + ( x * 7 );
+        erase.typicalUs  = ( bits( dw10, lsb + 4, lsb ) + 1u ) * sEraseUnitsUs[ bits( dw10, lsb + 6, lsb + 5 ) ];
+        erase.maxUs      = scaleUs( erase.typicalUs, eraseMult );
+      }
+    }
+
+    std::sort( info.erase.begin(), info.erase.begin() + info.numEraseTypes,
+               []( const EraseType &a, const EraseType &b ) { return a.size < b.size; } );
+
+    /*-------------------------------------------------
+    DWORD 11: Page size, program and chip erase times.
+    Chip erase shares the erase max multiplier.
+    -------------------------------------------------*/
+    if ( hasTiming )
+    {
+      const uint32_t dw11     = dw( 11 );
+      const uint32_t progMult = 2u * ( bits( dw11, 3, 0 ) + 1u );
+
+      info.timingValid      = true;
+      info.pageSize         = 1u << bits( dw11, 7, 4 );
+      info.pageProgramTypUs = ( bits( dw11, 12, 8 ) + 1u ) * ( bits( dw11, 13, 13 ) ? 64u : 8u );
+      info.pageProgramMaxUs = scaleUs( info.pageProgramTypUs, progMult );
+      info.byteProgramTypUs = ( bits( dw11, 17, 14 ) + 1u ) * ( bits( dw11, 18, 18 ) ? 8u : 1u );
+      info.chipEraseTypUs   = ( bits( dw11, 28, 24 ) + 1u ) * sChipEraseUnitsUs[ bits( dw11, 30, 29 ) ];
+      info.chipEraseMaxUs   = scaleUs( info.chipEraseTypUs, eraseMult );
+    }
+
+    /*-------------------------------------------------
+    Rank the read modes on a page sized transfer
+    -------------------------------------------------*/
+    info.fastestRead = fastestRead( info, 4, info.pageSize );
+    return Status::ERR_OK;
+  }
+
+
+  Status toProperties( const Info &info, Properties &props )
+  {
+    if ( !info.density || !info.pageSize || !info.numEraseTypes )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    const size_t smallest = info.erase[ 0 ].size;
+    const size_t largest  = info.erase[ info.numEraseTypes - 1 ].size;
+
+    props.pageSize     = info.pageSize;
+    props.numPages     = info.density / info.pageSize;
+    props.blockSize    = smallest;
+    props.numBlocks    = info.density / smallest;
+    props.sectorSize   = largest;
+    props.numSectors   = info.density / largest;
+    props.startAddress = 0;
+    props.endAddress   = info.density;
+    props.eraseChunk   = Chunk::BLOCK;
+
+    return Status::ERR_OK;
+  }
+
+
+  size_t readCycles( const Info &info, const ReadMode mode, const size_t length )
+  {
+    const size_t idx = static_cast<size_t>( mode );
+    if ( ( idx >= info.reads.size() ) || !info.reads[ idx ].supported )
+    {
+      return 0;
+    }
+
+    const auto &width = sWidths[ idx ];
+    const auto &read  = info.reads[ idx ];
+
+    return ( 8u / width.command ) + ( ( info.addressBytes * 8u ) / width.address ) + read.modeCycles + read.dummyCycles
+           + ( ( length * 8u ) / width.data );
+  }
+
+
+  ReadMode fastestRead( const Info &info, const size_t lanes, const size_t length )
+  {
+    ReadMode mode = ReadMode::UNKNOWN;
+    size_t best   = 0;
+
+    for ( size_t x = 0; x < info.reads.size(); x++ )
+    {
+      const auto &width = sWidths[ x ];
+      if ( ( width.command > lanes ) || ( width.address > lanes ) || ( width.data > lanes ) )
+      {
+        continue;
+      }
+
+      const size_t cycles = readCycles( info, static_cast<ReadMode>( x ), length );
+      if ( cycles && ( !best || ( cycles < best ) ) )
+      {
+        best = cycles;
+        mode = static_cast<ReadMode>( x );
+      }
+    }
+
+    return mode;
+  }
+
+
+  const EraseType *findErase( const Info &info, const size_t size )
+  {
+    for ( size_t x = 0; x < info.numEraseTypes; x++ )
+    {
+      if ( info.erase[ x ].size == size )
+      {
+        return &info.erase[ x ];
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  const char *modeName( const ReadMode mode )
+  {
+    const size_t idx = static_cast<size_t>( mode );
+    return ( idx < std::size( sWidths ) ) ? sWidths[ idx ].name : "unknown";
+  }
+}  // namespace Adesto::SFDP
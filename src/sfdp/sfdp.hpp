@@ -0,0 +1,195 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp.hpp
+ *
+ *  Description:
+ *    JEDEC JESD216 Serial Flash Discoverable Parameters parser. Decodes the
+ *    Basic Flash Parameter Table into geometry, erase types, fast read modes
+ *    and operation timing so the rest of the stack doesn't need tables of
+ *    per-part constants.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_SFDP_HPP
+#define ADESTO_SFDP_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::SFDP
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr uint32_t SIGNATURE        = 0x50444653; /**< "SFDP", little endian */
+  static constexpr uint16_t BFPT_ID          = 0xFF00;     /**< JEDEC Basic Flash Parameter Table */
+  static constexpr uint8_t CMD_READ_SFDP     = 0x5A;       /**< Read SFDP opcode, 1-1-1 with 8 dummy cycles */
+  static constexpr uint8_t READ_SFDP_DUMMY   = 8;
+  static constexpr size_t HEADER_SIZE        = 8;
+  static constexpr size_t PARAM_HEADER_SIZE  = 8;
+  static constexpr size_t MAX_PARAM_HEADERS  = 16;
+  static constexpr size_t BFPT_MIN_DWORDS    = 9;  /**< JESD216 original */
+  static constexpr size_t BFPT_TIMING_DWORDS = 11; /**< JESD216A added page size and timing */
+  static constexpr size_t BFPT_MAX_DWORDS    = 23; /**< JESD216F, longer tables are truncated */
+  static constexpr size_t MAX_ERASE_TYPES    = 4;
+
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Read modes in command-address-data bus width notation
+   */
+  enum class ReadMode : uint8_t
+  {
+    READ_1_1_1, /**< Fast read, always present on SFDP capable parts */
+    READ_1_1_2,
+    READ_1_2_2,
+    READ_2_2_2,
+    READ_1_1_4,
+    READ_1_4_4,
+    READ_4_4_4,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct EraseType
+  {
+    uint32_t size;      /**< Bytes erased, zero when the slot is unused */
+    uint8_t opcode;
+    uint32_t typicalUs; /**< Zero when the table doesn't publish timing */
+    uint32_t maxUs;     /**< Saturates at UINT32_MAX, as do the other max times */
+  };
+
+  struct FastRead
+  {
+    bool supported;
+    uint8_t opcode;
+    uint8_t dummyCycles;
+    uint8_t modeCycles; /**< Mode bit clocks, sent between the address and the dummy cycles */
+  };
+
+  /**
+   *  Everything decoded from the SFDP tables. Erase types are sorted smallest
+   *  first and empty slots are at the end.
+   */
+  struct Info
+  {
+    uint8_t majorRev;
+    uint8_t minorRev;
+    uint8_t addressBytes; /**< 3 or 4 */
+    uint64_t density;     /**< Bytes */
+    uint32_t pageSize;    /**< Defaults to 256 on tables that predate JESD216A */
+    size_t numEraseTypes;
+    std::array<EraseType, MAX_ERASE_TYPES> erase;
+    std::array<FastRead, static_cast<size_t>( ReadMode::NUM_OPTIONS )> reads;
+    ReadMode fastestRead; /**< Mode needing the fewest bus clocks for a page sized read on a quad bus */
+    bool timingValid;     /**< The fields below are only populated on JESD216A or later */
+    uint32_t pageProgramTypUs;
+    uint32_t pageProgramMaxUs;
+    uint32_t byteProgramTypUs;
+    uint32_t chipEraseTypUs;
+    uint32_t chipEraseMaxUs;
+
+    void clear();
+  };
+
+  /**
+   *  Reads raw bytes out of the SFDP address space
+   *
+   *  @param[in]  context   User data given alongside the function
+   *  @param[in]  address   SFDP address to start at
+   *  @param[out] data      Destination buffer
+   *  @param[in]  length    Number of bytes to read
+   *  @return Aurora::Memory::Status
+   */
+  using ReadFunc = Aurora::Memory::Status ( * )( void *context, const uint32_t address, void *const data,
+                                                 const size_t length );
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Reads the SFDP header, locates the newest Basic Flash Parameter Table
+   *  and decodes it.
+   *
+   *  @param[in]  read      Access to the SFDP address space
+   *  @param[in]  context   Passed through to the read function
+   *  @param[out] info      Decoded parameters
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status parse( ReadFunc read, void *context, Info &info );
+
+  /**
+   *  Decodes a Basic Flash Parameter Table that has already been read out
+   *
+   *  @param[in]  dwords    Table contents
+   *  @param[in]  count     Number of dwords in the table
+   *  @param[out] info      Decoded parameters
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status parseBFPT( const uint32_t *const dwords, const size_t count, Info &info );
+
+  /**
+   *  Fills in the geometry fields of a property set. The smallest erase type
+   *  becomes the block and the largest the sector. The JEDEC code is not
+   *  part of SFDP and is left untouched.
+   *
+   *  @param[in]  info      Decoded parameters
+   *  @param[out] props     Properties to update
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status toProperties( const Info &info, Aurora::Memory::Properties &props );
+
+  /**
+   *  Bus clocks needed to read a number of bytes in the given mode, including
+   *  the opcode, address, mode and dummy phases.
+   *
+   *  @param[in]  info      Decoded parameters
+   *  @param[in]  mode      Read mode to cost
+   *  @param[in]  length    Bytes to read
+   *  @return size_t        Zero if the mode isn't supported
+   */
+  size_t readCycles( const Info &info, const ReadMode mode, const size_t length );
+
+  /**
+   *  Picks the supported read mode needing the fewest bus clocks, limited to
+   *  the modes a bus with the given number of data lanes can carry. Only
+   *  1-1-1 is possible on a plain SPI peripheral.
+   *
+   *  @param[in]  info      Decoded parameters
+   *  @param[in]  lanes     Data lanes wired between controller and part (1, 2 or 4)
+   *  @param[in]  length    Typical transfer size in bytes to rank the modes on
+   *  @return ReadMode      ReadMode::UNKNOWN if nothing fits the bus
+   */
+  ReadMode fastestRead( const Info &info, const size_t lanes, const size_t length );
+
+  /**
+   *  Finds the erase type with the given size
+   *
+   *  @param[in]  info      Decoded parameters
+   *  @param[in]  size      Erase size in bytes
+   *  @return const EraseType*  nullptr if the part has no such erase
+   */
+  const EraseType *findErase( const Info &info, const size_t size );
+
+  /**
+   *  Human readable name of a read mode, ie "1-4-4"
+   *
+   *  @param[in]  mode      Read mode
+   *  @return const char*
+   */
+  const char *modeName( const ReadMode mode );
+}  // namespace Adesto::SFDP
+
+#endif /* !ADESTO_SFDP_HPP */
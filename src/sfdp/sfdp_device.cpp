@@ -0,0 +1,128 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp_device.cpp
+ *
+ *  Description:
+ *    Implementation of the SFDP discovery decorator
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp_device.hpp>
+
+namespace Adesto::SFDP
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Device Implementation
+  -------------------------------------------------------------------------------*/
+  Device::Device( IGenericDevice_sPtr device, ReadFunc read, void *context ) :
+      mDevice( device ), mRead( read ), mContext( context ), mDiscovered( false )
+  {
+    mInfo.clear();
+    mProps = {};
+  }
+
+
+  Device::~Device()
+  {
+  }
+
+
+  bool Device::discovered() const
+  {
+    return mDiscovered;
+  }
+
+
+  const Info &Device::getInfo() const
+  {
+    return mInfo;
+  }
+
+
+  Status Device::open()
+  {
+    const auto result = mDevice->open();
+    if ( result != Status::ERR_OK )
+    {
+      return result;
+    }
+
+    /*-------------------------------------------------
+    Start from the driver's view so fields SFDP has no
+    say in (JEDEC code) are carried over, then let the
+    tables override the geometry. A part without SFDP
+    still opens, it just keeps the driver defaults.
+    -------------------------------------------------*/
+    mProps      = mDevice->getDeviceProperties();
+    mDiscovered = ( parse( mRead, mContext, mInfo ) == Status::ERR_OK ) && ( toProperties( mInfo, mProps ) == Status::ERR_OK );
+
+    if ( !mDiscovered )
+    {
+      mProps = mDevice->getDeviceProperties();
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::close()
+  {
+    mDiscovered = false;
+    return mDevice->close();
+  }
+
+
+  Status Device::write( const size_t address, const void *const data, const size_t length )
+  {
+    return mDevice->write( address, data, length );
+  }
+
+
+  Status Device::read( const size_t address, void *const data, const size_t length )
+  {
+    return mDevice->read( address, data, length );
+  }
+
+
+  Status Device::erase( const size_t address, const size_t length )
+  {
+    return mDevice->erase( address, length );
+  }
+
+
+  Status Device::erase( const Chunk chunk, const size_t id )
+  {
+    /*-------------------------------------------------
+    Chunk ids are relative to our geometry, which may
+    differ from the driver's, so pass on an address.
+    -------------------------------------------------*/
+    if ( !mDiscovered )
+    {
+      return mDevice->erase( chunk, id );
+    }
+
+    return mDevice->erase( chunkStartAddress( mProps, chunk, id ), chunkSize( mProps, chunk ) );
+  }
+
+
+  Status Device::eraseChip()
+  {
+    return mDevice->eraseChip();
+  }
+
+
+  Properties Device::getDeviceProperties()
+  {
+    return mDiscovered ? mProps : mDevice->getDeviceProperties();
+  }
+
+
+  Status Device::pendEvent( const Event event, const size_t timeout )
+  {
+    return mDevice->pendEvent( event, timeout );
+  }
+}  // namespace Adesto::SFDP
@@ -0,0 +1,76 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp_device.hpp
+ *
+ *  Description:
+ *    Decorator that discovers a device's geometry from its SFDP tables when
+ *    it is opened, replacing the hardcoded properties of the wrapped driver.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_SFDP_DEVICE_HPP
+#define ADESTO_SFDP_DEVICE_HPP
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+
+namespace Adesto::SFDP
+{
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  class Device : public Aurora::Memory::IGenericDevice
+  {
+  public:
+    /**
+     *  @param[in]  device    Driver to wrap
+     *  @param[in]  read      Access to the device's SFDP address space
+     *  @param[in]  context   Passed through to the read function
+     */
+    Device( Aurora::Memory::IGenericDevice_sPtr device, ReadFunc read, void *context );
+    ~Device();
+
+    /**
+     *  Whether the last open() decoded the SFDP tables. When it didn't, the
+     *  wrapped driver's own properties are reported instead.
+     *
+     *  @return bool
+     */
+    bool discovered() const;
+
+    /**
+     *  Parameters decoded on the last open()
+     *
+     *  @return const Info&
+     */
+    const Info &getInfo() const;
+
+    /*-------------------------------------------------
+    Generic Device Interface
+    -------------------------------------------------*/
+    Aurora::Memory::Status open() override;
+    Aurora::Memory::Status close() override;
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length ) override;
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length ) override;
+    Aurora::Memory::Status erase( const size_t address, const size_t length ) override;
+    Aurora::Memory::Status erase( const Aurora::Memory::Chunk chunk, const size_t id ) override;
+    Aurora::Memory::Status eraseChip() override;
+    Aurora::Memory::Properties getDeviceProperties() override;
+    Aurora::Memory::Status pendEvent( const Aurora::Memory::Event event, const size_t timeout ) override;
+
+  private:
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    ReadFunc mRead;
+    void *mContext;
+    Info mInfo;
+    Aurora::Memory::Properties mProps;
+    bool mDiscovered;
+  };
+}  // namespace Adesto::SFDP
+
+#endif /* !ADESTO_SFDP_DEVICE_HPP */
@@ -0,0 +1,67 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp_spi.cpp
+ *
+ *  Description:
+ *    SFDP transport over a Chimera SPI driver
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/spi>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/sfdp/sfdp_spi.hpp>
+
+namespace Adesto::SFDP
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  Status readSPI( void *context, const uint32_t address, void *const data, const size_t length )
+  {
+    if ( !context || !data || !length )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    auto spi = Chimera::SPI::getDriver( *static_cast<Chimera::SPI::Channel *>( context ) );
+    if ( !spi )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Opcode, 24 bit address, then one byte of dummy
+    clocks. Data follows in the same CS window.
+    -------------------------------------------------*/
+    const std::array<uint8_t, 5> cmd = { CMD_READ_SFDP, static_cast<uint8_t>( address >> 16 ),
+                                         static_cast<uint8_t>( address >> 8 ), static_cast<uint8_t>( address ),
+                                         0x00 };
+    static_assert( ( READ_SFDP_DUMMY / 8 ) == 1 );
+
+    auto result = Chimera::Status::OK;
+
+    spi->lock();
+    spi->setChipSelect( Chimera::GPIO::State::LOW );
+
+    result |= spi->writeBytes( cmd.data(), cmd.size() );
+    spi->await( Chimera::Event::TRIGGER_TRANSFER_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+
+    result |= spi->readBytes( data, length );
+    spi->await( Chimera::Event::TRIGGER_TRANSFER_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+
+    spi->setChipSelect( Chimera::GPIO::State::HIGH );
+    spi->unlock();
+
+    return ( result == Chimera::Status::OK ) ? Status::ERR_OK : Status::ERR_FAIL;
+  }
+}  // namespace Adesto::SFDP
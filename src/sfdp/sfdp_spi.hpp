@@ -0,0 +1,41 @@
+/********************************************************************************
+ *  File Name:
+ *    sfdp_spi.hpp
+ *
+ *  Description:
+ *    SFDP transport over a Chimera SPI driver, for parts wired to a plain
+ *    single line SPI port with a manually controlled chip select.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_SFDP_SPI_HPP
+#define ADESTO_SFDP_SPI_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::SFDP
+{
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  ReadFunc implementation that issues the Read SFDP command. The context
+   *  is a pointer to the Chimera::SPI::Channel the part is attached to.
+   *
+   *  @param[in]  context   Chimera::SPI::Channel*
+   *  @param[in]  address   SFDP address to start at
+   *  @param[out] data      Destination buffer
+   *  @param[in]  length    Number of bytes to read
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status readSPI( void *context, const uint32_t address, void *const data, const size_t length );
+}  // namespace Adesto::SFDP
+
+#endif /* !ADESTO_SFDP_SPI_HPP */
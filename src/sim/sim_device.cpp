@@ -0,0 +1,552 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_device.cpp
+ *
+ *  Description:
+ *    Implementation of the simulated NOR flash device
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/sim/sim_device.hpp>
+
+namespace Adesto::Sim
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t SZ_4K  = 4 * 1024;
+  static constexpr size_t SZ_32K = 32 * 1024;
+  static constexpr size_t SZ_64K = 64 * 1024;
+
+  /*-------------------------------------------------
+  Read modes advertised in SFDP
+  -------------------------------------------------*/
+  static constexpr uint8_t modeBit( const SFDP::ReadMode mode )
+  {
+    return static_cast<uint8_t>( 1u << static_cast<uint8_t>( mode ) );
+  }
+
+  static constexpr uint8_t MODES_QUAD = modeBit( SFDP::ReadMode::READ_1_1_2 ) | modeBit( SFDP::ReadMode::READ_1_2_2 )
+                                        | modeBit( SFDP::ReadMode::READ_1_1_4 ) | modeBit( SFDP::ReadMode::READ_1_4_4 );
+  static constexpr uint8_t MODES_QPI  = MODES_QUAD | modeBit( SFDP::ReadMode::READ_4_4_4 );
+
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  /* clang-format off */
+  static const Geometry sGeometry[ static_cast<size_t>( Model::NUM_OPTIONS ) ] = {
+    /* Name          Mfr   Type  Cap   Page  Block  Sector  Size             Reads */
+    { "AT25SF081",   0x1F, 0x85, 0x01, 256,  SZ_4K, SZ_64K, 1 * 1024 * 1024, MODES_QUAD },
+    { "AT25SF321",   0x1F, 0x87, 0x01, 256,  SZ_4K, SZ_64K, 4 * 1024 * 1024, MODES_QUAD },
+    { "AT25SF641",   0x1F, 0x32, 0x17, 256,  SZ_4K, SZ_64K, 8 * 1024 * 1024, MODES_QPI },
+  };
+
+  /*-------------------------------------------------
+  Typical datasheet values, with the bus running at
+  the same rate the hardware tests configure.
+  -------------------------------------------------*/
+  static const TimingProfile sTiming[ static_cast<size_t>( Model::NUM_OPTIONS ) ] = {
+    /* Name          Clock    Ovh  Prog  4K      32K      64K      Chip */
+    { "AT25SF081",   8000000, 2,   400,  45000,  120000,  200000,  4000000 },
+    { "AT25SF321",   8000000, 2,   400,  60000,  160000,  300000,  20000000 },
+    { "AT25SF641",   8000000, 2,   400,  60000,  160000,  300000,  30000000 },
+  };
+
+  static const TimingProfile sIdealTiming = { "ideal", 0, 0, 0, 0, 0, 0, 0 };
+  /* clang-format on */
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  const Geometry &getGeometry( const Model model )
+  {
+    const size_t idx = static_cast<size_t>( model );
+    return sGeometry[ ( idx < static_cast<size_t>( Model::NUM_OPTIONS ) ) ? idx : 0 ];
+  }
+
+
+  const TimingProfile &getTiming( const Model model )
+  {
+    const size_t idx = static_cast<size_t>( model );
+    return sTiming[ ( idx < static_cast<size_t>( Model::NUM_OPTIONS ) ) ? idx : 0 ];
+  }
+
+
+  const TimingProfile &getIdealTiming()
+  {
+    return sIdealTiming;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Device Implementation
+  -------------------------------------------------------------------------------*/
+  Device::Device( const Geometry &geometry, const TimingProfile &timing ) :
+      mGeometry( geometry ), mTiming( timing ), mNow( 0 ), mLastLatency( 0 ), mStreamAddress( 0 ), mSteps( 0 ),
+      mLossAt( SIZE_MAX ), mStreaming( false ), mPowerLost( false ), mOpen( false )
+  {
+    mProps              = {};
+    mProps.jedec        = geometry.manufacturer;
+    mProps.pageSize     = geometry.pageSize;
+    mProps.numPages     = geometry.deviceSize / geometry.pageSize;
+    mProps.blockSize    = geometry.blockSize;
+    mProps.numBlocks    = geometry.deviceSize / geometry.blockSize;
+    mProps.sectorSize   = geometry.sectorSize;
+    mProps.numSectors   = geometry.deviceSize / geometry.sectorSize;
+    mProps.startAddress = 0;
+    mProps.endAddress   = geometry.deviceSize;
+    mProps.eraseChunk   = Chunk::BLOCK;
+
+    /*-------------------------------------------------
+    Parts ship erased
+    -------------------------------------------------*/
+    mData.assign( geometry.deviceSize, 0xFF );
+    mEraseCounts.assign( geometry.deviceSize / geometry.blockSize, 0 );
+    mSFDP = buildSFDP( geometry, timing );
+    clearStats();
+  }
+
+
+  Device::Device( const Model model ) : Device( Sim::getGeometry( model ), Sim::getTiming( model ) )
+  {
+  }
+
+
+  Device::~Device()
+  {
+  }
+
+
+  void Device::setTiming( const TimingProfile &timing )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mTiming = timing;
+  }
+
+
+  uint64_t Device::now() const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return mNow;
+  }
+
+
+  void Device::advance( const uint64_t us )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mNow += us;
+  }
+
+
+  uint32_t Device::lastLatency() const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return mLastLatency;
+  }
+
+
+  uint32_t Device::eraseCount( const size_t unit ) const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return ( unit < mEraseCounts.size() ) ? mEraseCounts[ unit ] : 0;
+  }
+
+
+  Status Device::readSFDP( const uint32_t address, void *const data, const size_t length )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( !data )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    auto dst = reinterpret_cast<uint8_t *>( data );
+    for ( size_t x = 0; x < length; x++ )
+    {
+      const size_t offset = address + x;
+      dst[ x ]            = ( offset < mSFDP.size() ) ? mSFDP[ offset ] : 0xFF;
+    }
+
+    charge( mTiming.commandOverhead + transferTime( length ) );
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::beginStream( const size_t address )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( mStreaming || !inRange( address, 0 ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    mStreaming     = true;
+    mStreamAddress = address;
+
+    mStats.reads++;
+    charge( mTiming.commandOverhead );
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::streamRead( void *const data, const size_t length )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( !mStreaming || !data )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    auto dst      = reinterpret_cast<uint8_t *>( data );
+    size_t offset = 0;
+
+    while ( offset < length )
+    {
+      const size_t chunk = std::min( length - offset, mData.size() - mStreamAddress );
+      memcpy( dst + offset, mData.data() + mStreamAddress, chunk );
+
+      offset += chunk;
+      mStreamAddress = ( mStreamAddress + chunk ) % mData.size();
+    }
+
+    mStats.bytesRead += length;
+    charge( transferTime( length ) );
+    return Status::ERR_OK;
+  }
+
+
+  void Device::endStream()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mStreaming = false;
+  }
+
+
+  void Device::armPowerLoss( const size_t steps )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mLossAt = mSteps + steps;
+  }
+
+
+  void Device::disarmPowerLoss()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mLossAt = SIZE_MAX;
+  }
+
+
+  void Device::powerOn()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mPowerLost = false;
+    mStreaming = false;
+    mLossAt    = SIZE_MAX;
+  }
+
+
+  bool Device::powerLost() const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return mPowerLost;
+  }
+
+
+  size_t Device::steps() const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return mSteps;
+  }
+
+
+  size_t Device::numEraseUnits() const
+  {
+    return mEraseCounts.size();
+  }
+
+
+  Stats Device::getStats() const
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    return mStats;
+  }
+
+
+  void Device::clearStats()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    memset( &mStats, 0, sizeof( mStats ) );
+  }
+
+
+  const Geometry &Device::getGeometry() const
+  {
+    return mGeometry;
+  }
+
+
+  Status Device::open()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mOpen = true;
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::close()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+    mOpen = false;
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::write( const size_t address, const void *const data, const size_t length )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Program one page at a time, just like the driver
+    has to. NOR can only clear bits, so AND the data in.
+    -------------------------------------------------*/
+    auto src       = reinterpret_cast<const uint8_t *>( data );
+    size_t offset  = 0;
+    uint32_t spent = 0;
+
+    while ( offset < length )
+    {
+      const size_t pageOffset = ( address + offset ) % mGeometry.pageSize;
+      const size_t chunk      = std::min( length - offset, mGeometry.pageSize - pageOffset );
+      uint8_t *dst            = mData.data() + address + offset;
+      const bool complete     = completeStep();
+      const size_t programmed = complete ? chunk : ( chunk / 2 );
+
+      for ( size_t x = 0; x < programmed; x++ )
+      {
+        if ( ( dst[ x ] & src[ offset + x ] ) != src[ offset + x ] )
+        {
+          mStats.programViolations++;
+        }
+
+        dst[ x ] &= src[ offset + x ];
+      }
+
+      spent += mTiming.commandOverhead + transferTime( chunk ) + mTiming.pageProgram;
+      offset += chunk;
+
+      if ( !complete )
+      {
+        charge( spent );
+        return Status::ERR_FAIL;
+      }
+    }
+
+    mStats.writes++;
+    mStats.bytesWritten += length;
+    charge( spent );
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::read( const size_t address, void *const data, const size_t length )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    memcpy( data, mData.data() + address, length );
+
+    mStats.reads++;
+    mStats.bytesRead += length;
+    charge( mTiming.commandOverhead + transferTime( length ) );
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::erase( const size_t address, const size_t length )
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( !length || !inRange( address, length ) || ( address % mGeometry.blockSize ) || ( length % mGeometry.blockSize ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Use the biggest erase command that fits at each
+    step, the same way a driver would.
+    -------------------------------------------------*/
+    size_t offset  = 0;
+    uint32_t spent = 0;
+
+    while ( offset < length )
+    {
+      const size_t current   = address + offset;
+      const size_t remaining = length - offset;
+      size_t size            = SZ_4K;
+      uint32_t busy          = mTiming.erase4K;
+
+      if ( !( current % SZ_64K ) && ( remaining >= SZ_64K ) )
+      {
+        size = SZ_64K;
+        busy = mTiming.erase64K;
+      }
+      else if ( !( current % SZ_32K ) && ( remaining >= SZ_32K ) )
+      {
+        size = SZ_32K;
+        busy = mTiming.erase32K;
+      }
+
+      size                = std::max( size, mGeometry.blockSize );
+      const bool complete = completeStep();
+      memset( mData.data() + current, 0xFF, complete ? size : ( size / 2 ) );
+
+      for ( size_t unit = current / mGeometry.blockSize; unit < ( current + size ) / mGeometry.blockSize; unit++ )
+      {
+        mEraseCounts[ unit ]++;
+      }
+
+      mStats.erases++;
+      spent += mTiming.commandOverhead + busy;
+      offset += size;
+
+      if ( !complete )
+      {
+        charge( spent );
+        return Status::ERR_FAIL;
+      }
+    }
+
+    charge( spent );
+    return Status::ERR_OK;
+  }
+
+
+  Status Device::erase( const Chunk chunk, const size_t id )
+  {
+    return erase( chunkStartAddress( mProps, chunk, id ), chunkSize( mProps, chunk ) );
+  }
+
+
+  Status Device::eraseChip()
+  {
+    std::lock_guard<std::recursive_mutex> lock( mLock );
+
+    if ( mPowerLost )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    const bool complete = completeStep();
+    std::fill( mData.begin(), complete ? mData.end() : ( mData.begin() + ( mData.size() / 2 ) ), 0xFF );
+    for ( auto &count : mEraseCounts )
+    {
+      count++;
+    }
+
+    mStats.chipErases++;
+    charge( mTiming.commandOverhead + mTiming.eraseChip );
+    return complete ? Status::ERR_OK : Status::ERR_FAIL;
+  }
+
+
+  Properties Device::getDeviceProperties()
+  {
+    return mProps;
+  }
+
+
+  Status Device::pendEvent( const Event event, const size_t timeout )
+  {
+    /*-------------------------------------------------
+    Every operation completes before returning, with the
+    time it would have taken charged to the clock.
+    -------------------------------------------------*/
+    return Status::ERR_OK;
+  }
+
+
+  bool Device::inRange( const size_t address, const size_t length ) const
+  {
+    return ( address < mData.size() ) && ( length <= ( mData.size() - address ) );
+  }
+
+
+  bool Device::completeStep()
+  {
+    /*-------------------------------------------------
+    Power drops in the middle of the armed step
+    -------------------------------------------------*/
+    if ( mSteps++ != mLossAt )
+    {
+      return true;
+    }
+
+    mLossAt    = SIZE_MAX;
+    mPowerLost = true;
+    return false;
+  }
+
+
+  uint32_t Device::transferTime( const size_t bytes ) const
+  {
+    if ( !mTiming.busClockHz )
+    {
+      return 0;
+    }
+
+    return static_cast<uint32_t>( ( static_cast<uint64_t>( bytes ) * 8u * 1000000u ) / mTiming.busClockHz );
+  }
+
+
+  void Device::charge( const uint32_t us )
+  {
+    mLastLatency = us;
+    mNow += us;
+  }
+}  // namespace Adesto::Sim
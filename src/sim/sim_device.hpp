@@ -0,0 +1,310 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_device.hpp
+ *
+ *  Description:
+ *    Host side model of an Adesto NOR flash part. Data follows NOR rules
+ *    (programming only clears bits, erasing sets them) and every operation
+ *    advances a virtual clock according to a timing profile, so results are
+ *    deterministic and independent of how fast the host happens to be.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_SIM_DEVICE_HPP
+#define ADESTO_SIM_DEVICE_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::Stream
+{
+  struct Transport;
+}
+
+namespace Adesto::Sim
+{
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  enum class Model : uint8_t
+  {
+    AT25SF081,
+    AT25SF321,
+    AT25SF641,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Physical layout of the modeled part
+   */
+  struct Geometry
+  {
+    const char *name;
+    uint8_t manufacturer; /**< JEDEC manufacturer id */
+    uint8_t memoryType;   /**< JEDEC device id byte 1 */
+    uint8_t capacity;     /**< JEDEC device id byte 2 */
+    size_t pageSize;
+    size_t blockSize;  /**< Smallest erase unit */
+    size_t sectorSize; /**< Largest erase unit */
+    size_t deviceSize;
+    uint8_t readModes; /**< Multi-IO reads advertised over SFDP, bitmask of 1 << SFDP::ReadMode */
+  };
+
+  /**
+   *  Time spent by each operation, in microseconds. Transfer time on the bus
+   *  is derived from the clock rate, busy times are added on top.
+   */
+  struct TimingProfile
+  {
+    const char *name;
+    uint32_t busClockHz;      /**< SPI clock, zero for an infinitely fast bus */
+    uint32_t commandOverhead; /**< Per command fixed cost (CS toggle, opcode, address) */
+    uint32_t pageProgram;     /**< Busy time to program one page */
+    uint32_t erase4K;
+    uint32_t erase32K;
+    uint32_t erase64K;
+    uint32_t eraseChip;
+  };
+
+  /**
+   *  Running totals of everything the device has been asked to do
+   */
+  struct Stats
+  {
+    size_t reads;
+    size_t writes;
+    size_t erases; /**< Erase commands of any size, excluding chip erase */
+    size_t chipErases;
+    size_t bytesRead;
+    size_t bytesWritten;
+    size_t programViolations; /**< Programs that tried to set a bit back to one */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Looks up the geometry of a modeled part
+   *
+   *  @param[in]  model     Which part
+   *  @return const Geometry&
+   */
+  const Geometry &getGeometry( const Model model );
+
+  /**
+   *  Looks up the typical timing of a modeled part
+   *
+   *  @param[in]  model     Which part
+   *  @return const TimingProfile&
+   */
+  const TimingProfile &getTiming( const Model model );
+
+  /**
+   *  Timing profile where nothing takes any time at all. Useful for checking
+   *  the CPU overhead of layers stacked on top of the device.
+   *
+   *  @return const TimingProfile&
+   */
+  const TimingProfile &getIdealTiming();
+
+  /**
+   *  Generates the SFDP image a part with the given geometry and timing would
+   *  report: a JESD216B Basic Flash Parameter Table listing the simulator's
+   *  4K/32K/64K erase commands and the read modes in the geometry.
+   *
+   *  @param[in]  geometry  Part layout
+   *  @param[in]  timing    Typical operation times to advertise
+   *  @return std::vector<uint8_t>
+   */
+  std::vector<uint8_t> buildSFDP( const Geometry &geometry, const TimingProfile &timing );
+
+  /**
+   *  SFDP::ReadFunc compatible accessor, context is the Sim::Device
+   *
+   *  @param[in]  context   Sim::Device*
+   *  @param[in]  address   SFDP address to start at
+   *  @param[out] data      Destination buffer
+   *  @param[in]  length    Number of bytes to read
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status readSFDP( void *context, const uint32_t address, void *const data, const size_t length );
+
+  /**
+   *  Stream::Transport serving continuous reads, context is the Sim::Device
+   *
+   *  @return const Stream::Transport&
+   */
+  const Stream::Transport &streamTransport();
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  class Device : public Aurora::Memory::IGenericDevice
+  {
+  public:
+    Device( const Geometry &geometry, const TimingProfile &timing );
+    Device( const Model model );
+    ~Device();
+
+    /**
+     *  Swaps the timing profile without touching the stored data
+     *
+     *  @param[in]  timing    New timing profile
+     *  @return void
+     */
+    void setTiming( const TimingProfile &timing );
+
+    /**
+     *  Current value of the virtual clock
+     *
+     *  @return uint64_t      Microseconds of simulated device time
+     */
+    uint64_t now() const;
+
+    /**
+     *  Moves the virtual clock forward, ie to model the host idling
+     *
+     *  @param[in]  us        Microseconds to advance
+     *  @return void
+     */
+    void advance( const uint64_t us );
+
+    /**
+     *  Simulated latency of the most recent operation
+     *
+     *  @return uint32_t
+     */
+    uint32_t lastLatency() const;
+
+    /**
+     *  Number of times an erase unit has been erased
+     *
+     *  @param[in]  unit      Erase unit index (geometry blockSize granularity)
+     *  @return uint32_t
+     */
+    uint32_t eraseCount( const size_t unit ) const;
+
+    /**
+     *  Serves the Read SFDP command. Reads past the end of the tables return
+     *  the erased state, like an unprogrammed region of the SFDP space.
+     *
+     *  @param[in]  address   SFDP address to start at
+     *  @param[out] data      Destination buffer
+     *  @param[in]  length    Number of bytes to read
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status readSFDP( const uint32_t address, void *const data, const size_t length );
+
+    /**
+     *  Starts a continuous read. The command overhead is charged once here,
+     *  after which streamRead() costs only bus time. Counts as one read.
+     *
+     *  @param[in]  address   Where the stream starts
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status beginStream( const size_t address );
+
+    /**
+     *  Clocks out the next bytes of the stream. Like the real part, the
+     *  address wraps to zero past the end of the array.
+     *
+     *  @param[out] data      Destination buffer
+     *  @param[in]  length    Number of bytes to read
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status streamRead( void *const data, const size_t length );
+
+    /**
+     *  Ends the continuous read
+     *
+     *  @return void
+     */
+    void endStream();
+
+    /**
+     *  Arms a power loss. The given number of program or erase steps (one
+     *  page program or one erase command each) complete normally. The next
+     *  one is cut off halfway, leaving a partly programmed page or a partly
+     *  erased unit, and the device then fails every call until powerOn().
+     *
+     *  @param[in]  steps     Steps to let through before losing power
+     *  @return void
+     */
+    void armPowerLoss( const size_t steps );
+
+    /**
+     *  Cancels an armed power loss that hasn't happened yet
+     *
+     *  @return void
+     */
+    void disarmPowerLoss();
+
+    /**
+     *  Restores power after a loss. Stored data is left as the loss found it.
+     *
+     *  @return void
+     */
+    void powerOn();
+
+    bool powerLost() const;
+    size_t steps() const; /**< Program and erase steps since construction */
+    size_t numEraseUnits() const;
+    Stats getStats() const;
+    void clearStats();
+    const Geometry &getGeometry() const;
+
+    /*-------------------------------------------------
+    Generic Device Interface
+    -------------------------------------------------*/
+    Aurora::Memory::Status open() override;
+    Aurora::Memory::Status close() override;
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length ) override;
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length ) override;
+    Aurora::Memory::Status erase( const size_t address, const size_t length ) override;
+    Aurora::Memory::Status erase( const Aurora::Memory::Chunk chunk, const size_t id ) override;
+    Aurora::Memory::Status eraseChip() override;
+    Aurora::Memory::Properties getDeviceProperties() override;
+    Aurora::Memory::Status pendEvent( const Aurora::Memory::Event event, const size_t timeout ) override;
+
+  private:
+    mutable std::recursive_mutex mLock;
+    Geometry mGeometry;
+    TimingProfile mTiming;
+    Aurora::Memory::Properties mProps;
+    std::vector<uint8_t> mData;
+    std::vector<uint32_t> mEraseCounts;
+    std::vector<uint8_t> mSFDP;
+    Stats mStats;
+    uint64_t mNow;
+    uint32_t mLastLatency;
+    size_t mStreamAddress;
+    size_t mSteps;
+    size_t mLossAt; /**< Step that loses power, SIZE_MAX when disarmed */
+    bool mStreaming;
+    bool mPowerLost;
+    bool mOpen;
+
+    bool inRange( const size_t address, const size_t length ) const;
+    bool completeStep();
+    uint32_t transferTime( const size_t bytes ) const;
+    void charge( const uint32_t us );
+  };
+
+  using Device_sPtr = std::shared_ptr<Device>;
+}  // namespace Adesto::Sim
+
+#endif /* !ADESTO_SIM_DEVICE_HPP */
@@ -0,0 +1,463 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_endurance.cpp
+ *
+ *  Description:
+ *    Implementation of the fast forward endurance model
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+
+/* Adesto Includes */
+#include <src/sim/sim_endurance.hpp>
+
+namespace Adesto::Sim
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  /*-------------------------------------------------
+  Datasheet endurance for the whole family. The worn
+  error rate is a modeling choice, not a spec value.
+  -------------------------------------------------*/
+  static const EnduranceProfile sEndurance[ static_cast<size_t>( Model::NUM_OPTIONS ) ] = {
+    { 100000, 1e-4, 0x0825F081 },
+    { 100000, 1e-4, 0x0825F321 },
+    { 100000, 1e-4, 0x0825F641 },
+  };
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  SplitMix64, good enough for picking bits and cheap to seed per page
+   */
+  static inline uint64_t nextRandom( uint64_t &state )
+  {
+    uint64_t z = ( state += 0x9E3779B97F4A7C15ull );
+    z          = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+    z          = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+    return z ^ ( z >> 31 );
+  }
+
+
+  static bool isBlank( const uint8_t *const data, const size_t length )
+  {
+    for ( size_t x = 0; x < length; x++ )
+    {
+      if ( data[ x ] != 0xFF )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  const EnduranceProfile &getEnduranceProfile( const Model model )
+  {
+    return sEndurance[ std::min( static_cast<size_t>( model ), static_cast<size_t>( Model::NUM_OPTIONS ) - 1 ) ];
+  }
+
+  /*-------------------------------------------------------------------------------
+  EnduranceDevice Implementation
+  -------------------------------------------------------------------------------*/
+  EnduranceDevice::EnduranceDevice( const Geometry &geometry, const EnduranceProfile &profile ) :
+      mGeometry( geometry ), mProfile( profile ), mNumUnits( geometry.deviceSize / geometry.blockSize ),
+      mResidentUnits( 0 ), mPeakResidentUnits( 0 )
+  {
+    mProps              = {};
+    mProps.jedec        = geometry.manufacturer;
+    mProps.pageSize     = geometry.pageSize;
+    mProps.numPages     = geometry.deviceSize / geometry.pageSize;
+    mProps.blockSize    = geometry.blockSize;
+    mProps.numBlocks    = geometry.deviceSize / geometry.blockSize;
+    mProps.sectorSize   = geometry.sectorSize;
+    mProps.numSectors   = geometry.deviceSize / geometry.sectorSize;
+    mProps.startAddress = 0;
+    mProps.endAddress   = geometry.deviceSize;
+    mProps.eraseChunk   = Chunk::BLOCK;
+
+    /*-------------------------------------------------
+    Parts ship erased, which costs nothing to store
+    -------------------------------------------------*/
+    mUnits.reset( new Unit[ mNumUnits ] );
+    for ( size_t x = 0; x < mNumUnits; x++ )
+    {
+      mUnits[ x ].erases = 0;
+    }
+
+    clearStats();
+  }
+
+
+  EnduranceDevice::EnduranceDevice( const Model model ) :
+      EnduranceDevice( Sim::getGeometry( model ), getEnduranceProfile( model ) )
+  {
+  }
+
+
+  EnduranceDevice::~EnduranceDevice()
+  {
+  }
+
+
+  uint32_t EnduranceDevice::eraseCount( const size_t unit ) const
+  {
+    return ( unit < mNumUnits ) ? mUnits[ unit ].erases.load( std::memory_order_relaxed ) : 0;
+  }
+
+
+  Projection EnduranceDevice::project( const uint64_t hostBytes, const size_t numHottest ) const
+  {
+    Projection projection = {};
+    projection.minErases  = UINT32_MAX;
+
+    std::vector<UnitWear> wear( mNumUnits );
+    uint64_t total = 0;
+
+    for ( size_t x = 0; x < mNumUnits; x++ )
+    {
+      const uint32_t erases = eraseCount( x );
+      wear[ x ]             = { x, erases };
+
+      total += erases;
+      projection.minErases = std::min( projection.minErases, erases );
+      projection.maxErases = std::max( projection.maxErases, erases );
+      projection.unitsPastRating += ( erases > mProfile.ratedCycles );
+    }
+
+    projection.meanErases = mNumUnits ? ( static_cast<double>( total ) / mNumUnits ) : 0.0;
+
+    /*-------------------------------------------------
+    Amplification and lifetime relative to the host
+    -------------------------------------------------*/
+    if ( hostBytes )
+    {
+      const auto counters           = sumCounters();
+      projection.writeAmplification = static_cast<double>( counters.bytesProgrammed ) / hostBytes;
+      projection.eraseAmplification = static_cast<double>( counters.bytesErased ) / hostBytes;
+    }
+
+    if ( projection.maxErases )
+    {
+      const uint64_t lifetime = static_cast<uint64_t>( static_cast<double>( hostBytes ) * mProfile.ratedCycles
+                                                       / projection.maxErases );
+
+      projection.lifetimeHostBytes  = lifetime;
+      projection.remainingHostBytes = ( lifetime > hostBytes ) ? ( lifetime - hostBytes ) : 0;
+    }
+
+    /*-------------------------------------------------
+    Hottest units first, ties broken by address
+    -------------------------------------------------*/
+    const size_t count = std::min( numHottest, wear.size() );
+    std::partial_sort( wear.begin(), wear.begin() + count, wear.end(), []( const UnitWear &a, const UnitWear &b ) {
+      return ( a.erases != b.erases ) ? ( a.erases > b.erases ) : ( a.unit < b.unit );
+    } );
+
+    wear.resize( count );
+    projection.hottest = std::move( wear );
+    return projection;
+  }
+
+
+  size_t EnduranceDevice::numEraseUnits() const
+  {
+    return mNumUnits;
+  }
+
+
+  size_t EnduranceDevice::residentBytes() const
+  {
+    return mResidentUnits.load() * mGeometry.blockSize;
+  }
+
+
+  EnduranceStats EnduranceDevice::getStats() const
+  {
+    const auto counters = sumCounters();
+
+    EnduranceStats stats;
+    stats.reads             = counters.reads;
+    stats.writes            = counters.writes;
+    stats.erases            = counters.erases;
+    stats.bytesRead         = counters.bytesRead;
+    stats.bytesProgrammed   = counters.bytesProgrammed;
+    stats.bytesErased       = counters.bytesErased;
+    stats.bitErrors         = counters.bitErrors;
+    stats.residentUnits     = mResidentUnits;
+    stats.peakResidentUnits = mPeakResidentUnits;
+    return stats;
+  }
+
+
+  void EnduranceDevice::clearStats()
+  {
+    for ( size_t x = 0; x < mNumUnits; x++ )
+    {
+      std::lock_guard<std::mutex> lock( mUnits[ x ].lock );
+      mUnits[ x ].counters = {};
+    }
+
+    mPeakResidentUnits = mResidentUnits.load();
+  }
+
+
+  const Geometry &EnduranceDevice::getGeometry() const
+  {
+    return mGeometry;
+  }
+
+
+  const EnduranceProfile &EnduranceDevice::getProfile() const
+  {
+    return mProfile;
+  }
+
+
+  Status EnduranceDevice::open()
+  {
+    return Status::ERR_OK;
+  }
+
+
+  Status EnduranceDevice::close()
+  {
+    return Status::ERR_OK;
+  }
+
+
+  Status EnduranceDevice::write( const size_t address, const void *const data, const size_t length )
+  {
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    A page at a time, so worn units see errors spread
+    the same way regardless of how writes are sized
+    -------------------------------------------------*/
+    auto src      = reinterpret_cast<const uint8_t *>( data );
+    size_t offset = 0;
+
+    while ( offset < length )
+    {
+      const size_t current    = address + offset;
+      const size_t index      = current / mGeometry.blockSize;
+      const size_t unitOffset = current % mGeometry.blockSize;
+      const size_t chunk      = std::min( length - offset, mGeometry.pageSize - ( current % mGeometry.pageSize ) );
+      auto &unit              = mUnits[ index ];
+
+      std::lock_guard<std::mutex> lock( unit.lock );
+
+      unit.counters.writes += ( offset == 0 );
+      unit.counters.bytesProgrammed += chunk;
+
+      if ( !unit.data )
+      {
+        if ( isBlank( src + offset, chunk ) )
+        {
+          offset += chunk;
+          continue;
+        }
+
+        unit.data.reset( new uint8_t[ mGeometry.blockSize ] );
+        memset( unit.data.get(), 0xFF, mGeometry.blockSize );
+
+        const size_t resident = ++mResidentUnits;
+        size_t peak           = mPeakResidentUnits.load();
+        while ( ( resident > peak ) && !mPeakResidentUnits.compare_exchange_weak( peak, resident ) )
+        {
+        }
+      }
+
+      uint8_t *dst = unit.data.get() + unitOffset;
+      for ( size_t x = 0; x < chunk; x++ )
+      {
+        dst[ x ] &= src[ offset + x ];
+      }
+
+      const uint32_t erases = unit.erases.load( std::memory_order_relaxed );
+      if ( mProfile.ratedCycles && ( erases > mProfile.ratedCycles ) )
+      {
+        unit.counters.bitErrors += injectErrors( index, erases, unit.data.get(), unitOffset, chunk );
+      }
+
+      offset += chunk;
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status EnduranceDevice::read( const size_t address, void *const data, const size_t length )
+  {
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    auto dst      = reinterpret_cast<uint8_t *>( data );
+    size_t offset = 0;
+
+    while ( offset < length )
+    {
+      const size_t current    = address + offset;
+      const size_t unitOffset = current % mGeometry.blockSize;
+      const size_t chunk      = std::min( length - offset, mGeometry.blockSize - unitOffset );
+      auto &unit              = mUnits[ current / mGeometry.blockSize ];
+
+      {
+        std::lock_guard<std::mutex> lock( unit.lock );
+
+        unit.counters.reads += ( offset == 0 );
+        unit.counters.bytesRead += chunk;
+
+        if ( unit.data )
+        {
+          memcpy( dst + offset, unit.data.get() + unitOffset, chunk );
+        }
+        else
+        {
+          memset( dst + offset, 0xFF, chunk );
+        }
+      }
+
+      offset += chunk;
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status EnduranceDevice::erase( const size_t address, const size_t length )
+  {
+    if ( !length || !inRange( address, length ) || ( address % mGeometry.blockSize ) || ( length % mGeometry.blockSize ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    const size_t first = address / mGeometry.blockSize;
+    const size_t count = length / mGeometry.blockSize;
+
+    for ( size_t x = first; x < ( first + count ); x++ )
+    {
+      std::lock_guard<std::mutex> lock( mUnits[ x ].lock );
+      eraseUnit( mUnits[ x ] );
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status EnduranceDevice::erase( const Chunk chunk, const size_t id )
+  {
+    return erase( chunkStartAddress( mProps, chunk, id ), chunkSize( mProps, chunk ) );
+  }
+
+
+  Status EnduranceDevice::eraseChip()
+  {
+    return erase( 0, mGeometry.deviceSize );
+  }
+
+
+  Properties EnduranceDevice::getDeviceProperties()
+  {
+    return mProps;
+  }
+
+
+  Status EnduranceDevice::pendEvent( const Event event, const size_t timeout )
+  {
+    /*-------------------------------------------------
+    Nothing is ever in flight
+    -------------------------------------------------*/
+    return Status::ERR_OK;
+  }
+
+
+  bool EnduranceDevice::inRange( const size_t address, const size_t length ) const
+  {
+    return ( address < mGeometry.deviceSize ) && ( length <= ( mGeometry.deviceSize - address ) );
+  }
+
+
+  EnduranceDevice::Counters EnduranceDevice::sumCounters() const
+  {
+    Counters total = {};
+
+    for ( size_t x = 0; x < mNumUnits; x++ )
+    {
+      std::lock_guard<std::mutex> lock( mUnits[ x ].lock );
+      const auto &counters = mUnits[ x ].counters;
+
+      total.reads += counters.reads;
+      total.writes += counters.writes;
+      total.erases += counters.erases;
+      total.bytesRead += counters.bytesRead;
+      total.bytesProgrammed += counters.bytesProgrammed;
+      total.bytesErased += counters.bytesErased;
+      total.bitErrors += counters.bitErrors;
+    }
+
+    return total;
+  }
+
+
+  void EnduranceDevice::eraseUnit( Unit &unit )
+  {
+    if ( unit.data )
+    {
+      unit.data.reset();
+      mResidentUnits--;
+    }
+
+    unit.erases.fetch_add( 1, std::memory_order_relaxed );
+    unit.counters.erases++;
+    unit.counters.bytesErased += mGeometry.blockSize;
+  }
+
+
+  size_t EnduranceDevice::injectErrors( const size_t unit, const uint32_t erases, uint8_t *const data, const size_t offset,
+                                        const size_t length ) const
+  {
+    /*-------------------------------------------------
+    Expected flips for the bits just programmed. The
+    fraction is resolved with a coin toss so the long
+    run average comes out right.
+    -------------------------------------------------*/
+    const double over     = static_cast<double>( erases - mProfile.ratedCycles ) / mProfile.ratedCycles;
+    const size_t bits     = length * 8;
+    const double expected = mProfile.wornBitErrorRate * over * bits;
+
+    uint64_t state = mProfile.seed ^ ( static_cast<uint64_t>( unit ) << 40 ) ^ ( static_cast<uint64_t>( erases ) << 16 );
+    size_t flips   = static_cast<size_t>( expected );
+
+    state ^= offset;
+
+    if ( ( static_cast<double>( nextRandom( state ) >> 11 ) * 0x1.0p-53 ) < ( expected - flips ) )
+    {
+      flips++;
+    }
+
+    for ( size_t x = 0; x < flips; x++ )
+    {
+      const size_t bit = nextRandom( state ) % bits;
+      data[ offset + ( bit / 8 ) ] ^= static_cast<uint8_t>( 1u << ( bit % 8 ) );
+    }
+
+    return flips;
+  }
+}  // namespace Adesto::Sim
@@ -0,0 +1,201 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_endurance.hpp
+ *
+ *  Description:
+ *    Fast forward model of an Adesto NOR flash part for endurance and
+ *    lifetime studies. There is no timing model and no global lock, and
+ *    erase units only hold RAM while they contain programmed data, so
+ *    workloads of millions of erase cycles run at host memory speed across
+ *    several threads. Once an erase unit passes its rated endurance, every
+ *    program into it picks up random bit errors.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_SIM_ENDURANCE_HPP
+#define ADESTO_SIM_ENDURANCE_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+
+namespace Adesto::Sim
+{
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  How a part wears out. The raw bit error rate is zero up to the rating,
+   *  then grows linearly with the cycles spent past it.
+   */
+  struct EnduranceProfile
+  {
+    uint32_t ratedCycles;    /**< Erase cycles per erase unit the part is rated for */
+    double wornBitErrorRate; /**< Raw bit error rate once a unit reaches twice its rating */
+    uint64_t seed;           /**< Makes error injection repeatable */
+  };
+
+  struct EnduranceStats
+  {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t erases; /**< Erase units erased, chip erase included */
+    uint64_t bytesRead;
+    uint64_t bytesProgrammed;
+    uint64_t bytesErased;
+    uint64_t bitErrors;       /**< Bits flipped by error injection */
+    size_t residentUnits;     /**< Erase units currently holding RAM */
+    size_t peakResidentUnits; /**< Most erase units ever holding RAM at once */
+  };
+
+  struct UnitWear
+  {
+    size_t unit;
+    uint32_t erases;
+  };
+
+  /**
+   *  Where a workload leaves the part. Lifetime assumes the workload keeps
+   *  wearing the device the same way until the hottest unit is used up.
+   */
+  struct Projection
+  {
+    uint32_t minErases;
+    uint32_t maxErases;
+    double meanErases;
+    size_t unitsPastRating;
+    double writeAmplification;     /**< Bytes programmed per host byte */
+    double eraseAmplification;     /**< Bytes erased per host byte */
+    uint64_t lifetimeHostBytes;    /**< Host bytes from new until the hottest unit hits its rating, zero if nothing wore */
+    uint64_t remainingHostBytes;   /**< Lifetime left after the given host bytes, zero once past the rating */
+    std::vector<UnitWear> hottest; /**< Most erased units, hottest first */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Looks up the datasheet endurance of a modeled part
+   *
+   *  @param[in]  model     Which part
+   *  @return const EnduranceProfile&
+   */
+  const EnduranceProfile &getEnduranceProfile( const Model model );
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Every operation completes before returning. Calls touching different
+   *  erase units run in parallel. A call spanning several units locks them
+   *  one at a time, so it is not atomic against other threads writing the
+   *  same range, which the real part doesn't promise either.
+   *
+   *  Operation counts are kept per erase unit under that unit's lock, and
+   *  getStats() and project() sum them, so threads on different units never
+   *  write to a shared counter. A call spanning units counts against the
+   *  first. Only the resident unit counts are shared, and they change once
+   *  per unit per erase cycle rather than on every call.
+   */
+  class EnduranceDevice : public Aurora::Memory::IGenericDevice
+  {
+  public:
+    EnduranceDevice( const Geometry &geometry, const EnduranceProfile &profile );
+    EnduranceDevice( const Model model );
+    ~EnduranceDevice();
+
+    /**
+     *  Number of times an erase unit has been erased
+     *
+     *  @param[in]  unit      Erase unit index (geometry blockSize granularity)
+     *  @return uint32_t
+     */
+    uint32_t eraseCount( const size_t unit ) const;
+
+    /**
+     *  Sums up wear across the part for a workload
+     *
+     *  @param[in]  hostBytes   Bytes the workload asked the storage layer to write
+     *  @param[in]  numHottest  Units to list in Projection::hottest
+     *  @return Projection
+     */
+    Projection project( const uint64_t hostBytes, const size_t numHottest ) const;
+
+    size_t numEraseUnits() const;
+    size_t residentBytes() const; /**< RAM spent on stored data */
+    EnduranceStats getStats() const;
+    void clearStats();
+    const Geometry &getGeometry() const;
+    const EnduranceProfile &getProfile() const;
+
+    /*-------------------------------------------------
+    Generic Device Interface
+    -------------------------------------------------*/
+    Aurora::Memory::Status open() override;
+    Aurora::Memory::Status close() override;
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length ) override;
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length ) override;
+    Aurora::Memory::Status erase( const size_t address, const size_t length ) override;
+    Aurora::Memory::Status erase( const Aurora::Memory::Chunk chunk, const size_t id ) override;
+    Aurora::Memory::Status eraseChip() override;
+    Aurora::Memory::Properties getDeviceProperties() override;
+    Aurora::Memory::Status pendEvent( const Aurora::Memory::Event event, const size_t timeout ) override;
+
+  private:
+    /**
+     *  Statistics for calls landing in one unit, guarded by its lock
+     */
+    struct Counters
+    {
+      uint64_t reads;
+      uint64_t writes;
+      uint64_t erases;
+      uint64_t bytesRead;
+      uint64_t bytesProgrammed;
+      uint64_t bytesErased;
+      uint64_t bitErrors;
+    };
+
+    /**
+     *  Null data means the unit is erased
+     */
+    struct Unit
+    {
+      std::mutex lock;
+      std::unique_ptr<uint8_t[]> data;
+      std::atomic<uint32_t> erases;
+      Counters counters;
+    };
+
+    Geometry mGeometry;
+    EnduranceProfile mProfile;
+    Aurora::Memory::Properties mProps;
+    std::unique_ptr<Unit[]> mUnits;
+    size_t mNumUnits;
+
+    std::atomic<size_t> mResidentUnits;
+    std::atomic<size_t> mPeakResidentUnits;
+
+    bool inRange( const size_t address, const size_t length ) const;
+    Counters sumCounters() const;
+    void eraseUnit( Unit &unit );
+    size_t injectErrors( const size_t unit, const uint32_t erases, uint8_t *const data, const size_t offset,
+                         const size_t length ) const;
+  };
+
+  using EnduranceDevice_sPtr = std::shared_ptr<EnduranceDevice>;
+}  // namespace Adesto::Sim
+
+#endif /* !ADESTO_SIM_ENDURANCE_HPP */
@@ -0,0 +1,218 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_sfdp.cpp
+ *
+ *  Description:
+ *    Generates the SFDP tables served by the simulated parts. Timing fields
+ *    are rounded up to the nearest value the JESD216 encoding can express.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/sim/sim_device.hpp>
+
+namespace Adesto::Sim
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr uint8_t SFDP_MINOR_REV   = 6; /**< JESD216B */
+  static constexpr uint8_t SFDP_MAJOR_REV   = 1;
+  static constexpr size_t BFPT_DWORDS       = 16;
+  static constexpr uint32_t BFPT_ADDRESS    = 0x30;
+  static constexpr uint32_t ERASE_MAX_MULT  = 1; /**< Max is 2 * (n + 1) * typical, so 4x */
+  static constexpr uint32_t PROG_MAX_MULT   = 2; /**< 6x */
+  static constexpr uint32_t BYTE_PROGRAM_US = 8;
+
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  struct ReadOpcode
+  {
+    SFDP::ReadMode mode;
+    uint8_t opcode;
+    uint8_t modeCycles;
+    uint8_t dummyCycles;
+  };
+
+  /* clang-format off */
+  static const ReadOpcode sReadOpcodes[] = {
+    /* Mode                          Opcode  Mode  Dummy */
+    { SFDP::ReadMode::READ_1_1_2,    0x3B,   0,    8 },
+    { SFDP::ReadMode::READ_1_2_2,    0xBB,   4,    0 },
+    { SFDP::ReadMode::READ_1_1_4,    0x6B,   0,    8 },
+    { SFDP::ReadMode::READ_1_4_4,    0xEB,   2,    4 },
+    { SFDP::ReadMode::READ_4_4_4,    0xEB,   2,    4 },
+  };
+  /* clang-format on */
+
+  static constexpr uint32_t sEraseUnitsUs[]     = { 1000, 16000, 128000, 1000000 };
+  static constexpr uint32_t sChipEraseUnitsUs[] = { 16000, 256000, 4000000, 64000000 };
+  static constexpr uint32_t sPageUnitsUs[]      = { 8, 64 };
+  static constexpr uint32_t sByteUnitsUs[]      = { 1, 8 };
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Encodes a time as a (unit, count - 1) field, using the finest unit that
+   *  can represent it. Returns unit in the bits above the count.
+   */
+  template<size_t N>
+  static uint32_t encodeTime( const uint32_t us, const uint32_t ( &units )[ N ], const size_t countBits )
+  {
+    const uint32_t maxCount = 1u << countBits;
+
+    for ( size_t unit = 0; unit < N; unit++ )
+    {
+      const uint32_t count = ( us + units[ unit ] - 1 ) / units[ unit ];
+      if ( count <= maxCount )
+      {
+        return ( static_cast<uint32_t>( unit ) << countBits ) | ( count ? count - 1 : 0 );
+      }
+    }
+
+    return ( static_cast<uint32_t>( N - 1 ) << countBits ) | ( maxCount - 1 );
+  }
+
+
+  static bool hasMode( const Geometry &geometry, const SFDP::ReadMode mode )
+  {
+    return geometry.readModes & ( 1u << static_cast<uint8_t>( mode ) );
+  }
+
+
+  static uint32_t readField( const Geometry &geometry, const SFDP::ReadMode mode )
+  {
+    /*-------------------------------------------------
+    Unsupported modes leave the field at its reserved
+    state of all ones.
+    -------------------------------------------------*/
+    if ( !hasMode( geometry, mode ) )
+    {
+      return 0xFFFF;
+    }
+
+    for ( auto &op : sReadOpcodes )
+    {
+      if ( op.mode == mode )
+      {
+        return ( static_cast<uint32_t>( op.opcode ) << 8 ) | ( static_cast<uint32_t>( op.modeCycles ) << 5 ) | op.dummyCycles;
+      }
+    }
+
+    return 0xFFFF;
+  }
+
+
+  static size_t log2( size_t value )
+  {
+    size_t result = 0;
+    while ( value > 1 )
+    {
+      value >>= 1;
+      result++;
+    }
+
+    return result;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  std::vector<uint8_t> buildSFDP( const Geometry &geometry, const TimingProfile &timing )
+  {
+    using namespace SFDP;
+    std::array<uint32_t, BFPT_DWORDS> dw;
+    dw.fill( 0xFFFFFFFF );
+
+    /*-------------------------------------------------
+    DWORD 1: 4K erase opcode, 3 byte addressing and
+    which multi-IO reads are available.
+    -------------------------------------------------*/
+    dw[ 0 ] = 0xFF800000u | ( 0x20u << 8 ) | ( 1u << 2 ) | 0x1u;
+    dw[ 0 ] |= hasMode( geometry, ReadMode::READ_1_1_2 ) ? ( 1u << 16 ) : 0;
+    dw[ 0 ] |= hasMode( geometry, ReadMode::READ_1_2_2 ) ? ( 1u << 20 ) : 0;
+    dw[ 0 ] |= hasMode( geometry, ReadMode::READ_1_4_4 ) ? ( 1u << 21 ) : 0;
+    dw[ 0 ] |= hasMode( geometry, ReadMode::READ_1_1_4 ) ? ( 1u << 22 ) : 0;
+
+    /*-------------------------------------------------
+    DWORDs 2-7: Density and read opcodes
+    -------------------------------------------------*/
+    dw[ 1 ] = static_cast<uint32_t>( ( geometry.deviceSize * 8u ) - 1u );
+    dw[ 2 ] = ( readField( geometry, ReadMode::READ_1_1_4 ) << 16 ) | readField( geometry, ReadMode::READ_1_4_4 );
+    dw[ 3 ] = ( readField( geometry, ReadMode::READ_1_2_2 ) << 16 ) | readField( geometry, ReadMode::READ_1_1_2 );
+    dw[ 4 ] = 0xFFFFFFEEu | ( hasMode( geometry, ReadMode::READ_2_2_2 ) ? 0x01u : 0 )
+              | ( hasMode( geometry, ReadMode::READ_4_4_4 ) ? 0x10u : 0 );
+    dw[ 5 ] = ( readField( geometry, ReadMode::READ_2_2_2 ) << 16 ) | 0xFFFFu;
+    dw[ 6 ] = ( readField( geometry, ReadMode::READ_4_4_4 ) << 16 ) | 0xFFFFu;
+
+    /*-------------------------------------------------
+    DWORDs 8-10: Erase types, matching the commands the
+    simulated erase() picks from, and their timing.
+    -------------------------------------------------*/
+    dw[ 7 ] = ( 0x52u << 24 ) | ( 15u << 16 ) | ( 0x20u << 8 ) | 12u;
+    dw[ 8 ] = ( 0x00u << 24 ) | ( 0u << 16 ) | ( 0xD8u << 8 ) | 16u;
+    dw[ 9 ] = ( encodeTime( timing.erase64K, sEraseUnitsUs, 5 ) << 18 ) | ( encodeTime( timing.erase32K, sEraseUnitsUs, 5 ) << 11 )
+              | ( encodeTime( timing.erase4K, sEraseUnitsUs, 5 ) << 4 ) | ERASE_MAX_MULT;
+
+    /*-------------------------------------------------
+    DWORD 11: Page size, program and chip erase times
+    -------------------------------------------------*/
+    dw[ 10 ] = ( encodeTime( timing.eraseChip, sChipEraseUnitsUs, 5 ) << 24 )
+               | ( encodeTime( BYTE_PROGRAM_US, sByteUnitsUs, 4 ) << 14 )
+               | ( encodeTime( timing.pageProgram, sPageUnitsUs, 5 ) << 8 )
+               | ( static_cast<uint32_t>( log2( geometry.pageSize ) ) << 4 ) | PROG_MAX_MULT;
+
+    /*-------------------------------------------------
+    Assemble: header, one parameter header, the table
+    -------------------------------------------------*/
+    std::vector<uint8_t> image( BFPT_ADDRESS + ( BFPT_DWORDS * sizeof( uint32_t ) ), 0xFF );
+
+    image[ 0 ] = static_cast<uint8_t>( SIGNATURE );
+    image[ 1 ] = static_cast<uint8_t>( SIGNATURE >> 8 );
+    image[ 2 ] = static_cast<uint8_t>( SIGNATURE >> 16 );
+    image[ 3 ] = static_cast<uint8_t>( SIGNATURE >> 24 );
+    image[ 4 ] = SFDP_MINOR_REV;
+    image[ 5 ] = SFDP_MAJOR_REV;
+    image[ 6 ] = 0; /* One parameter header */
+    image[ 7 ] = 0xFF;
+
+    image[ 8 ]  = static_cast<uint8_t>( BFPT_ID );
+    image[ 9 ]  = SFDP_MINOR_REV;
+    image[ 10 ] = SFDP_MAJOR_REV;
+    image[ 11 ] = BFPT_DWORDS;
+    image[ 12 ] = static_cast<uint8_t>( BFPT_ADDRESS );
+    image[ 13 ] = static_cast<uint8_t>( BFPT_ADDRESS >> 8 );
+    image[ 14 ] = static_cast<uint8_t>( BFPT_ADDRESS >> 16 );
+    image[ 15 ] = static_cast<uint8_t>( BFPT_ID >> 8 );
+
+    for ( size_t x = 0; x < dw.size(); x++ )
+    {
+      for ( size_t byte = 0; byte < sizeof( uint32_t ); byte++ )
+      {
+        image[ BFPT_ADDRESS + ( x * sizeof( uint32_t ) ) + byte ] = static_cast<uint8_t>( dw[ x ] >> ( byte * 8 ) );
+      }
+    }
+
+    return image;
+  }
+
+
+  Status readSFDP( void *context, const uint32_t address, void *const data, const size_t length )
+  {
+    if ( !context )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    return static_cast<Device *>( context )->readSFDP( address, data, length );
+  }
+}  // namespace Adesto::Sim
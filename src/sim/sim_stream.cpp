@@ -0,0 +1,58 @@
+/********************************************************************************
+ *  File Name:
+ *    sim_stream.cpp
+ *
+ *  Description:
+ *    Continuous read transport for the simulated parts
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/stream/stream.hpp>
+
+namespace Adesto::Sim
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static Status simBegin( void *context, const size_t address )
+  {
+    return context ? static_cast<Device *>( context )->beginStream( address ) : Status::ERR_BAD_ARG;
+  }
+
+
+  static Status simStart( void *context, void *const data, const size_t length )
+  {
+    return static_cast<Device *>( context )->streamRead( data, length );
+  }
+
+
+  static Status simFinish( void *context )
+  {
+    return Status::ERR_OK;
+  }
+
+
+  static void simEnd( void *context )
+  {
+    if ( context )
+    {
+      static_cast<Device *>( context )->endStream();
+    }
+  }
+
+
+  static const Stream::Transport sStreamTransport = { simBegin, simStart, simFinish, simEnd };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  const Stream::Transport &streamTransport()
+  {
+    return sStreamTransport;
+  }
+}  // namespace Adesto::Sim
@@ -0,0 +1,228 @@
+/********************************************************************************
+ *  File Name:
+ *    stream.cpp
+ *
+ *  Description:
+ *    Continuous array read engine and the sinks built on it
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+
+/* Adesto Includes */
+#include <src/stream/stream.hpp>
+
+namespace Adesto::Stream
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  /*-------------------------------------------------
+  Nibble table for the reflected 0xEDB88320 polynomial.
+  Small enough to keep in flash on any part.
+  -------------------------------------------------*/
+  /* clang-format off */
+  static constexpr uint32_t sCRCTable[ 16 ] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  /* clang-format on */
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static bool crcSink( void *context, const size_t address, const uint8_t *const data, const size_t length )
+  {
+    auto crc = static_cast<uint32_t *>( context );
+    *crc     = crc32Update( *crc, data, length );
+    return true;
+  }
+
+
+  struct VerifyState
+  {
+    uint8_t value;
+    size_t mismatch;
+  };
+
+  static bool verifySink( void *context, const size_t address, const uint8_t *const data, const size_t length )
+  {
+    auto state = static_cast<VerifyState *>( context );
+
+    for ( size_t x = 0; x < length; x++ )
+    {
+      if ( data[ x ] != state->value )
+      {
+        state->mismatch = address + x;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  static Status deviceBegin( void *context, const size_t address )
+  {
+    static_cast<DeviceContext *>( context )->address = address;
+    return Status::ERR_OK;
+  }
+
+
+  static Status deviceStart( void *context, void *const data, const size_t length )
+  {
+    auto ctx          = static_cast<DeviceContext *>( context );
+    const auto result = ctx->device->read( ctx->address, data, length );
+
+    ctx->address += length;
+    return result;
+  }
+
+
+  static Status deviceFinish( void *context )
+  {
+    return Status::ERR_OK;
+  }
+
+
+  static void deviceEnd( void *context )
+  {
+  }
+
+
+  static const Transport sDeviceTransport = { deviceBegin, deviceStart, deviceFinish, deviceEnd };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  Status read( const Transport &transport, void *context, const size_t address, const size_t length,
+               const Buffers &buffers, SinkFunc sink, void *sinkContext )
+  {
+    if ( !buffers.data || !buffers.size || !buffers.count || !sink )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( !length )
+    {
+      return Status::ERR_OK;
+    }
+
+    auto result = transport.begin( context, address );
+    if ( result != Status::ERR_OK )
+    {
+      transport.end( context );
+      return result;
+    }
+
+    /*-------------------------------------------------
+    Keep the next transfer running while the sink looks
+    at the last one. With a single buffer the sink has
+    to finish before it can be refilled.
+    -------------------------------------------------*/
+    const bool overlap = buffers.count > 1;
+    size_t slot        = 0;
+    size_t offset      = 0;
+    size_t chunk       = std::min( buffers.size, length );
+    bool pending       = false;
+
+    result  = transport.start( context, buffers.data, chunk );
+    pending = ( result == Status::ERR_OK );
+
+    while ( pending )
+    {
+      result  = transport.finish( context );
+      pending = false;
+      if ( result != Status::ERR_OK )
+      {
+        break;
+      }
+
+      uint8_t *const filled   = buffers.data + ( slot * buffers.size );
+      const size_t filledSize = chunk;
+      const size_t filledAddr = address + offset;
+
+      offset += chunk;
+      slot  = ( slot + 1 ) % buffers.count;
+      chunk = std::min( buffers.size, length - offset );
+
+      if ( overlap && chunk )
+      {
+        result  = transport.start( context, buffers.data + ( slot * buffers.size ), chunk );
+        pending = ( result == Status::ERR_OK );
+        if ( !pending )
+        {
+          break;
+        }
+      }
+
+      if ( !sink( sinkContext, filledAddr, filled, filledSize ) )
+      {
+        result = Status::ERR_FAIL;
+        break;
+      }
+
+      if ( !overlap && chunk )
+      {
+        result  = transport.start( context, buffers.data, chunk );
+        pending = ( result == Status::ERR_OK );
+      }
+    }
+
+    /*-------------------------------------------------
+    An early exit can leave a transfer on the bus. Let
+    it land before deselecting the part.
+    -------------------------------------------------*/
+    if ( pending )
+    {
+      transport.finish( context );
+    }
+
+    transport.end( context );
+    return result;
+  }
+
+
+  Status crc32( const Transport &transport, void *context, const size_t address, const size_t length,
+                const Buffers &buffers, uint32_t &crc )
+  {
+    crc = 0;
+    return read( transport, context, address, length, buffers, crcSink, &crc );
+  }
+
+
+  Status verify( const Transport &transport, void *context, const size_t address, const size_t length,
+                 const Buffers &buffers, const uint8_t value, size_t &mismatch )
+  {
+    VerifyState state = { value, NO_MISMATCH };
+
+    const auto result = read( transport, context, address, length, buffers, verifySink, &state );
+    mismatch          = state.mismatch;
+    return result;
+  }
+
+
+  uint32_t crc32Update( const uint32_t crc, const uint8_t *const data, const size_t length )
+  {
+    uint32_t value = ~crc;
+
+    for ( size_t x = 0; x < length; x++ )
+    {
+      value ^= data[ x ];
+      value = ( value >> 4 ) ^ sCRCTable[ value & 0x0F ];
+      value = ( value >> 4 ) ^ sCRCTable[ value & 0x0F ];
+    }
+
+    return ~value;
+  }
+
+
+  const Transport &deviceTransport()
+  {
+    return sDeviceTransport;
+  }
+}  // namespace Adesto::Stream
@@ -0,0 +1,169 @@
+/********************************************************************************
+ *  File Name:
+ *    stream.hpp
+ *
+ *  Description:
+ *    Continuous array reads. A range of any length is clocked out of the part
+ *    in a single command, with the chip select held the whole time, and
+ *    handed to the caller one buffer at a time. Dumping, verifying or CRCing
+ *    the full device then runs at bus speed instead of paying the command,
+ *    address and chip select overhead once per page.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_STREAM_HPP
+#define ADESTO_STREAM_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::Stream
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t NO_MISMATCH = std::numeric_limits<size_t>::max();
+
+  /*-------------------------------------------------------------------------------
+  Aliases
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Receives each filled buffer, in address order
+   *
+   *  @param[in]  context   User data given to read()
+   *  @param[in]  address   Device address of data[ 0 ]
+   *  @param[in]  data      The bytes read
+   *  @param[in]  length    Number of bytes in data
+   *  @return bool          False to end the stream early
+   */
+  using SinkFunc = bool ( * )( void *context, const size_t address, const uint8_t *const data, const size_t length );
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  How a continuous read reaches the part. One stream is begin(), any number
+   *  of start()/finish() pairs that each clock out the next bytes in the
+   *  array, then end(). At most one transfer is started at a time.
+   */
+  struct Transport
+  {
+    /**
+     *  Selects the part and sends the read command and address
+     */
+    Aurora::Memory::Status ( *begin )( void *context, const size_t address );
+
+    /**
+     *  Starts clocking the next length bytes into data. May return before the
+     *  transfer is done.
+     */
+    Aurora::Memory::Status ( *start )( void *context, void *const data, const size_t length );
+
+    /**
+     *  Waits for the transfer from the last start() to land
+     */
+    Aurora::Memory::Status ( *finish )( void *context );
+
+    /**
+     *  Deselects the part, ending the command
+     */
+    void ( *end )( void *context );
+  };
+
+  /**
+   *  Caller supplied ring of buffers, laid out back to back in one block of
+   *  memory. With two or more, the sink works on one buffer while the next is
+   *  being filled.
+   */
+  struct Buffers
+  {
+    uint8_t *data; /**< count * size bytes */
+    size_t size;   /**< Bytes per buffer */
+    size_t count;  /**< Number of buffers */
+  };
+
+  /**
+   *  Context for deviceTransport()
+   */
+  struct DeviceContext
+  {
+    Aurora::Memory::IGenericDevice *device;
+    size_t address; /**< Next address to read, maintained by the transport */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Streams a range of the device through the caller's buffers
+   *
+   *  @param[in]  transport   Path to the part
+   *  @param[in]  context     Passed through to the transport
+   *  @param[in]  address     Start address
+   *  @param[in]  length      Number of bytes to stream
+   *  @param[in]  buffers     Where the data lands before it reaches the sink
+   *  @param[in]  sink        Receives every filled buffer
+   *  @param[in]  sinkContext Passed through to the sink
+   *  @return Aurora::Memory::Status  ERR_FAIL if the sink ended the stream early
+   */
+  Aurora::Memory::Status read( const Transport &transport, void *context, const size_t address, const size_t length,
+                               const Buffers &buffers, SinkFunc sink, void *sinkContext );
+
+  /**
+   *  Computes the CRC-32 (IEEE 802.3) of a range of the device
+   *
+   *  @param[in]  transport   Path to the part
+   *  @param[in]  context     Passed through to the transport
+   *  @param[in]  address     Start address
+   *  @param[in]  length      Number of bytes to include
+   *  @param[in]  buffers     Scratch buffers for the stream
+   *  @param[out] crc         The result
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status crc32( const Transport &transport, void *context, const size_t address, const size_t length,
+                                const Buffers &buffers, uint32_t &crc );
+
+  /**
+   *  Checks that every byte of a range holds the same value, ie the erased
+   *  state after a chip erase. Stops at the first byte that doesn't.
+   *
+   *  @param[in]  transport   Path to the part
+   *  @param[in]  context     Passed through to the transport
+   *  @param[in]  address     Start address
+   *  @param[in]  length      Number of bytes to check
+   *  @param[in]  buffers     Scratch buffers for the stream
+   *  @param[in]  value       Expected value of every byte
+   *  @param[out] mismatch    Address of the first bad byte, or NO_MISMATCH
+   *  @return Aurora::Memory::Status  ERR_FAIL on a mismatch
+   */
+  Aurora::Memory::Status verify( const Transport &transport, void *context, const size_t address, const size_t length,
+                                 const Buffers &buffers, const uint8_t value, size_t &mismatch );
+
+  /**
+   *  Continues a CRC-32 over more data. Start from zero.
+   *
+   *  @param[in]  crc         CRC of everything before data
+   *  @param[in]  data        Next bytes
+   *  @param[in]  length      Number of bytes
+   *  @return uint32_t
+   */
+  uint32_t crc32Update( const uint32_t crc, const uint8_t *const data, const size_t length );
+
+  /**
+   *  Transport for drivers without a continuous read path. Each buffer is one
+   *  IGenericDevice::read(), so the per-command cost is paid once per buffer
+   *  rather than once per page. Context is a DeviceContext.
+   *
+   *  @return const Transport&
+   */
+  const Transport &deviceTransport();
+}  // namespace Adesto::Stream
+
+#endif /* !ADESTO_STREAM_HPP */
@@ -0,0 +1,164 @@
+/********************************************************************************
+ *  File Name:
+ *    stream_spi.cpp
+ *
+ *  Description:
+ *    Continuous read transport over a Chimera SPI driver
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/spi>
+
+/* Adesto Includes */
+#include <src/stream/stream_spi.hpp>
+
+namespace Adesto::Stream
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static Chimera::SPI::Driver_sPtr getSPI( void *context )
+  {
+    return Chimera::SPI::getDriver( static_cast<SPIContext *>( context )->channel );
+  }
+
+
+  static bool waitReady( const Chimera::SPI::Driver_sPtr &spi )
+  {
+    const std::array<uint8_t, 2> cmd = { CMD_READ_STATUS, 0x00 };
+    std::array<uint8_t, 2> status;
+    const size_t start = Chimera::millis();
+
+    while ( ( Chimera::millis() - start ) < READY_TIMEOUT_MS )
+    {
+      status.fill( 0x00 );
+
+      spi->setChipSelect( Chimera::GPIO::State::LOW );
+      auto result = spi->readWriteBytes( cmd.data(), status.data(), cmd.size() );
+      spi->await( Chimera::Event::TRIGGER_TRANSFER_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+      spi->setChipSelect( Chimera::GPIO::State::HIGH );
+
+      if ( ( result == Chimera::Status::OK ) && !( status[ 1 ] & STATUS_BUSY ) )
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  static Status spiBegin( void *context, const size_t address )
+  {
+    auto spi = context ? getSPI( context ) : nullptr;
+    if ( !spi )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Opcode, address MSB first and the dummy clocks. The
+    part then streams data for as long as CS stays low.
+    -------------------------------------------------*/
+    auto cfg = static_cast<const SPIContext *>( context );
+    std::array<uint8_t, 1 + 4 + MAX_DUMMY_BYTES> cmd;
+    size_t length = 0;
+
+    cmd.fill( 0x00 );
+    cmd[ length++ ] = cfg->opcode;
+    for ( size_t x = cfg->addressBytes; x > 0; x-- )
+    {
+      cmd[ length++ ] = static_cast<uint8_t>( address >> ( 8 * ( x - 1 ) ) );
+    }
+    length += cfg->dummyBytes;
+
+    /*-------------------------------------------------
+    The bus stays locked until end(), which also runs
+    when this fails. A read issued while a program or
+    erase is still going would return garbage.
+    -------------------------------------------------*/
+    spi->lock();
+    if ( !waitReady( spi ) )
+    {
+      return Status::ERR_TIMEOUT;
+    }
+
+    spi->setChipSelect( Chimera::GPIO::State::LOW );
+
+    auto result = spi->writeBytes( cmd.data(), length );
+    spi->await( Chimera::Event::TRIGGER_TRANSFER_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+
+    return ( result == Chimera::Status::OK ) ? Status::ERR_OK : Status::ERR_FAIL;
+  }
+
+
+  static Status spiStart( void *context, void *const data, const size_t length )
+  {
+    auto result = getSPI( context )->readBytes( data, length );
+    return ( result == Chimera::Status::OK ) ? Status::ERR_OK : Status::ERR_FAIL;
+  }
+
+
+  static Status spiFinish( void *context )
+  {
+    auto result = getSPI( context )->await( Chimera::Event::TRIGGER_TRANSFER_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    return ( result == Chimera::Status::OK ) ? Status::ERR_OK : Status::ERR_FAIL;
+  }
+
+
+  static void spiEnd( void *context )
+  {
+    auto spi = context ? getSPI( context ) : nullptr;
+    if ( !spi )
+    {
+      return;
+    }
+
+    spi->setChipSelect( Chimera::GPIO::State::HIGH );
+    spi->unlock();
+  }
+
+
+  static const Transport sSPITransport = { spiBegin, spiStart, spiFinish, spiEnd };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  const Transport &spiTransport()
+  {
+    return sSPITransport;
+  }
+
+
+  SPIContext spiContext( const Chimera::SPI::Channel channel )
+  {
+    return { channel, CMD_FAST_READ, 3, 1 };
+  }
+
+
+  Status spiContext( const Chimera::SPI::Channel channel, const SFDP::Info &info, SPIContext &context )
+  {
+    context = spiContext( channel );
+
+    /*-------------------------------------------------
+    JESD216 has no entry for the 1-1-1 fast read and
+    the transport can't clock the modes it does list,
+    so only the address width comes from the tables.
+    -------------------------------------------------*/
+    if ( ( info.addressBytes != 3 ) && ( info.addressBytes != 4 ) )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    context.addressBytes = info.addressBytes;
+    return Status::ERR_OK;
+  }
+}  // namespace Adesto::Stream
@@ -0,0 +1,86 @@
+/********************************************************************************
+ *  File Name:
+ *    stream_spi.hpp
+ *
+ *  Description:
+ *    Continuous read transport over a Chimera SPI driver
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_STREAM_SPI_HPP
+#define ADESTO_STREAM_SPI_HPP
+
+/* STL Includes */
+#include <cstdint>
+
+/* Chimera Includes */
+#include <Chimera/spi>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/stream/stream.hpp>
+
+namespace Adesto::Stream
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr uint8_t CMD_FAST_READ   = 0x0B;  /**< Read Array, one dummy byte, full clock rate */
+  static constexpr uint8_t CMD_READ_STATUS = 0x05;  /**< Read Status Register byte 1 */
+  static constexpr uint8_t STATUS_BUSY     = 0x01;  /**< RDY/BSY bit, set while a program or erase runs */
+  static constexpr size_t MAX_DUMMY_BYTES  = 8;     /**< Longest dummy phase the transport will clock */
+  static constexpr size_t READY_TIMEOUT_MS = 60000; /**< Longest begin() waits for the part, covers a chip erase */
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Context for spiTransport(). Describes the read command the part expects.
+   */
+  struct SPIContext
+  {
+    Chimera::SPI::Channel channel;
+    uint8_t opcode;       /**< Read command opcode */
+    uint8_t addressBytes; /**< 3 or 4 */
+    uint8_t dummyBytes;   /**< Mode and dummy clocks between the address and the data, in bytes */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Transport issuing a single read command for the whole stream. The SPI
+   *  driver stays locked from begin() to end(), and begin() polls the status
+   *  register until any program or erase in progress has finished before it
+   *  asserts chip select. Context is a pointer to an SPIContext.
+   *
+   *  @return const Transport&
+   */
+  const Transport &spiTransport();
+
+  /**
+   *  Context for a Read Array (0x0B) with 3 address bytes, which every
+   *  supported part accepts
+   *
+   *  @param[in]  channel   SPI channel the part is on
+   *  @return SPIContext
+   */
+  SPIContext spiContext( const Chimera::SPI::Channel channel );
+
+  /**
+   *  Read Array context using the address width from a part's SFDP tables.
+   *  The opcode and dummy clocks stay at the 0x0B defaults: the tables only
+   *  describe multi-lane fast reads, which this single lane transport can't
+   *  carry, and say nothing about the 1-1-1 one.
+   *
+   *  @param[in]  channel   SPI channel the part is on
+   *  @param[in]  info      Decoded SFDP parameters, ie SFDP::Device::getInfo()
+   *  @param[out] context   Filled in on success, left at the Read Array default otherwise
+   *  @return Aurora::Memory::Status  ERR_FAIL if the tables give no usable address width
+   */
+  Aurora::Memory::Status spiContext( const Chimera::SPI::Channel channel, const SFDP::Info &info, SPIContext &context );
+}  // namespace Adesto::Stream
+
+#endif /* !ADESTO_STREAM_SPI_HPP */
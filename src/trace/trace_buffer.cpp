@@ -0,0 +1,221 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_buffer.cpp
+ *
+ *  Description:
+ *    Implementation of the non-blocking trace recorder
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+#include <cstring>
+
+/* Adesto Includes */
+#include <src/common/spsc_ring.hpp>
+#include <src/trace/trace_buffer.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/thread>
+#else
+/* STL Includes */
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#endif
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  static SPSCRing<Record, BUFFER_DEPTH> sRing;
+  static std::atomic<bool> sEnabled     = true;
+  static std::atomic<size_t> sDropped   = 0;
+  static std::atomic<uint8_t> sSequence = 0;
+  static Sink sDrainSink                = nullptr;
+  static std::array<uint8_t, FRAME_MAX_SIZE> sFrame;
+
+#if defined( EMBEDDED )
+  static Chimera::Threading::Thread sDrainThread;
+#else
+  static std::thread sDrainThread;
+#endif
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static void drainThread( void *arg )
+  {
+    while ( true )
+    {
+      drain( sDrainSink );
+#if defined( EMBEDDED )
+      Chimera::delayMilliseconds( DRAIN_PERIOD_MS );
+#else
+      std::this_thread::sleep_for( std::chrono::milliseconds( DRAIN_PERIOD_MS ) );
+#endif
+    }
+  }
+
+
+  static void sendFrame( Sink sink, const size_t count )
+  {
+    const size_t payloadSize = count * sizeof( Record );
+
+    auto header      = reinterpret_cast<FrameHeader *>( sFrame.data() );
+    header->sync0    = FRAME_SYNC_0;
+    header->sync1    = FRAME_SYNC_1;
+    header->count    = static_cast<uint8_t>( count );
+    header->checksum = frameChecksum( sFrame.data() + sizeof( FrameHeader ), payloadSize );
+
+    sink( sFrame.data(), sizeof( FrameHeader ) + payloadSize );
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  void enable( const bool state )
+  {
+    sEnabled = state;
+  }
+
+
+  uint32_t timestamp()
+  {
+#if defined( EMBEDDED )
+    return static_cast<uint32_t>( Chimera::micros() );
+#else
+    using namespace std::chrono;
+    return static_cast<uint32_t>( duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count() );
+#endif
+  }
+
+
+  void record( const Operation op, const Phase phase, const size_t address, const size_t length, const uint8_t status,
+               const uint8_t sequence )
+  {
+    if ( !sEnabled.load( std::memory_order_relaxed ) )
+    {
+      return;
+    }
+
+    Record entry;
+    entry.timestamp = timestamp();
+    entry.address   = static_cast<uint32_t>( address );
+    entry.length    = static_cast<uint32_t>( length );
+    entry.operation = static_cast<uint8_t>( op );
+    entry.phase     = static_cast<uint8_t>( phase );
+    entry.status    = status;
+    entry.sequence  = sequence;
+
+    if ( !sRing.push( entry ) )
+    {
+      sDropped.fetch_add( 1, std::memory_order_relaxed );
+    }
+  }
+
+
+  uint8_t begin( const Operation op, const size_t address, const size_t length )
+  {
+    const uint8_t sequence = sSequence.fetch_add( 1, std::memory_order_relaxed );
+    record( op, Phase::BEGIN, address, length, 0, sequence );
+    return sequence;
+  }
+
+
+  void end( const uint8_t sequence, const Operation op, const size_t address, const size_t length, const uint8_t status )
+  {
+    record( op, Phase::END, address, length, status, sequence );
+  }
+
+
+  void mark( const uint32_t id )
+  {
+    record( Operation::MARK, Phase::INSTANT, id, 0, 0, 0 );
+  }
+
+
+  size_t drain( Sink sink )
+  {
+    if ( !sink )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------
+    Pack as many records as will fit into each frame,
+    flushing whenever it fills up.
+    -------------------------------------------------*/
+    size_t total = 0;
+    size_t count = 0;
+    Record entry;
+
+    while ( sRing.pop( entry ) )
+    {
+      memcpy( sFrame.data() + sizeof( FrameHeader ) + ( count * sizeof( Record ) ), &entry, sizeof( Record ) );
+      count++;
+      total++;
+
+      if ( count == FRAME_MAX_RECORDS )
+      {
+        sendFrame( sink, count );
+        count = 0;
+      }
+    }
+
+    if ( count )
+    {
+      sendFrame( sink, count );
+    }
+
+    return total;
+  }
+
+
+  size_t pending()
+  {
+    return sRing.size();
+  }
+
+
+  size_t dropped()
+  {
+    return sDropped.load( std::memory_order_relaxed );
+  }
+
+
+  void startDrainThread( Sink sink )
+  {
+    if ( sDrainSink || !sink )
+    {
+      return;
+    }
+
+    sDrainSink = sink;
+
+#if defined( EMBEDDED )
+    using namespace Chimera::Threading;
+    sDrainThread.initialize( drainThread, nullptr, Priority::LEVEL_1, STACK_KILOBYTES( DRAIN_STACK_KBYTES ), "trace" );
+    sDrainThread.start();
+#else
+    /*-------------------------------------------------
+    Runs for the life of the process, same as target
+    -------------------------------------------------*/
+    sDrainThread = std::thread( drainThread, nullptr );
+    sDrainThread.detach();
+#endif
+  }
+
+#if !defined( EMBEDDED )
+  void stdoutSink( const void *const data, const size_t length )
+  {
+    fwrite( data, 1, length, stdout );
+    fflush( stdout );
+  }
+#endif
+}  // namespace Adesto::Trace
@@ -0,0 +1,164 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_buffer.hpp
+ *
+ *  Description:
+ *    Non-blocking recorder for memory operation trace events. Producers only
+ *    touch a lock-free ring, while a low priority task drains the ring into
+ *    a byte sink (serial port on target, stdout on the host).
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TRACE_BUFFER_HPP
+#define ADESTO_TRACE_BUFFER_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* Trace Includes */
+#include <src/trace/trace_format.hpp>
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Aliases
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Consumer of framed trace data. Called only from the draining context and
+   *  allowed to block until the data has been shipped.
+   */
+  using Sink = void ( * )( const void *const data, const size_t length );
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  /**
+   *  The target's ring shares 64 KB of SRAM with a 55 KB FreeRTOS heap, so it
+   *  stays at 256 records (4 KB). WriteChip emits four records per page and
+   *  outruns a 115200 baud link, so expect drops there; dropped() counts them.
+   *  The host has no such limit and keeps enough to absorb a slow consumer.
+   */
+#if defined( EMBEDDED )
+  static constexpr size_t BUFFER_DEPTH     = 256;      /**< Records held before dropping */
+  static constexpr size_t BUFFER_RAM_LIMIT = 4 * 1024; /**< Bytes of .bss the ring may take */
+#else
+  static constexpr size_t BUFFER_DEPTH     = 1024;
+  static constexpr size_t BUFFER_RAM_LIMIT = 16 * 1024;
+#endif
+  static constexpr size_t DRAIN_PERIOD_MS    = 5; /**< Drain thread wake up period */
+  static constexpr size_t DRAIN_STACK_KBYTES = 1;
+
+  static_assert( ( BUFFER_DEPTH * sizeof( Record ) ) <= BUFFER_RAM_LIMIT );
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Globally enables or disables recording. Disabled recorders cost a single
+   *  branch per call.
+   *
+   *  @param[in]  state     Whether or not to record
+   *  @return void
+   */
+  void enable( const bool state );
+
+  /**
+   *  Time base stamped on every record
+   *
+   *  @return uint32_t      Microseconds, wrapping
+   */
+  uint32_t timestamp();
+
+  /**
+   *  Records a single event. Only one context may produce events.
+   *
+   *  @param[in]  op        Operation being recorded
+   *  @param[in]  phase     Which part of the operation this is
+   *  @param[in]  address   Device address
+   *  @param[in]  length    Number of bytes
+   *  @param[in]  status    Result of the operation, if applicable
+   *  @param[in]  sequence  Pairing id for BEGIN/END events
+   *  @return void
+   */
+  void record( const Operation op, const Phase phase, const size_t address, const size_t length, const uint8_t status,
+               const uint8_t sequence );
+
+  /**
+   *  Records the start of an operation
+   *
+   *  @param[in]  op        Operation being started
+   *  @param[in]  address   Device address
+   *  @param[in]  length    Number of bytes
+   *  @return uint8_t       Sequence id to pass to end()
+   */
+  uint8_t begin( const Operation op, const size_t address, const size_t length );
+
+  /**
+   *  Records the completion of an operation started with begin()
+   *
+   *  @param[in]  sequence  Value returned from begin()
+   *  @param[in]  op        Operation that completed
+   *  @param[in]  address   Device address
+   *  @param[in]  length    Number of bytes
+   *  @param[in]  status    Result of the operation
+   *  @return void
+   */
+  void end( const uint8_t sequence, const Operation op, const size_t address, const size_t length, const uint8_t status );
+
+  /**
+   *  Records a user marker, useful for delimiting test cases in the stream
+   *
+   *  @param[in]  id        User defined identifier
+   *  @return void
+   */
+  void mark( const uint32_t id );
+
+  /**
+   *  Moves all currently buffered records into the sink as framed data.
+   *  Must only be called from a single consumer context.
+   *
+   *  @param[in]  sink      Where to send the frames
+   *  @return size_t        Number of records drained
+   */
+  size_t drain( Sink sink );
+
+  /**
+   *  Number of records waiting to be drained
+   *
+   *  @return size_t
+   */
+  size_t pending();
+
+  /**
+   *  Number of records that were lost because the buffer was full
+   *
+   *  @return size_t
+   */
+  size_t dropped();
+
+  /**
+   *  Starts a low priority thread that periodically drains into the sink.
+   *  Only the first call has any effect.
+   *
+   *  @param[in]  sink      Where to send the frames
+   *  @return void
+   */
+  void startDrainThread( Sink sink );
+
+#if !defined( EMBEDDED )
+  /**
+   *  Writes framed trace data to stdout. Pipe it into trace_decode, or
+   *  redirect it to a file for trace_replay.
+   *
+   *  @param[in]  data      Framed trace data
+   *  @param[in]  length    Number of bytes to write
+   *  @return void
+   */
+  void stdoutSink( const void *const data, const size_t length );
+#endif
+}  // namespace Adesto::Trace
+
+#endif /* !ADESTO_TRACE_BUFFER_HPP */
@@ -0,0 +1,180 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_device.cpp
+ *
+ *  Description:
+ *    Implementation of the trace recording device decorator
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstring>
+
+#if !defined( EMBEDDED )
+#include <cstdio>
+#endif
+
+/* Adesto Includes */
+#include <src/trace/trace_buffer.hpp>
+#include <src/trace/trace_device.hpp>
+
+namespace Adesto::Trace
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+#if !defined( EMBEDDED )
+  void fileSink( void *context, const void *const data, const size_t length )
+  {
+    fwrite( data, 1, length, static_cast<FILE *>( context ) );
+  }
+#endif
+
+  /*-------------------------------------------------------------------------------
+  RecordingDevice Implementation
+  -------------------------------------------------------------------------------*/
+  RecordingDevice::RecordingDevice( IGenericDevice_sPtr device, FrameSink sink, void *sinkContext, ClockFunc clock,
+                                    void *clockContext ) :
+      mDevice( device ), mSink( sink ), mSinkContext( sinkContext ), mClock( clock ), mClockContext( clockContext ),
+      mSequence( 0 ), mCount( 0 )
+  {
+  }
+
+
+  RecordingDevice::~RecordingDevice()
+  {
+    flush();
+  }
+
+
+  void RecordingDevice::flush()
+  {
+    if ( !mCount || !mSink )
+    {
+      mCount = 0;
+      return;
+    }
+
+    const size_t payloadSize = mCount * sizeof( Record );
+
+    FrameHeader header;
+    header.sync0    = FRAME_SYNC_0;
+    header.sync1    = FRAME_SYNC_1;
+    header.count    = static_cast<uint8_t>( mCount );
+    header.checksum = frameChecksum( mFrame.data() + sizeof( FrameHeader ), payloadSize );
+    memcpy( mFrame.data(), &header, sizeof( header ) );
+
+    mSink( mSinkContext, mFrame.data(), sizeof( FrameHeader ) + payloadSize );
+    mCount = 0;
+  }
+
+
+  Status RecordingDevice::open()
+  {
+    return mDevice->open();
+  }
+
+
+  Status RecordingDevice::close()
+  {
+    flush();
+    return mDevice->close();
+  }
+
+
+  Status RecordingDevice::write( const size_t address, const void *const data, const size_t length )
+  {
+    const uint8_t seq = begin( Operation::WRITE, address, length );
+    auto result       = mDevice->write( address, data, length );
+    end( seq, Operation::WRITE, address, length, result );
+    return result;
+  }
+
+
+  Status RecordingDevice::read( const size_t address, void *const data, const size_t length )
+  {
+    const uint8_t seq = begin( Operation::READ, address, length );
+    auto result       = mDevice->read( address, data, length );
+    end( seq, Operation::READ, address, length, result );
+    return result;
+  }
+
+
+  Status RecordingDevice::erase( const size_t address, const size_t length )
+  {
+    const uint8_t seq = begin( Operation::ERASE, address, length );
+    auto result       = mDevice->erase( address, length );
+    end( seq, Operation::ERASE, address, length, result );
+    return result;
+  }
+
+
+  Status RecordingDevice::erase( const Chunk chunk, const size_t id )
+  {
+    /*-------------------------------------------------
+    Record in address form so replay doesn't need to
+    know the geometry of the device that was traced.
+    -------------------------------------------------*/
+    auto props = mDevice->getDeviceProperties();
+    return erase( chunkStartAddress( props, chunk, id ), chunkSize( props, chunk ) );
+  }
+
+
+  Status RecordingDevice::eraseChip()
+  {
+    const uint8_t seq = begin( Operation::ERASE_CHIP, 0, 0 );
+    auto result       = mDevice->eraseChip();
+    end( seq, Operation::ERASE_CHIP, 0, 0, result );
+    return result;
+  }
+
+
+  Properties RecordingDevice::getDeviceProperties()
+  {
+    return mDevice->getDeviceProperties();
+  }
+
+
+  Status RecordingDevice::pendEvent( const Event event, const size_t timeout )
+  {
+    return mDevice->pendEvent( event, timeout );
+  }
+
+
+  uint8_t RecordingDevice::begin( const Operation op, const size_t address, const size_t length )
+  {
+    const uint8_t sequence = mSequence++;
+    record( op, Phase::BEGIN, address, length, 0, sequence );
+    return sequence;
+  }
+
+
+  void RecordingDevice::end( const uint8_t sequence, const Operation op, const size_t address, const size_t length,
+                             const Status status )
+  {
+    record( op, Phase::END, address, length, static_cast<uint8_t>( status ), sequence );
+  }
+
+
+  void RecordingDevice::record( const Operation op, const Phase phase, const size_t address, const size_t length,
+                                const uint8_t status, const uint8_t sequence )
+  {
+    Record entry;
+    entry.timestamp = mClock ? static_cast<uint32_t>( mClock( mClockContext ) ) : timestamp();
+    entry.address   = static_cast<uint32_t>( address );
+    entry.length    = static_cast<uint32_t>( length );
+    entry.operation = static_cast<uint8_t>( op );
+    entry.phase     = static_cast<uint8_t>( phase );
+    entry.status    = status;
+    entry.sequence  = sequence;
+
+    memcpy( mFrame.data() + sizeof( FrameHeader ) + ( mCount * sizeof( Record ) ), &entry, sizeof( Record ) );
+    if ( ++mCount == FRAME_MAX_RECORDS )
+    {
+      flush();
+    }
+  }
+}  // namespace Adesto::Trace
@@ -0,0 +1,121 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_device.hpp
+ *
+ *  Description:
+ *    Decorator that records every operation passing through it. The frames it
+ *    emits double as the capture file format consumed by the replay tooling.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TRACE_DEVICE_HPP
+#define ADESTO_TRACE_DEVICE_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/clock.hpp>
+#include <src/trace/trace_format.hpp>
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Aliases
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Consumer of one RecordingDevice's framed trace data. Called from whichever
+   *  thread is driving the device, once per filled frame and on flush(), so it
+   *  runs inside the traced calls and its cost lands in their timing. It must
+   *  not block: on target, copy the frame into a queue drained by a low
+   *  priority task rather than writing to a UART here. fileSink() is fine for
+   *  host captures, where the distortion doesn't matter.
+   */
+  using FrameSink = void ( * )( void *context, const void *const data, const size_t length );
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+#if !defined( EMBEDDED )
+  /**
+   *  Appends framed trace data to a file, ie a capture for trace_replay
+   *
+   *  @param[in]  context   FILE* opened for binary writing
+   *  @param[in]  data      Framed trace data
+   *  @param[in]  length    Number of bytes to write
+   *  @return void
+   */
+  void fileSink( void *context, const void *const data, const size_t length );
+#endif
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Wraps any generic device. BEGIN is recorded when the call is made and END
+   *  when it returns, carrying the result status. Records are framed inside
+   *  the instance and handed to its own sink, independent of the global trace
+   *  buffer, so several recorders can run side by side on the host or target.
+   *  A single instance must only be driven by one thread at a time.
+   */
+  class RecordingDevice : public Aurora::Memory::IGenericDevice
+  {
+  public:
+    /**
+     *  @param[in]  device        Device being recorded
+     *  @param[in]  sink          Where to send filled frames
+     *  @param[in]  sinkContext   Passed through to the sink
+     *  @param[in]  clock         Timestamp source, null for the system clock
+     *  @param[in]  clockContext  Passed through to the clock
+     */
+    RecordingDevice( Aurora::Memory::IGenericDevice_sPtr device, FrameSink sink, void *sinkContext,
+                     ClockFunc clock = nullptr, void *clockContext = nullptr );
+    ~RecordingDevice();
+
+    /**
+     *  Sends any partially filled frame to the sink. Also done on close()
+     *  and destruction.
+     *
+     *  @return void
+     */
+    void flush();
+
+    /*-------------------------------------------------
+    Generic Device Interface
+    -------------------------------------------------*/
+    Aurora::Memory::Status open() override;
+    Aurora::Memory::Status close() override;
+    Aurora::Memory::Status write( const size_t address, const void *const data, const size_t length ) override;
+    Aurora::Memory::Status read( const size_t address, void *const data, const size_t length ) override;
+    Aurora::Memory::Status erase( const size_t address, const size_t length ) override;
+    Aurora::Memory::Status erase( const Aurora::Memory::Chunk chunk, const size_t id ) override;
+    Aurora::Memory::Status eraseChip() override;
+    Aurora::Memory::Properties getDeviceProperties() override;
+    Aurora::Memory::Status pendEvent( const Aurora::Memory::Event event, const size_t timeout ) override;
+
+  private:
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    FrameSink mSink;
+    void *mSinkContext;
+    ClockFunc mClock;
+    void *mClockContext;
+    uint8_t mSequence;
+    size_t mCount; /**< Records waiting in mFrame */
+    std::array<uint8_t, FRAME_MAX_SIZE> mFrame;
+
+    uint8_t begin( const Operation op, const size_t address, const size_t length );
+    void end( const uint8_t sequence, const Operation op, const size_t address, const size_t length,
+              const Aurora::Memory::Status status );
+    void record( const Operation op, const Phase phase, const size_t address, const size_t length, const uint8_t status,
+                 const uint8_t sequence );
+  };
+}  // namespace Adesto::Trace
+
+#endif /* !ADESTO_TRACE_DEVICE_HPP */
@@ -0,0 +1,114 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_format.hpp
+ *
+ *  Description:
+ *    Binary layout of trace records and the frames used to ship them over a
+ *    byte stream. Shared between the on-target recorder and host decoders, so
+ *    this file must not depend on Chimera, Aurora, or the RTOS.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TRACE_FORMAT_HPP
+#define ADESTO_TRACE_FORMAT_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  enum class Operation : uint8_t
+  {
+    READ,
+    WRITE,
+    ERASE,
+    ERASE_CHIP,
+    MARK,  /**< User defined marker, address/length fields are free-form */
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  enum class Phase : uint8_t
+  {
+    BEGIN,
+    END,
+    INSTANT,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  A single trace event. BEGIN/END pairs share the same sequence number so
+   *  the decoder can compute per-operation latency.
+   */
+  struct Record
+  {
+    uint32_t timestamp; /**< Microseconds since boot */
+    uint32_t address;   /**< Device address the operation targeted */
+    uint32_t length;    /**< Number of bytes the operation covered */
+    uint8_t operation;  /**< Trace::Operation */
+    uint8_t phase;      /**< Trace::Phase */
+    uint8_t status;     /**< Aurora::Memory::Status on END, otherwise zero */
+    uint8_t sequence;   /**< Rolling id pairing BEGIN with END */
+  };
+  static_assert( sizeof( Record ) == 16 );
+
+  /**
+   *  Records are shipped in frames so they can be picked out of a stream that
+   *  is also carrying plain text (ie test runner output on the same UART).
+   *
+   *  Layout: [ SYNC_0 | SYNC_1 | count | checksum | count * Record ]
+   */
+  struct FrameHeader
+  {
+    uint8_t sync0;
+    uint8_t sync1;
+    uint8_t count;    /**< Number of records following the header */
+    uint8_t checksum; /**< XOR of every payload byte */
+  };
+  static_assert( sizeof( FrameHeader ) == 4 );
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr uint8_t FRAME_SYNC_0     = 0xA5;
+  static constexpr uint8_t FRAME_SYNC_1     = 0x5A;
+  static constexpr size_t FRAME_MAX_RECORDS = 8;
+  static constexpr size_t FRAME_MAX_SIZE    = sizeof( FrameHeader ) + ( FRAME_MAX_RECORDS * sizeof( Record ) );
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Computes the frame checksum over a payload
+   *
+   *  @param[in]  data      Payload bytes
+   *  @param[in]  length    Number of bytes in the payload
+   *  @return uint8_t
+   */
+  static inline uint8_t frameChecksum( const void *const data, const size_t length )
+  {
+    auto bytes  = reinterpret_cast<const uint8_t *>( data );
+    uint8_t sum = 0;
+
+    for ( size_t x = 0; x < length; x++ )
+    {
+      sum ^= bytes[ x ];
+    }
+
+    return sum;
+  }
+}  // namespace Adesto::Trace
+
+#endif /* !ADESTO_TRACE_FORMAT_HPP */
@@ -0,0 +1,96 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_reader.hpp
+ *
+ *  Description:
+ *    Extracts trace records from a captured byte stream. The stream may be
+ *    interleaved with arbitrary other data (ie test runner text), which is
+ *    skipped by resyncing on the frame header.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TRACE_READER_HPP
+#define ADESTO_TRACE_READER_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* Trace Includes */
+#include <src/trace/trace_format.hpp>
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct ParseStats
+  {
+    size_t frames;   /**< Valid frames found */
+    size_t records;  /**< Records contained in the valid frames */
+    size_t rejected; /**< Frame headers whose payload failed the checksum */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Walks a captured stream, invoking the handler for every record found
+   *
+   *  @param[in]  data      Start of the capture
+   *  @param[in]  size      Number of bytes in the capture
+   *  @param[in]  handler   Callable taking a (const Record &)
+   *  @return ParseStats
+   */
+  template<typename Handler>
+  ParseStats parseStream( const uint8_t *const data, const size_t size, Handler &&handler )
+  {
+    ParseStats stats = { 0, 0, 0 };
+    size_t idx       = 0;
+
+    while ( ( idx + sizeof( FrameHeader ) ) <= size )
+    {
+      FrameHeader hdr;
+      memcpy( &hdr, data + idx, sizeof( hdr ) );
+
+      if ( ( hdr.sync0 != FRAME_SYNC_0 ) || ( hdr.sync1 != FRAME_SYNC_1 ) || !hdr.count || ( hdr.count > FRAME_MAX_RECORDS ) )
+      {
+        idx++;
+        continue;
+      }
+
+      const size_t payloadSize = hdr.count * sizeof( Record );
+      const uint8_t *payload   = data + idx + sizeof( FrameHeader );
+
+      if ( ( idx + sizeof( FrameHeader ) + payloadSize ) > size )
+      {
+        break;
+      }
+
+      if ( frameChecksum( payload, payloadSize ) != hdr.checksum )
+      {
+        stats.rejected++;
+        idx++;
+        continue;
+      }
+
+      for ( size_t x = 0; x < hdr.count; x++ )
+      {
+        Record rec;
+        memcpy( &rec, payload + ( x * sizeof( Record ) ), sizeof( Record ) );
+        handler( rec );
+      }
+
+      stats.frames++;
+      stats.records += hdr.count;
+      idx += sizeof( FrameHeader ) + payloadSize;
+    }
+
+    return stats;
+  }
+}  // namespace Adesto::Trace
+
+#endif /* !ADESTO_TRACE_READER_HPP */
@@ -0,0 +1,184 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_replay.cpp
+ *
+ *  Description:
+ *    Implementation of the trace replay engine
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+/* Adesto Includes */
+#include <src/trace/trace_replay.hpp>
+
+namespace Adesto::Trace
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t PEND_FOREVER = std::numeric_limits<size_t>::max();
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static Status replayRead( IGenericDevice &device, const ReplayConfig &cfg, const size_t address, const size_t length )
+  {
+    size_t offset = 0;
+    auto result   = Status::ERR_OK;
+
+    while ( ( offset < length ) && ( result == Status::ERR_OK ) )
+    {
+      const size_t chunk = std::min( cfg.scratchSize, length - offset );
+      result             = device.read( address + offset, cfg.scratch, chunk );
+      offset += chunk;
+    }
+
+    return result;
+  }
+
+
+  static Status replayWrite( IGenericDevice &device, const ReplayConfig &cfg, const size_t address, const size_t length )
+  {
+    size_t offset = 0;
+    auto result   = Status::ERR_OK;
+
+    while ( ( offset < length ) && ( result == Status::ERR_OK ) )
+    {
+      const size_t chunk = std::min( cfg.scratchSize, length - offset );
+      result             = device.write( address + offset, cfg.scratch, chunk );
+
+      if ( result == Status::ERR_OK )
+      {
+        result = device.pendEvent( Event::MEM_WRITE_COMPLETE, PEND_FOREVER );
+      }
+
+      offset += chunk;
+    }
+
+    return result;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  void ReplayResult::clear()
+  {
+    for ( auto &op : ops )
+    {
+      op.latency.clear();
+      op.bytes  = 0;
+      op.errors = 0;
+    }
+
+    elapsed  = 0;
+    replayed = 0;
+    failed   = 0;
+  }
+
+
+  Status replay( const Record *const records, const size_t count, IGenericDevice &device, const ReplayConfig &cfg,
+                 ReplayResult &result )
+  {
+    result.clear();
+
+    if ( !records || !cfg.clock || !cfg.scratch || !cfg.scratchSize )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Written data doesn't matter for timing, but use a
+    pattern that isn't the erased state so the device
+    really does have to program something.
+    -------------------------------------------------*/
+    memset( cfg.scratch, 0x5A, cfg.scratchSize );
+
+    const uint64_t start = cfg.clock( cfg.clockContext );
+    bool haveEnd         = false;
+    uint32_t lastEnd     = 0;
+
+    for ( size_t x = 0; x < count; x++ )
+    {
+      const Record &rec = records[ x ];
+      if ( rec.phase == static_cast<uint8_t>( Phase::END ) )
+      {
+        haveEnd = true;
+        lastEnd = rec.timestamp;
+        continue;
+      }
+
+      if ( ( rec.phase != static_cast<uint8_t>( Phase::BEGIN ) ) || ( rec.operation >= result.ops.size() ) )
+      {
+        continue;
+      }
+
+      /*-------------------------------------------------
+      Timestamps wrap at 32 bits, and a BEGIN can come
+      before the previous END when operations overlap.
+      -------------------------------------------------*/
+      const int32_t gap = static_cast<int32_t>( rec.timestamp - lastEnd );
+      if ( cfg.idle && haveEnd && ( gap > 0 ) )
+      {
+        cfg.idle( cfg.idleContext, static_cast<uint64_t>( gap ) );
+      }
+
+      const size_t address   = rec.address + cfg.addressOffset;
+      const uint64_t opStart = cfg.clock( cfg.clockContext );
+      auto status            = Status::ERR_OK;
+
+      switch ( static_cast<Operation>( rec.operation ) )
+      {
+        case Operation::READ:
+          status = replayRead( device, cfg, address, rec.length );
+          break;
+
+        case Operation::WRITE:
+          status = replayWrite( device, cfg, address, rec.length );
+          break;
+
+        case Operation::ERASE:
+          status = device.erase( address, rec.length );
+          if ( status == Status::ERR_OK )
+          {
+            status = device.pendEvent( Event::MEM_ERASE_COMPLETE, PEND_FOREVER );
+          }
+          break;
+
+        case Operation::ERASE_CHIP:
+          status = device.eraseChip();
+          if ( status == Status::ERR_OK )
+          {
+            status = device.pendEvent( Event::MEM_ERASE_COMPLETE, PEND_FOREVER );
+          }
+          break;
+
+        default:
+          // Markers carry no device operation
+          continue;
+      }
+
+      const uint64_t opTime = cfg.clock( cfg.clockContext ) - opStart;
+      auto &stats           = result.ops[ rec.operation ];
+
+      stats.latency.record( static_cast<uint32_t>( std::min<uint64_t>( opTime, std::numeric_limits<uint32_t>::max() ) ) );
+      stats.bytes += rec.length;
+      result.replayed++;
+
+      if ( status != Status::ERR_OK )
+      {
+        stats.errors++;
+        result.failed++;
+      }
+    }
+
+    result.elapsed = cfg.clock( cfg.clockContext ) - start;
+    return result.failed ? Status::ERR_FAIL : Status::ERR_OK;
+  }
+}  // namespace Adesto::Trace
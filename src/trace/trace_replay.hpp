@@ -0,0 +1,97 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_replay.hpp
+ *
+ *  Description:
+ *    Replays a captured operation trace against any generic device, collecting
+ *    throughput, latency distribution and erase counts. The same captured
+ *    workload can then be compared across drivers, caching layers, and
+ *    simulated timing profiles.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TRACE_REPLAY_HPP
+#define ADESTO_TRACE_REPLAY_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/clock.hpp>
+#include <src/common/latency_histogram.hpp>
+#include <src/trace/trace_format.hpp>
+
+namespace Adesto::Trace
+{
+  /*-------------------------------------------------------------------------------
+  Aliases
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Lets time pass without issuing anything, ie advancing a simulator clock
+   *
+   *  @param[in]  context   User data registered alongside the function
+   *  @param[in]  us        Microseconds of idle time
+   *  @return void
+   */
+  using IdleFunc = void ( * )( void *context, const uint64_t us );
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct ReplayConfig
+  {
+    ClockFunc clock;      /**< Time source used to measure each operation */
+    void *clockContext;   /**< Passed through to the clock function */
+    IdleFunc idle;        /**< Optional, reproduces the captured gaps between operations */
+    void *idleContext;    /**< Passed through to the idle function */
+    uint8_t *scratch;     /**< Buffer used for read/write data */
+    size_t scratchSize;   /**< Larger operations are split into pieces of this size */
+    size_t addressOffset; /**< Added to every traced address */
+  };
+
+  struct OpStats
+  {
+    LatencyHistogram latency; /**< Per operation latency, including the completion wait */
+    uint64_t bytes;
+    size_t errors;
+  };
+
+  struct ReplayResult
+  {
+    std::array<OpStats, static_cast<size_t>( Operation::NUM_OPTIONS )> ops;
+    uint64_t elapsed; /**< Total time from the first operation to the last completion */
+    size_t replayed;
+    size_t failed;
+
+    void clear();
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Issues every operation described by the BEGIN records in the trace,
+   *  waiting for each to complete before the next is started. Without an
+   *  idle function operations run back to back and the captured timestamps
+   *  are ignored. With one, the host think time between an operation's END
+   *  and the next BEGIN is handed to it before the next operation starts.
+   *
+   *  @param[in]  records   Captured trace records
+   *  @param[in]  count     Number of records
+   *  @param[in]  device    Device to run the operations against
+   *  @param[in]  cfg       Replay configuration
+   *  @param[out] result    Collected statistics
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status replay( const Record *const records, const size_t count, Aurora::Memory::IGenericDevice &device,
+                                 const ReplayConfig &cfg, ReplayResult &result );
+}  // namespace Adesto::Trace
+
+#endif /* !ADESTO_TRACE_REPLAY_HPP */
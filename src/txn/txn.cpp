@@ -0,0 +1,445 @@
+/********************************************************************************
+ *  File Name:
+ *    txn.cpp
+ *
+ *  Description:
+ *    Implementation of the transactional update store
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstring>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/stream/stream.hpp>
+#include <src/txn/txn.hpp>
+
+namespace Adesto::Txn
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static inline void putWord( uint8_t *const dst, const uint32_t value )
+  {
+    dst[ 0 ] = static_cast<uint8_t>( value );
+    dst[ 1 ] = static_cast<uint8_t>( value >> 8 );
+    dst[ 2 ] = static_cast<uint8_t>( value >> 16 );
+    dst[ 3 ] = static_cast<uint8_t>( value >> 24 );
+  }
+
+
+  static inline uint32_t getWord( const uint8_t *const src )
+  {
+    return static_cast<uint32_t>( src[ 0 ] ) | ( static_cast<uint32_t>( src[ 1 ] ) << 8 )
+           | ( static_cast<uint32_t>( src[ 2 ] ) << 16 ) | ( static_cast<uint32_t>( src[ 3 ] ) << 24 );
+  }
+
+
+  static bool isBlank( const uint8_t *const data, const size_t length )
+  {
+    for ( size_t x = 0; x < length; x++ )
+    {
+      if ( data[ x ] != 0xFF )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  static inline size_t roundUp( const size_t value, const size_t multiple )
+  {
+    return ( ( value + multiple - 1 ) / multiple ) * multiple;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Store Implementation
+  -------------------------------------------------------------------------------*/
+  Store::Store( IGenericDevice_sPtr device ) :
+      mDevice( device ), mConfig{}, mStats{}, mActive( 0 ), mStaged( 0 ), mSequence( 0 ), mUnitSize( 0 ), mSlotSize( 0 ),
+      mCommitUnit( 0 ), mCursor( 0 ), mInTxn( false ), mOpen( false )
+  {
+  }
+
+
+  Store::~Store()
+  {
+  }
+
+
+  size_t Store::footprint( const Config &config, const Properties &props )
+  {
+    const size_t unit = chunkSize( props, props.eraseChunk );
+
+    if ( !unit || ( unit % SCAN_SIZE ) || !config.numSlots || ( config.numSlots > MAX_SLOTS ) || !config.slotSize )
+    {
+      return 0;
+    }
+
+    return ( COMMIT_UNITS * unit ) + ( config.numSlots * 2 * roundUp( config.slotSize, unit ) );
+  }
+
+
+  Status Store::open( const Config &config )
+  {
+    if ( !mDevice )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Validate the layout against the device
+    -------------------------------------------------*/
+    auto props         = mDevice->getDeviceProperties();
+    const size_t size  = footprint( config, props );
+    const size_t unit  = chunkSize( props, props.eraseChunk );
+    const size_t limit = props.pageSize * props.numPages;
+
+    if ( !size || ( config.baseAddress % unit ) || ( config.baseAddress > limit ) || ( size > ( limit - config.baseAddress ) ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    mConfig   = config;
+    mUnitSize = unit;
+    mSlotSize = roundUp( config.slotSize, unit );
+    mStaged   = 0;
+    mInTxn    = false;
+    mOpen     = false;
+
+    /*-------------------------------------------------
+    The newest valid record across both commit units
+    wins. Nothing outside of them is ever read here.
+    -------------------------------------------------*/
+    std::array<size_t, COMMIT_UNITS> ends;
+    bool found = false;
+
+    mStats.recoveryReads = 0;
+    for ( size_t x = 0; x < COMMIT_UNITS; x++ )
+    {
+      const auto result = scan( x, found, ends[ x ] );
+      if ( result != Status::ERR_OK )
+      {
+        return result;
+      }
+    }
+
+    if ( !found )
+    {
+      const auto result = format();
+      if ( result != Status::ERR_OK )
+      {
+        return result;
+      }
+    }
+    else
+    {
+      mCursor = ends[ mCommitUnit ];
+    }
+
+    mOpen = true;
+    return Status::ERR_OK;
+  }
+
+
+  Status Store::close()
+  {
+    abort();
+    mOpen = false;
+    return Status::ERR_OK;
+  }
+
+
+  Status Store::read( const size_t slot, const size_t offset, void *const data, const size_t length )
+  {
+    if ( !mOpen )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( ( slot >= mConfig.numSlots ) || !data || ( offset > mSlotSize ) || ( length > ( mSlotSize - offset ) ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    return mDevice->read( copyAddress( slot, ( mActive >> slot ) & 1u ) + offset, data, length );
+  }
+
+
+  Status Store::begin()
+  {
+    if ( !mOpen || mInTxn )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    mStaged = 0;
+    mInTxn  = true;
+    return Status::ERR_OK;
+  }
+
+
+  Status Store::write( const size_t slot, const void *const data, const size_t length )
+  {
+    if ( !mOpen || !mInTxn )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( ( slot >= mConfig.numSlots ) || ( !data && length ) || ( length > mSlotSize ) || ( ( mStaged >> slot ) & 1u ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    The inactive copy is never referenced by a valid
+    record newer than the active one, so it is free to
+    be overwritten.
+    -------------------------------------------------*/
+    const size_t address = copyAddress( slot, ( ( mActive >> slot ) & 1u ) ^ 1u );
+
+    auto result = eraseRange( address, mSlotSize );
+    if ( ( result == Status::ERR_OK ) && length )
+    {
+      result = program( address, data, length );
+    }
+
+    if ( result == Status::ERR_OK )
+    {
+      mStaged |= 1ull << slot;
+      mStats.shadowBytes += length;
+    }
+
+    return result;
+  }
+
+
+  Status Store::commit()
+  {
+    if ( !mOpen || !mInTxn )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    mInTxn = false;
+    if ( !mStaged )
+    {
+      return Status::ERR_OK;
+    }
+
+    /*-------------------------------------------------
+    On failure the record may or may not have made it.
+    Only open() can tell, so force the caller through it
+    before the wrong copy gets overwritten.
+    -------------------------------------------------*/
+    const uint64_t active = mActive ^ mStaged;
+    const auto result     = appendRecord( mSequence + 1, active );
+
+    if ( result == Status::ERR_OK )
+    {
+      mActive = active;
+      mSequence++;
+      mStats.commits++;
+    }
+    else
+    {
+      mOpen = false;
+    }
+
+    mStaged = 0;
+    return result;
+  }
+
+
+  void Store::abort()
+  {
+    if ( mInTxn )
+    {
+      mStats.aborts++;
+    }
+
+    mStaged = 0;
+    mInTxn  = false;
+  }
+
+
+  size_t Store::slotSize() const
+  {
+    return mSlotSize;
+  }
+
+
+  size_t Store::numSlots() const
+  {
+    return mConfig.numSlots;
+  }
+
+
+  uint32_t Store::sequence() const
+  {
+    return mSequence;
+  }
+
+
+  Stats Store::getStats() const
+  {
+    return mStats;
+  }
+
+
+  void Store::clearStats()
+  {
+    mStats = {};
+  }
+
+
+  size_t Store::copyAddress( const size_t slot, const size_t copy ) const
+  {
+    return commitAddress( COMMIT_UNITS ) + ( ( ( 2 * slot ) + copy ) * mSlotSize );
+  }
+
+
+  size_t Store::commitAddress( const size_t unit ) const
+  {
+    return mConfig.baseAddress + ( unit * mUnitSize );
+  }
+
+
+  Status Store::scan( const size_t unit, bool &found, size_t &end )
+  {
+    end = 0;
+
+    for ( size_t offset = 0; offset < mUnitSize; offset += SCAN_SIZE )
+    {
+      const auto result = mDevice->read( commitAddress( unit ) + offset, mScratch.data(), SCAN_SIZE );
+      if ( result != Status::ERR_OK )
+      {
+        return result;
+      }
+
+      mStats.recoveryReads += SCAN_SIZE;
+
+      /*-------------------------------------------------
+      Records are appended in order, so the first blank
+      one ends the unit. A torn record still takes up
+      its space, it just never wins.
+      -------------------------------------------------*/
+      for ( size_t x = 0; x < SCAN_SIZE; x += RECORD_SIZE )
+      {
+        const uint8_t *record = mScratch.data() + x;
+        if ( isBlank( record, RECORD_SIZE ) )
+        {
+          return Status::ERR_OK;
+        }
+
+        end = offset + x + RECORD_SIZE;
+
+        const uint32_t sequence = getWord( &record[ 4 ] );
+        const uint32_t crc      = getWord( &record[ RECORD_DATA_SIZE ] );
+        const bool intact       = ( getWord( &record[ 0 ] ) == RECORD_MAGIC )
+                            && ( crc == Stream::crc32Update( 0, record, RECORD_DATA_SIZE ) );
+
+        if ( intact && ( !found || ( sequence > mSequence ) ) )
+        {
+          found       = true;
+          mSequence   = sequence;
+          mActive     = getWord( &record[ 8 ] ) | ( static_cast<uint64_t>( getWord( &record[ 12 ] ) ) << 32 );
+          mCommitUnit = unit;
+        }
+      }
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status Store::format()
+  {
+    /*-------------------------------------------------
+    Until the first commit every slot reads from copy
+    zero, so make sure those read back erased.
+    -------------------------------------------------*/
+    auto result = eraseRange( commitAddress( 0 ), COMMIT_UNITS * mUnitSize );
+    for ( size_t slot = 0; ( slot < mConfig.numSlots ) && ( result == Status::ERR_OK ); slot++ )
+    {
+      result = eraseRange( copyAddress( slot, 0 ), mSlotSize );
+    }
+
+    mActive     = 0;
+    mSequence   = 0;
+    mCommitUnit = 0;
+    mCursor     = 0;
+    return result;
+  }
+
+
+  Status Store::appendRecord( const uint32_t sequence, const uint64_t active )
+  {
+    /*-------------------------------------------------
+    Move to the other unit once this one is full. Its
+    records are all older, so erasing it is safe.
+    -------------------------------------------------*/
+    if ( ( mCursor + RECORD_SIZE ) > mUnitSize )
+    {
+      const size_t next = ( mCommitUnit + 1 ) % COMMIT_UNITS;
+      const auto result = eraseRange( commitAddress( next ), mUnitSize );
+      if ( result != Status::ERR_OK )
+      {
+        return result;
+      }
+
+      mCommitUnit = next;
+      mCursor     = 0;
+      mStats.swaps++;
+    }
+
+    uint8_t record[ RECORD_SIZE ];
+    memset( record, 0xFF, sizeof( record ) );
+    putWord( &record[ 0 ], RECORD_MAGIC );
+    putWord( &record[ 4 ], sequence );
+    putWord( &record[ 8 ], static_cast<uint32_t>( active ) );
+    putWord( &record[ 12 ], static_cast<uint32_t>( active >> 32 ) );
+    putWord( &record[ RECORD_DATA_SIZE ], Stream::crc32Update( 0, record, RECORD_DATA_SIZE ) );
+
+    /*-------------------------------------------------
+    A failed program may have left bits behind, never
+    try to program that spot again.
+    -------------------------------------------------*/
+    const size_t address = commitAddress( mCommitUnit ) + mCursor;
+    mCursor += RECORD_SIZE;
+
+    return program( address, record, RECORD_SIZE );
+  }
+
+
+  Status Store::eraseRange( const size_t address, const size_t length )
+  {
+    auto result = mDevice->erase( address, length );
+    if ( result == Status::ERR_OK )
+    {
+      result = mDevice->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    return result;
+  }
+
+
+  Status Store::program( const size_t address, const void *const data, const size_t length )
+  {
+    auto result = mDevice->write( address, data, length );
+    if ( result == Status::ERR_OK )
+    {
+      result = mDevice->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    return result;
+  }
+}  // namespace Adesto::Txn
@@ -0,0 +1,184 @@
+/********************************************************************************
+ *  File Name:
+ *    txn.hpp
+ *
+ *  Description:
+ *    Power fail safe transactional updates over any IGenericDevice. Each slot
+ *    has two copies on the device; new contents go to the inactive one and a
+ *    transaction becomes visible with a single small commit record. A reset
+ *    at any point leaves either every slot of a transaction updated or none.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_TXN_HPP
+#define ADESTO_TXN_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::Txn
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t MAX_SLOTS        = 64;         /**< One bit each in the commit record */
+  static constexpr size_t COMMIT_UNITS     = 2;          /**< Erase units holding commit records */
+  static constexpr size_t RECORD_SIZE      = 32;         /**< Bytes per commit record, divides a page */
+  static constexpr size_t SCAN_SIZE        = 256;        /**< Bytes read per step of recovery */
+  static constexpr uint32_t RECORD_MAGIC   = 0x314E5854; /**< "TXN1" */
+  static constexpr size_t RECORD_DATA_SIZE = 16;         /**< Magic, sequence and copy mask, covered by the CRC */
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct Config
+  {
+    size_t baseAddress; /**< Start of the area, erase unit aligned */
+    size_t numSlots;    /**< Independent objects, at most MAX_SLOTS */
+    size_t slotSize;    /**< Largest object in bytes, rounded up to whole erase units */
+  };
+
+  struct Stats
+  {
+    size_t commits;
+    size_t aborts;
+    size_t swaps;         /**< Times the commit area moved to its other unit */
+    size_t recoveryReads; /**< Bytes read by the last open() */
+    uint64_t shadowBytes; /**< Slot data written to inactive copies */
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Layout, starting at Config::baseAddress:
+   *    - COMMIT_UNITS erase units of commit records, appended in order and
+   *      filled one unit at a time. Each record holds a sequence number and
+   *      which copy of every slot is current.
+   *    - For each slot, two copies of slotSize bytes.
+   *
+   *  A transaction erases and programs the inactive copy of each slot it
+   *  touches, then programs one RECORD_SIZE record. Torn records fail their
+   *  CRC and are skipped, so the newest valid record always describes a
+   *  complete transaction. Recovery only reads the commit units, so its cost
+   *  is fixed no matter how many slots or how much data the store holds.
+   *
+   *  Not thread safe.
+   */
+  class Store
+  {
+  public:
+    Store( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Store();
+
+    /**
+     *  Bytes of device a configuration occupies
+     *
+     *  @param[in]  config    Layout to size
+     *  @param[in]  props     Device the store will live on
+     *  @return size_t        Zero if the configuration is invalid
+     */
+    static size_t footprint( const Config &config, const Aurora::Memory::Properties &props );
+
+    /**
+     *  Recovers the newest committed state, or formats the area if no valid
+     *  commit record exists. An open transaction left by a reset is dropped.
+     *
+     *  @param[in]  config    Layout, must match the one the area was made with
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status open( const Config &config );
+
+    /**
+     *  Drops any open transaction
+     *
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status close();
+
+    /**
+     *  Reads the committed contents of a slot. Bytes never written read as
+     *  the erased value.
+     *
+     *  @param[in]  slot      Slot index
+     *  @param[in]  offset    Byte offset inside the slot
+     *  @param[out] data      Destination buffer
+     *  @param[in]  length    Number of bytes to read
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status read( const size_t slot, const size_t offset, void *const data, const size_t length );
+
+    /**
+     *  Starts a transaction
+     *
+     *  @return Aurora::Memory::Status  ERR_FAIL if one is already open
+     */
+    Aurora::Memory::Status begin();
+
+    /**
+     *  Stages the new contents of a slot. Nothing is visible to read() or
+     *  survives a reset until commit(). Each slot can be staged once per
+     *  transaction.
+     *
+     *  @param[in]  slot      Slot index
+     *  @param[in]  data      New contents
+     *  @param[in]  length    Bytes of new contents, at most the slot size
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status write( const size_t slot, const void *const data, const size_t length );
+
+    /**
+     *  Atomically switches every staged slot to its new contents. If this
+     *  fails the store closes, as the commit may or may not have landed;
+     *  open() again to find out.
+     *
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status commit();
+
+    /**
+     *  Throws away the staged contents
+     *
+     *  @return void
+     */
+    void abort();
+
+    size_t slotSize() const;
+    size_t numSlots() const;
+    uint32_t sequence() const;
+    Stats getStats() const;
+    void clearStats();
+
+  private:
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Config mConfig;
+    Stats mStats;
+    std::array<uint8_t, SCAN_SIZE> mScratch;
+    uint64_t mActive; /**< Bit set means copy one of the slot is current */
+    uint64_t mStaged; /**< Slots written in the open transaction */
+    uint32_t mSequence;
+    size_t mUnitSize;
+    size_t mSlotSize;   /**< Rounded up to erase units */
+    size_t mCommitUnit; /**< Commit unit taking the next record */
+    size_t mCursor;     /**< Offset of the next record inside it */
+    bool mInTxn;
+    bool mOpen;
+
+    size_t copyAddress( const size_t slot, const size_t copy ) const;
+    size_t commitAddress( const size_t unit ) const;
+    Aurora::Memory::Status scan( const size_t unit, bool &found, size_t &end );
+    Aurora::Memory::Status format();
+    Aurora::Memory::Status appendRecord( const uint32_t sequence, const uint64_t active );
+    Aurora::Memory::Status eraseRange( const size_t address, const size_t length );
+    Aurora::Memory::Status program( const size_t address, const void *const data, const size_t length );
+  };
+}  // namespace Adesto::Txn
+
+#endif /* !ADESTO_TXN_HPP */
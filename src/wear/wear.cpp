@@ -0,0 +1,681 @@
+/********************************************************************************
+ *  File Name:
+ *    wear.cpp
+ *
+ *  Description:
+ *    Implementation of the wear aware erase unit allocator
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/stream/stream.hpp>
+#include <src/wear/wear.hpp>
+
+namespace Adesto::Wear
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static inline void putWord( uint8_t *const dst, const uint32_t value )
+  {
+    dst[ 0 ] = static_cast<uint8_t>( value );
+    dst[ 1 ] = static_cast<uint8_t>( value >> 8 );
+    dst[ 2 ] = static_cast<uint8_t>( value >> 16 );
+    dst[ 3 ] = static_cast<uint8_t>( value >> 24 );
+  }
+
+
+  static inline uint32_t getWord( const uint8_t *const src )
+  {
+    return static_cast<uint32_t>( src[ 0 ] ) | ( static_cast<uint32_t>( src[ 1 ] ) << 8 )
+           | ( static_cast<uint32_t>( src[ 2 ] ) << 16 ) | ( static_cast<uint32_t>( src[ 3 ] ) << 24 );
+  }
+
+
+  static bool isBlank( const uint8_t *const data, const size_t length )
+  {
+    for ( size_t x = 0; x < length; x++ )
+    {
+      if ( data[ x ] != 0xFF )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Allocator Implementation
+  -------------------------------------------------------------------------------*/
+  Allocator::Allocator( IGenericDevice_sPtr device ) :
+      mDevice( device ), mEntries( nullptr ), mFreeMask( 0 ), mUsedMask( 0 ), mFloor( 0 ), mSequence( 0 ), mUnitSize( 0 ),
+      mPageSize( 0 ), mNumUnits( 0 ), mTableUnits( 0 ), mActiveCopy( 0 ), mSinceCheck( 0 ), mNumFree( 0 ), mOpen( false )
+  {
+    mConfig = {};
+    clearStats();
+  }
+
+
+  Allocator::~Allocator()
+  {
+  }
+
+
+  Status Allocator::open( const Config &config )
+  {
+    if ( mOpen )
+    {
+      return Status::ERR_OK;
+    }
+
+    if ( !mDevice || !config.bucketSize )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------
+    Size everything off the device's erase unit
+    -------------------------------------------------*/
+    auto props = mDevice->getDeviceProperties();
+    mConfig    = config;
+    mUnitSize  = chunkSize( props, props.eraseChunk );
+    mPageSize  = std::min( props.pageSize, SCRATCH_SIZE );
+    mNumUnits  = mUnitSize ? ( props.pageSize * props.numPages ) / mUnitSize : 0;
+
+    if ( !mNumUnits || !mPageSize || ( mNumUnits >= INVALID_UNIT ) || ( mUnitSize % mPageSize ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    mTableUnits = ( tableSize() + mUnitSize - 1 ) / mUnitSize;
+    if ( ( 2 * mTableUnits ) >= mNumUnits )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    mEntries.reset( new ( std::nothrow ) Entry[ mNumUnits ] );
+    if ( !mEntries )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Take the newest intact copy of the table
+    -------------------------------------------------*/
+    uint32_t sequence[ 2 ] = { 0, 0 };
+    bool valid[ 2 ]        = { false, false };
+
+    for ( size_t copy = 0; copy < 2; copy++ )
+    {
+      if ( mDevice->read( copy * mTableUnits * mUnitSize, mScratch.data(), TABLE_HEADER_SIZE ) == Status::ERR_OK )
+      {
+        valid[ copy ]    = ( getWord( &mScratch[ 0 ] ) == TABLE_MAGIC ) && ( getWord( &mScratch[ 12 ] ) == mNumUnits );
+        sequence[ copy ] = getWord( &mScratch[ 4 ] );
+      }
+    }
+
+    const bool newer    = static_cast<int32_t>( sequence[ 1 ] - sequence[ 0 ] ) > 0;
+    const size_t newest = ( valid[ 1 ] && ( !valid[ 0 ] || newer ) ) ? 1 : 0;
+    const size_t oldest = newest ^ 1;
+
+    if ( !( valid[ newest ] && load( newest ) ) && !( valid[ oldest ] && load( oldest ) ) )
+    {
+      format();
+    }
+
+    for ( size_t unit = 0; unit < ( 2 * mTableUnits ); unit++ )
+    {
+      mEntries[ unit ].state = State::RESERVED;
+    }
+
+    mSinceCheck = 0;
+    mOpen       = true;
+    rebuild();
+    return Status::ERR_OK;
+  }
+
+
+  Status Allocator::close()
+  {
+    if ( !mOpen )
+    {
+      return Status::ERR_OK;
+    }
+
+    const auto result = sync();
+    mEntries.reset();
+    mOpen = false;
+    return result;
+  }
+
+
+  Status Allocator::allocate( size_t &unit )
+  {
+    if ( !mOpen )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    if ( mConfig.staticInterval && mConfig.relocate && ( ++mSinceCheck >= mConfig.staticInterval ) )
+    {
+      mSinceCheck = 0;
+      levelColdData();
+    }
+
+    if ( !mFreeMask )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Head of the least worn non-empty bucket
+    -------------------------------------------------*/
+    const size_t candidate = mFree[ __builtin_ctz( mFreeMask ) ].head;
+    unlink( candidate );
+
+    const auto result = eraseUnit( candidate );
+    if ( result != Status::ERR_OK )
+    {
+      link( candidate );
+      return result;
+    }
+
+    mEntries[ candidate ].state = State::USED;
+    link( candidate );
+    rebase();
+
+    mStats.allocations++;
+    unit = candidate;
+    return Status::ERR_OK;
+  }
+
+
+  Status Allocator::release( const size_t unit )
+  {
+    if ( !mOpen || ( unit >= mNumUnits ) || ( mEntries[ unit ].state != State::USED ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    unlink( unit );
+    mEntries[ unit ].state = State::FREE;
+    link( unit );
+
+    mStats.releases++;
+    return Status::ERR_OK;
+  }
+
+
+  Status Allocator::sync()
+  {
+    if ( !mOpen )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    /*-------------------------------------------------
+    Erase the stale copy first so the table includes
+    the cycles spent rewriting it.
+    -------------------------------------------------*/
+    const size_t copy = mActiveCopy ^ 1;
+    auto result       = Status::ERR_OK;
+
+    for ( size_t unit = copy * mTableUnits; ( unit < ( copy + 1 ) * mTableUnits ) && ( result == Status::ERR_OK ); unit++ )
+    {
+      result = eraseUnit( unit );
+    }
+
+    if ( result != Status::ERR_OK )
+    {
+      return result;
+    }
+
+    /*-------------------------------------------------
+    Counts are stored relative to the least worn unit.
+    Refuse rather than clamp, a clamped count would be
+    silently lost wear on the next open().
+    -------------------------------------------------*/
+    uint32_t base = std::numeric_limits<uint32_t>::max();
+    uint32_t most = 0;
+    for ( size_t unit = 0; unit < mNumUnits; unit++ )
+    {
+      base = std::min( base, mEntries[ unit ].count );
+      most = std::max( most, mEntries[ unit ].count );
+    }
+
+    if ( ( most - base ) > ENTRY_DELTA_MASK )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    auto encode = [ this, base ]( const size_t unit ) -> uint32_t {
+      return ( mEntries[ unit ].count - base ) | ( ( mEntries[ unit ].state == State::USED ) ? ENTRY_USED : 0 );
+    };
+
+    uint8_t header[ TABLE_HEADER_SIZE ];
+    putWord( &header[ 0 ], TABLE_MAGIC );
+    putWord( &header[ 4 ], mSequence + 1 );
+    putWord( &header[ 8 ], base );
+    putWord( &header[ 12 ], static_cast<uint32_t>( mNumUnits ) );
+
+    uint32_t crc = Stream::crc32Update( 0, header, 16 );
+    for ( size_t unit = 0; unit < mNumUnits; unit++ )
+    {
+      uint8_t raw[ ENTRY_SIZE ];
+      putWord( raw, encode( unit ) );
+      crc = Stream::crc32Update( crc, raw, sizeof( raw ) );
+    }
+    putWord( &header[ 16 ], crc );
+
+    /*-------------------------------------------------
+    Serialize one page at a time through the scratch
+    -------------------------------------------------*/
+    const size_t address = copy * mTableUnits * mUnitSize;
+    const size_t size    = tableSize();
+
+    for ( size_t offset = 0; ( offset < size ) && ( result == Status::ERR_OK ); offset += mPageSize )
+    {
+      const size_t chunk = std::min( mPageSize, size - offset );
+
+      for ( size_t x = 0; x < chunk; x++ )
+      {
+        const size_t pos = offset + x;
+        if ( pos < TABLE_HEADER_SIZE )
+        {
+          mScratch[ x ] = header[ pos ];
+        }
+        else
+        {
+          const size_t byte    = ( pos - TABLE_HEADER_SIZE ) % ENTRY_SIZE;
+          const uint32_t entry = encode( ( pos - TABLE_HEADER_SIZE ) / ENTRY_SIZE );
+          mScratch[ x ]        = static_cast<uint8_t>( entry >> ( 8 * byte ) );
+        }
+      }
+
+      result = writeChunk( address + offset, mScratch.data(), chunk );
+    }
+
+    if ( result == Status::ERR_OK )
+    {
+      mActiveCopy = copy;
+      mSequence++;
+      mStats.tableWrites++;
+    }
+
+    return result;
+  }
+
+
+  size_t Allocator::unitAddress( const size_t unit ) const
+  {
+    return unit * mUnitSize;
+  }
+
+
+  size_t Allocator::unitSize() const
+  {
+    return mUnitSize;
+  }
+
+
+  size_t Allocator::numUnits() const
+  {
+    return mNumUnits;
+  }
+
+
+  size_t Allocator::firstUnit() const
+  {
+    return 2 * mTableUnits;
+  }
+
+
+  size_t Allocator::freeUnits() const
+  {
+    return mNumFree;
+  }
+
+
+  bool Allocator::isUsed( const size_t unit ) const
+  {
+    return mOpen && ( unit < mNumUnits ) && ( mEntries[ unit ].state == State::USED );
+  }
+
+
+  uint32_t Allocator::eraseCount( const size_t unit ) const
+  {
+    return ( mOpen && ( unit < mNumUnits ) ) ? mEntries[ unit ].count : 0;
+  }
+
+
+  uint32_t Allocator::minEraseCount() const
+  {
+    uint32_t result = std::numeric_limits<uint32_t>::max();
+    for ( size_t unit = firstUnit(); mOpen && ( unit < mNumUnits ); unit++ )
+    {
+      result = std::min( result, mEntries[ unit ].count );
+    }
+
+    return mOpen ? result : 0;
+  }
+
+
+  uint32_t Allocator::maxEraseCount() const
+  {
+    uint32_t result = 0;
+    for ( size_t unit = firstUnit(); mOpen && ( unit < mNumUnits ); unit++ )
+    {
+      result = std::max( result, mEntries[ unit ].count );
+    }
+
+    return result;
+  }
+
+
+  uint32_t Allocator::tableEraseCount() const
+  {
+    uint32_t result = 0;
+    for ( size_t unit = 0; mOpen && ( unit < firstUnit() ); unit++ )
+    {
+      result = std::max( result, mEntries[ unit ].count );
+    }
+
+    return result;
+  }
+
+
+  Stats Allocator::getStats() const
+  {
+    return mStats;
+  }
+
+
+  void Allocator::clearStats()
+  {
+    memset( &mStats, 0, sizeof( mStats ) );
+  }
+
+
+  size_t Allocator::bucketOf( const uint32_t count ) const
+  {
+    return std::min<size_t>( ( count - mFloor ) / mConfig.bucketSize, NUM_BUCKETS - 1 );
+  }
+
+
+  void Allocator::link( const size_t unit )
+  {
+    auto &entry      = mEntries[ unit ];
+    const bool free  = ( entry.state == State::FREE );
+    const size_t idx = bucketOf( entry.count );
+    auto &list       = free ? mFree[ idx ] : mUsed[ idx ];
+
+    entry.next = INVALID_UNIT;
+    entry.prev = list.tail;
+
+    if ( list.tail != INVALID_UNIT )
+    {
+      mEntries[ list.tail ].next = static_cast<uint16_t>( unit );
+    }
+    else
+    {
+      list.head = static_cast<uint16_t>( unit );
+    }
+
+    list.tail = static_cast<uint16_t>( unit );
+
+    if ( free )
+    {
+      mFreeMask |= ( 1u << idx );
+      mNumFree++;
+    }
+    else
+    {
+      mUsedMask |= ( 1u << idx );
+    }
+  }
+
+
+  void Allocator::unlink( const size_t unit )
+  {
+    auto &entry      = mEntries[ unit ];
+    const bool free  = ( entry.state == State::FREE );
+    const size_t idx = bucketOf( entry.count );
+    auto &list       = free ? mFree[ idx ] : mUsed[ idx ];
+
+    if ( entry.prev != INVALID_UNIT )
+    {
+      mEntries[ entry.prev ].next = entry.next;
+    }
+    else
+    {
+      list.head = entry.next;
+    }
+
+    if ( entry.next != INVALID_UNIT )
+    {
+      mEntries[ entry.next ].prev = entry.prev;
+    }
+    else
+    {
+      list.tail = entry.prev;
+    }
+
+    entry.next = INVALID_UNIT;
+    entry.prev = INVALID_UNIT;
+
+    if ( list.head == INVALID_UNIT )
+    {
+      ( free ? mFreeMask : mUsedMask ) &= ~( 1u << idx );
+    }
+
+    if ( free )
+    {
+      mNumFree--;
+    }
+  }
+
+
+  void Allocator::rebuild()
+  {
+    /*-------------------------------------------------
+    Anchor bucket zero at the least worn unit
+    -------------------------------------------------*/
+    uint32_t least = std::numeric_limits<uint32_t>::max();
+    for ( size_t unit = firstUnit(); unit < mNumUnits; unit++ )
+    {
+      least = std::min( least, mEntries[ unit ].count );
+    }
+
+    mFloor    = least - ( least % mConfig.bucketSize );
+    mFreeMask = 0;
+    mUsedMask = 0;
+    mNumFree  = 0;
+    mFree.fill( { INVALID_UNIT, INVALID_UNIT } );
+    mUsed.fill( { INVALID_UNIT, INVALID_UNIT } );
+
+    for ( size_t unit = firstUnit(); unit < mNumUnits; unit++ )
+    {
+      link( unit );
+    }
+  }
+
+
+  void Allocator::rebase()
+  {
+    /*-------------------------------------------------
+    Once every unit has aged out of bucket zero, slide
+    the buckets up so the top one doesn't fill with
+    units of very different wear.
+    -------------------------------------------------*/
+    const uint32_t occupied = mFreeMask | mUsedMask;
+    if ( occupied && !( occupied & 1u ) )
+    {
+      rebuild();
+    }
+  }
+
+
+  void Allocator::levelColdData()
+  {
+    if ( !mUsedMask || !mFreeMask )
+    {
+      return;
+    }
+
+    /*-------------------------------------------------
+    Longest resident data on the least worn units goes
+    to the most worn free unit, if the gap is enough.
+    -------------------------------------------------*/
+    const size_t cold = mUsed[ __builtin_ctz( mUsedMask ) ].head;
+    const size_t hot  = mFree[ ( NUM_BUCKETS - 1 ) - __builtin_clz( mFreeMask ) ].head;
+
+    if ( ( mEntries[ hot ].count < mEntries[ cold ].count )
+         || ( ( mEntries[ hot ].count - mEntries[ cold ].count ) < mConfig.staticThreshold ) )
+    {
+      return;
+    }
+
+    unlink( hot );
+    unlink( cold );
+
+    if ( moveUnit( cold, hot ) == Status::ERR_OK )
+    {
+      mEntries[ hot ].state  = State::USED;
+      mEntries[ cold ].state = State::FREE;
+      mStats.relocations++;
+      mConfig.relocate( mConfig.relocateContext, cold, hot );
+    }
+
+    link( hot );
+    link( cold );
+  }
+
+
+  void Allocator::format()
+  {
+    for ( size_t unit = 0; unit < mNumUnits; unit++ )
+    {
+      mEntries[ unit ] = { 0, INVALID_UNIT, INVALID_UNIT, State::FREE };
+    }
+
+    mSequence   = 0;
+    mActiveCopy = 1;
+  }
+
+
+  bool Allocator::load( const size_t copy )
+  {
+    const size_t address = copy * mTableUnits * mUnitSize;
+    const size_t size    = tableSize();
+
+    if ( mDevice->read( address, mScratch.data(), TABLE_HEADER_SIZE ) != Status::ERR_OK )
+    {
+      return false;
+    }
+
+    const uint32_t sequence = getWord( &mScratch[ 4 ] );
+    const uint32_t base     = getWord( &mScratch[ 8 ] );
+    const uint32_t expected = getWord( &mScratch[ 16 ] );
+    uint32_t crc            = Stream::crc32Update( 0, mScratch.data(), 16 );
+
+    /*-------------------------------------------------
+    Decode the entries as they stream in. A bad CRC
+    leaves junk behind, but the caller then loads the
+    other copy or formats over it.
+    -------------------------------------------------*/
+    for ( size_t offset = TABLE_HEADER_SIZE; offset < size; offset += mScratch.size() )
+    {
+      const size_t chunk = std::min( mScratch.size(), size - offset );
+      if ( mDevice->read( address + offset, mScratch.data(), chunk ) != Status::ERR_OK )
+      {
+        return false;
+      }
+
+      crc = Stream::crc32Update( crc, mScratch.data(), chunk );
+
+      for ( size_t x = 0; x < chunk; x += ENTRY_SIZE )
+      {
+        const size_t unit    = ( offset - TABLE_HEADER_SIZE + x ) / ENTRY_SIZE;
+        const uint32_t entry = getWord( &mScratch[ x ] );
+
+        mEntries[ unit ].count = base + ( entry & ENTRY_DELTA_MASK );
+        mEntries[ unit ].next  = INVALID_UNIT;
+        mEntries[ unit ].prev  = INVALID_UNIT;
+        mEntries[ unit ].state = ( entry & ENTRY_USED ) ? State::USED : State::FREE;
+      }
+    }
+
+    if ( crc != expected )
+    {
+      return false;
+    }
+
+    mSequence   = sequence;
+    mActiveCopy = copy;
+    return true;
+  }
+
+
+  size_t Allocator::tableSize() const
+  {
+    return TABLE_HEADER_SIZE + ( ENTRY_SIZE * mNumUnits );
+  }
+
+
+  Status Allocator::eraseUnit( const size_t unit )
+  {
+    auto result = mDevice->erase( unitAddress( unit ), mUnitSize );
+    if ( result == Status::ERR_OK )
+    {
+      mEntries[ unit ].count++;
+      result = mDevice->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    return result;
+  }
+
+
+  Status Allocator::writeChunk( const size_t address, const void *const data, const size_t length )
+  {
+    auto result = mDevice->write( address, data, length );
+    if ( result == Status::ERR_OK )
+    {
+      result = mDevice->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    return result;
+  }
+
+
+  Status Allocator::moveUnit( const size_t from, const size_t to )
+  {
+    auto result = eraseUnit( to );
+
+    /*-------------------------------------------------
+    Erased pages are already erased at the destination
+    -------------------------------------------------*/
+    for ( size_t offset = 0; ( offset < mUnitSize ) && ( result == Status::ERR_OK ); offset += mPageSize )
+    {
+      result = mDevice->read( unitAddress( from ) + offset, mScratch.data(), mPageSize );
+      if ( ( result == Status::ERR_OK ) && !isBlank( mScratch.data(), mPageSize ) )
+      {
+        result = writeChunk( unitAddress( to ) + offset, mScratch.data(), mPageSize );
+      }
+    }
+
+    return result;
+  }
+}  // namespace Adesto::Wear
@@ -0,0 +1,213 @@
+/********************************************************************************
+ *  File Name:
+ *    wear.hpp
+ *
+ *  Description:
+ *    Wear aware erase unit allocator. Units are handed out least worn first
+ *    from free lists bucketed by erase count, erase counts are kept in a
+ *    small table persisted at the start of the device, and cold data is
+ *    occasionally moved onto worn units so the units it was sitting on get
+ *    their share of the erase cycles.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_WEAR_HPP
+#define ADESTO_WEAR_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+namespace Adesto::Wear
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t NUM_BUCKETS         = 32; /**< One bit each in the bucket masks */
+  static constexpr size_t SCRATCH_SIZE        = 256;
+  static constexpr uint16_t INVALID_UNIT      = 0xFFFF;
+  static constexpr uint32_t TABLE_MAGIC       = 0x32524557; /**< "WER2", 32-bit entries */
+  static constexpr size_t TABLE_HEADER_SIZE   = 20;
+  static constexpr size_t ENTRY_SIZE          = 4;
+  static constexpr uint32_t ENTRY_USED        = 0x80000000;
+  static constexpr uint32_t ENTRY_DELTA_MASK  = 0x7FFFFFFF;
+  static constexpr size_t DEFAULT_BUCKET_SIZE = 16;
+  static constexpr uint32_t DEFAULT_THRESHOLD = 256;
+  static constexpr size_t DEFAULT_INTERVAL    = 64;
+
+  /*-------------------------------------------------------------------------------
+  Aliases
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Tells the owner of some cold data that it has moved
+   *
+   *  @param[in]  context   User data from the Config
+   *  @param[in]  from      Unit the data used to live in, now free
+   *  @param[in]  to        Unit now holding the data
+   *  @return void
+   */
+  using RelocateFunc = void ( * )( void *context, const size_t from, const size_t to );
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  struct Config
+  {
+    size_t bucketSize;         /**< Erase cycles covered by each free list bucket */
+    uint32_t staticThreshold;  /**< Wear gap between cold data and free units that triggers a move */
+    size_t staticInterval;     /**< Allocations between cold data checks, zero disables */
+    RelocateFunc relocate;     /**< Required for cold data moves, otherwise they are skipped */
+    void *relocateContext;
+  };
+
+  struct Stats
+  {
+    size_t allocations;
+    size_t releases;
+    size_t relocations; /**< Cold data moves */
+    size_t tableWrites;
+  };
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Hands out erase units of a device. The first few units are reserved for
+   *  two copies of the erase count table, written alternately so a reset in
+   *  the middle of sync() always leaves one intact. Erase cycles spent since
+   *  the last sync() are lost on reset, which only ever undercounts.
+   *  The table units themselves aren't leveled. Each copy is erased on every
+   *  other sync(), so they last 2 * endurance syncs whatever the allocation
+   *  pattern, and syncing too often wears them out before the units they track.
+   *
+   *  Allocation and release are O(1). Each bucket is a FIFO, so units of the
+   *  same wear are used round robin. Buckets are relative to the least worn
+   *  unit and get rebuilt as the whole device ages, which costs O(n) once
+   *  every bucketSize erases of every unit.
+   *
+   *  Not thread safe.
+   */
+  class Allocator
+  {
+  public:
+    Allocator( Aurora::Memory::IGenericDevice_sPtr device );
+    ~Allocator();
+
+    /**
+     *  Loads the newest valid table from the device, or starts a fresh one
+     *  with every unit free and unworn if neither copy is valid.
+     *
+     *  @param[in]  config    Allocation policy
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status open( const Config &config );
+
+    /**
+     *  Syncs the table and releases the RAM copy
+     *
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status close();
+
+    /**
+     *  Takes the least worn free unit and erases it, ready for writing
+     *
+     *  @param[out] unit      Erase unit index, see unitAddress()
+     *  @return Aurora::Memory::Status  ERR_FAIL if no units are free
+     */
+    Aurora::Memory::Status allocate( size_t &unit );
+
+    /**
+     *  Returns a unit to the free lists. It is erased when next allocated.
+     *
+     *  @param[in]  unit      Unit from allocate()
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status release( const size_t unit );
+
+    /**
+     *  Writes the table to the device
+     *
+     *  @return Aurora::Memory::Status  ERR_FAIL if a count is too far above the least
+     *                                  worn unit to encode, leaving the last copy in place
+     */
+    Aurora::Memory::Status sync();
+
+    size_t unitAddress( const size_t unit ) const;
+    size_t unitSize() const;
+    size_t numUnits() const;
+    size_t firstUnit() const; /**< Lowest unit that can be allocated */
+    size_t freeUnits() const;
+    bool isUsed( const size_t unit ) const;
+    uint32_t eraseCount( const size_t unit ) const;
+    uint32_t minEraseCount() const;   /**< Over the allocatable units only */
+    uint32_t maxEraseCount() const;   /**< Over the allocatable units only */
+    uint32_t tableEraseCount() const; /**< Most worn of the reserved table units */
+    Stats getStats() const;
+    void clearStats();
+
+  private:
+    enum class State : uint8_t
+    {
+      FREE,
+      USED,
+      RESERVED
+    };
+
+    struct Entry
+    {
+      uint32_t count;
+      uint16_t next;
+      uint16_t prev;
+      State state;
+    };
+
+    struct List
+    {
+      uint16_t head;
+      uint16_t tail;
+    };
+
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Config mConfig;
+    Stats mStats;
+    std::unique_ptr<Entry[]> mEntries;
+    std::array<List, NUM_BUCKETS> mFree;
+    std::array<List, NUM_BUCKETS> mUsed;
+    std::array<uint8_t, SCRATCH_SIZE> mScratch;
+    uint32_t mFreeMask;
+    uint32_t mUsedMask;
+    uint32_t mFloor;    /**< Erase count at the bottom of bucket zero */
+    uint32_t mSequence; /**< Of the newest table on the device */
+    size_t mUnitSize;
+    size_t mPageSize;
+    size_t mNumUnits;
+    size_t mTableUnits; /**< Per copy */
+    size_t mActiveCopy;
+    size_t mSinceCheck;
+    size_t mNumFree;
+    bool mOpen;
+
+    size_t bucketOf( const uint32_t count ) const;
+    void link( const size_t unit );
+    void unlink( const size_t unit );
+    void rebuild();
+    void rebase();
+    void levelColdData();
+    void format();
+    bool load( const size_t copy );
+    size_t tableSize() const;
+    Aurora::Memory::Status eraseUnit( const size_t unit );
+    Aurora::Memory::Status writeChunk( const size_t address, const void *const data, const size_t length );
+    Aurora::Memory::Status moveUnit( const size_t from, const size_t to );
+  };
+}  // namespace Adesto::Wear
+
+#endif /* !ADESTO_WEAR_HPP */
@@ -0,0 +1,496 @@
+/********************************************************************************
+ *  File Name:
+ *    workload.cpp
+ *
+ *  Description:
+ *    Workload engine implementation. Everything here is platform agnostic,
+ *    worker scheduling lives in workload_threads.cpp.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <new>
+
+/* Adesto Includes */
+#include <src/workload/workload.hpp>
+
+namespace Adesto::Workload
+{
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t PEND_FOREVER = std::numeric_limits<size_t>::max();
+  static constexpr size_t LINE_SIZE    = 192;
+
+  /*-------------------------------------------------------------------------------
+  Private Structures
+  -------------------------------------------------------------------------------*/
+  struct Runner::Worker
+  {
+    uint32_t rng;                      /**< xorshift32 state, never zero */
+    size_t cursor;                     /**< Next item for sequential patterns */
+    size_t sliceStart;                 /**< First item owned for sequential patterns */
+    size_t sliceItems;                 /**< Items owned for sequential patterns */
+    std::unique_ptr<uint8_t[]> buffer; /**< Request data, requestMax bytes */
+    std::array<OpStats, static_cast<size_t>( OpType::NUM_OPTIONS )> ops;
+
+    uint32_t next()
+    {
+      rng ^= rng << 13;
+      rng ^= rng >> 17;
+      rng ^= rng << 5;
+      return rng;
+    }
+
+    double uniform()
+    {
+      return static_cast<double>( next() >> 8 ) * ( 1.0 / 16777216.0 );
+    }
+  };
+
+  /**
+   *  Zipf generator from Gray et al, "Quickly Generating Billion-Record
+   *  Synthetic Databases". Setup is O(n), each sample is O(1).
+   */
+  struct Runner::Zipf
+  {
+    size_t items;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+    double halfPowTheta;
+
+    void init( const size_t n, const double skew )
+    {
+      items = n;
+      theta = skew;
+      zetan = 0.0;
+
+      for ( size_t x = 1; x <= n; x++ )
+      {
+        zetan += 1.0 / std::pow( static_cast<double>( x ), theta );
+      }
+
+      const double zeta2 = 1.0 + ( 1.0 / std::pow( 2.0, theta ) );
+      alpha              = 1.0 / ( 1.0 - theta );
+      eta                = ( 1.0 - std::pow( 2.0 / static_cast<double>( n ), 1.0 - theta ) ) / ( 1.0 - ( zeta2 / zetan ) );
+      halfPowTheta       = std::pow( 0.5, theta );
+    }
+
+    size_t sample( const double u ) const
+    {
+      const double uz = u * zetan;
+
+      if ( uz < 1.0 )
+      {
+        return 0;
+      }
+      else if ( uz < ( 1.0 + halfPowTheta ) )
+      {
+        return 1;
+      }
+
+      const size_t item = static_cast<size_t>( static_cast<double>( items ) * std::pow( ( eta * u ) - eta + 1.0, alpha ) );
+      return std::min( item, items - 1 );
+    }
+  };
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static const char *opName( const size_t op )
+  {
+    static const char *names[] = { "read", "write", "erase" };
+    return ( op < std::size( names ) ) ? names[ op ] : "?";
+  }
+
+
+  static uint64_t perSecond( const uint64_t amount, const uint64_t elapsedUs )
+  {
+    return elapsedUs ? ( amount * 1000000u ) / elapsedUs : 0;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Result Implementation
+  -------------------------------------------------------------------------------*/
+  void Result::clear()
+  {
+    for ( auto &op : ops )
+    {
+      op.latency.clear();
+      op.bytes  = 0;
+      op.errors = 0;
+    }
+
+    elapsedUs = 0;
+    workers   = 0;
+  }
+
+
+  uint64_t Result::totalOps() const
+  {
+    uint64_t total = 0;
+    for ( auto &op : ops )
+    {
+      total += op.latency.count();
+    }
+
+    return total;
+  }
+
+
+  uint64_t Result::totalBytes() const
+  {
+    uint64_t total = 0;
+    for ( auto &op : ops )
+    {
+      total += op.bytes;
+    }
+
+    return total;
+  }
+
+
+  size_t Result::totalErrors() const
+  {
+    size_t total = 0;
+    for ( auto &op : ops )
+    {
+      total += op.errors;
+    }
+
+    return total;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Runner Implementation
+  -------------------------------------------------------------------------------*/
+  Runner::Runner( IGenericDevice_sPtr device, ClockFunc clock, void *clockContext ) :
+      mDevice( device ), mClock( clock ), mClockContext( clockContext ), mNumWorkers( 0 ), mEraseSize( 0 ), mIssued( 0 ),
+      mStart( 0 ), mEnd( 0 )
+  {
+    mProps = mDevice->getDeviceProperties();
+    memset( &mJob, 0, sizeof( mJob ) );
+  }
+
+
+  Runner::~Runner()
+  {
+    release();
+  }
+
+
+  Status Runner::prepare( const Job &job )
+  {
+    release();
+
+    /*-------------------------------------------------
+    Resolve defaults and check the job is sane
+    -------------------------------------------------*/
+    const size_t deviceSize = mProps.pageSize * mProps.numPages;
+    mJob                    = job;
+    mEraseSize              = chunkSize( mProps, mProps.eraseChunk );
+
+    if ( !mJob.regionSize && ( mJob.regionStart < deviceSize ) )
+    {
+      mJob.regionSize = deviceSize - mJob.regionStart;
+    }
+
+    const bool hasErase = ( mJob.readPercent + mJob.writePercent ) < 100;
+    const size_t items  = mJob.requestMin ? mJob.regionSize / mJob.requestMin : 0;
+    mNumWorkers         = std::max<size_t>( mJob.threads, 1 ) * std::max<size_t>( mJob.queueDepth, 1 );
+
+    if ( !mClock || !items || ( mJob.requestMax < mJob.requestMin ) || ( mJob.requestMax % mJob.requestMin )
+         || ( ( mJob.readPercent + mJob.writePercent ) > 100 ) || ( ( mJob.regionStart + mJob.regionSize ) > deviceSize )
+         || ( !mJob.durationUs && !mJob.maxOps ) || ( mNumWorkers > MAX_WORKERS ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( hasErase && ( !mEraseSize || ( mJob.regionStart % mEraseSize ) || ( mJob.regionSize % mEraseSize ) ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( ( mJob.pattern == Pattern::RANDOM ) && ( mJob.distribution == Distribution::ZIPF ) )
+    {
+      if ( ( items > MAX_ZIPF_ITEMS ) || ( mJob.zipfTheta <= 0.0f ) || ( mJob.zipfTheta >= 1.0f ) )
+      {
+        return Status::ERR_BAD_ARG;
+      }
+
+      mZipf.reset( new ( std::nothrow ) Zipf() );
+      if ( !mZipf )
+      {
+        return Status::ERR_FAIL;
+      }
+
+      mZipf->init( items, mJob.zipfTheta );
+    }
+
+    /*-------------------------------------------------
+    Allocate the workers. Sequential jobs give each one
+    its own slice of the region, like fio's
+    offset_increment, so they don't trample each other.
+    -------------------------------------------------*/
+    mWorkers.reset( new ( std::nothrow ) Worker[ mNumWorkers ] );
+    if ( !mWorkers )
+    {
+      release();
+      return Status::ERR_FAIL;
+    }
+
+    const size_t sliceItems = std::max<size_t>( items / mNumWorkers, 1 );
+
+    for ( size_t x = 0; x < mNumWorkers; x++ )
+    {
+      auto &worker = mWorkers[ x ];
+      worker.rng   = ( mJob.seed ^ ( 0x9E3779B9u * ( x + 1 ) ) ) | 1u;
+      worker.buffer.reset( new ( std::nothrow ) uint8_t[ mJob.requestMax ] );
+
+      if ( !worker.buffer )
+      {
+        release();
+        return Status::ERR_FAIL;
+      }
+
+      for ( size_t byte = 0; byte < mJob.requestMax; byte++ )
+      {
+        worker.buffer[ byte ] = static_cast<uint8_t>( worker.next() );
+      }
+
+      worker.sliceStart = std::min( x * sliceItems, items - 1 );
+      worker.sliceItems = std::min( sliceItems, items - worker.sliceStart );
+      worker.cursor     = 0;
+
+      for ( auto &op : worker.ops )
+      {
+        op.latency.clear();
+        op.bytes  = 0;
+        op.errors = 0;
+      }
+    }
+
+    mIssued = 0;
+    mStart  = mClock( mClockContext );
+    mEnd    = mStart;
+    return Status::ERR_OK;
+  }
+
+
+  size_t Runner::numWorkers() const
+  {
+    return mNumWorkers;
+  }
+
+
+  void Runner::runWorker( const size_t idx )
+  {
+    if ( !mWorkers || ( idx >= mNumWorkers ) )
+    {
+      return;
+    }
+
+    auto &worker           = mWorkers[ idx ];
+    const size_t items     = mJob.regionSize / mJob.requestMin;
+    const size_t sizeStep  = mJob.requestMax / mJob.requestMin;
+    const size_t regionEnd = mJob.regionStart + mJob.regionSize;
+
+    while ( true )
+    {
+      /*-------------------------------------------------
+      Check the limits
+      -------------------------------------------------*/
+      if ( mJob.maxOps && ( mIssued.fetch_add( 1 ) >= mJob.maxOps ) )
+      {
+        break;
+      }
+
+      const uint64_t opStart = mClock( mClockContext );
+      if ( mJob.durationUs && ( ( opStart - mStart ) >= mJob.durationUs ) )
+      {
+        break;
+      }
+
+      /*-------------------------------------------------
+      Pick the operation, its size, and where it goes
+      -------------------------------------------------*/
+      const uint32_t roll = worker.next() % 100;
+      OpType op           = OpType::ERASE;
+
+      if ( roll < mJob.readPercent )
+      {
+        op = OpType::READ;
+      }
+      else if ( roll < ( mJob.readPercent + mJob.writePercent ) )
+      {
+        op = OpType::WRITE;
+      }
+
+      const size_t span = 1 + ( ( sizeStep > 1 ) ? ( worker.next() % sizeStep ) : 0 );
+      size_t item       = 0;
+
+      if ( mJob.pattern == Pattern::SEQUENTIAL )
+      {
+        item = worker.sliceStart + worker.cursor;
+        worker.cursor += span;
+        if ( worker.cursor >= worker.sliceItems )
+        {
+          worker.cursor = 0;
+        }
+      }
+      else if ( mZipf )
+      {
+        item = mZipf->sample( worker.uniform() );
+      }
+      else
+      {
+        item = worker.next() % items;
+      }
+
+      size_t address = mJob.regionStart + ( item * mJob.requestMin );
+      size_t length  = std::min( span * mJob.requestMin, regionEnd - address );
+
+      if ( op == OpType::ERASE )
+      {
+        address -= ( address % mEraseSize );
+        length = mEraseSize;
+      }
+
+      /*-------------------------------------------------
+      Issue it and wait for completion. Holding the lock
+      across both keeps other workers from interleaving
+      commands or consuming this request's event.
+      -------------------------------------------------*/
+      auto result = Status::ERR_OK;
+      mDeviceLock.lock();
+
+      switch ( op )
+      {
+        case OpType::READ:
+          result = mDevice->read( address, worker.buffer.get(), length );
+          break;
+
+        case OpType::WRITE:
+          result = mDevice->write( address, worker.buffer.get(), length );
+          if ( result == Status::ERR_OK )
+          {
+            result = mDevice->pendEvent( Event::MEM_WRITE_COMPLETE, PEND_FOREVER );
+          }
+          break;
+
+        case OpType::ERASE:
+        default:
+          result = mDevice->erase( address, length );
+          if ( result == Status::ERR_OK )
+          {
+            result = mDevice->pendEvent( Event::MEM_ERASE_COMPLETE, PEND_FOREVER );
+          }
+          break;
+      }
+
+      mDeviceLock.unlock();
+      const uint64_t latency = mClock( mClockContext ) - opStart;
+      auto &stats            = worker.ops[ static_cast<size_t>( op ) ];
+
+      stats.latency.record( static_cast<uint32_t>( std::min<uint64_t>( latency, std::numeric_limits<uint32_t>::max() ) ) );
+      stats.bytes += length;
+
+      if ( result != Status::ERR_OK )
+      {
+        stats.errors++;
+      }
+    }
+  }
+
+
+  void Runner::collect( Result &result )
+  {
+    result.clear();
+
+    mEnd             = mClock( mClockContext );
+    result.elapsedUs = mEnd - mStart;
+    result.workers   = mNumWorkers;
+
+    if ( !mWorkers )
+    {
+      return;
+    }
+
+    for ( size_t x = 0; x < mNumWorkers; x++ )
+    {
+      for ( size_t op = 0; op < result.ops.size(); op++ )
+      {
+        result.ops[ op ].latency.merge( mWorkers[ x ].ops[ op ].latency );
+        result.ops[ op ].bytes += mWorkers[ x ].ops[ op ].bytes;
+        result.ops[ op ].errors += mWorkers[ x ].ops[ op ].errors;
+      }
+    }
+  }
+
+
+  void Runner::release()
+  {
+    mWorkers.reset();
+    mZipf.reset();
+    mNumWorkers = 0;
+  }
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  void report( const Job &job, const Result &result, EmitFunc emit )
+  {
+    /*-------------------------------------------------
+    Integer math only, printf float support is often
+    stripped out of the target's libc.
+    -------------------------------------------------*/
+    char line[ LINE_SIZE ];
+    const unsigned erasePct = 100u - job.readPercent - job.writePercent;
+
+    snprintf( line, sizeof( line ), "%s: workers=%u rw=%u/%u/%u pattern=%s/%s bs=%u-%u", job.name,
+              static_cast<unsigned>( result.workers ), job.readPercent, job.writePercent, erasePct,
+              ( job.pattern == Pattern::SEQUENTIAL ) ? "seq" : "rand",
+              ( job.distribution == Distribution::ZIPF ) ? "zipf" : "uniform", static_cast<unsigned>( job.requestMin ),
+              static_cast<unsigned>( job.requestMax ) );
+    emit( line );
+
+    snprintf( line, sizeof( line ), "  elapsed=%lums iops=%lu bw=%luKiB/s errors=%u",
+              static_cast<unsigned long>( result.elapsedUs / 1000u ),
+              static_cast<unsigned long>( perSecond( result.totalOps(), result.elapsedUs ) ),
+              static_cast<unsigned long>( perSecond( result.totalBytes(), result.elapsedUs ) / 1024u ),
+              static_cast<unsigned>( result.totalErrors() ) );
+    emit( line );
+
+    for ( size_t op = 0; op < result.ops.size(); op++ )
+    {
+      auto &stats = result.ops[ op ];
+      if ( !stats.latency.count() )
+      {
+        continue;
+      }
+
+      snprintf( line, sizeof( line ),
+                "  %-5s ios=%lu bw=%luKiB/s lat(us) min=%lu avg=%lu p50=%lu p90=%lu p99=%lu p99.9=%lu max=%lu", opName( op ),
+                static_cast<unsigned long>( stats.latency.count() ),
+                static_cast<unsigned long>( perSecond( stats.bytes, result.elapsedUs ) / 1024u ),
+                static_cast<unsigned long>( stats.latency.min() ),
+                static_cast<unsigned long>( stats.latency.total() / stats.latency.count() ),
+                static_cast<unsigned long>( stats.latency.percentile( 0.50 ) ),
+                static_cast<unsigned long>( stats.latency.percentile( 0.90 ) ),
+                static_cast<unsigned long>( stats.latency.percentile( 0.99 ) ),
+                static_cast<unsigned long>( stats.latency.percentile( 0.999 ) ),
+                static_cast<unsigned long>( stats.latency.max() ) );
+      emit( line );
+    }
+  }
+}  // namespace Adesto::Workload
@@ -0,0 +1,245 @@
+/********************************************************************************
+ *  File Name:
+ *    workload.hpp
+ *
+ *  Description:
+ *    Synthetic workload engine for generic memory devices. Jobs are plain
+ *    data describing an access pattern, so the same definitions run on the
+ *    target under FreeRTOS and on the host against the simulator.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+#pragma once
+#ifndef ADESTO_WORKLOAD_HPP
+#define ADESTO_WORKLOAD_HPP
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/common/clock.hpp>
+#include <src/common/latency_histogram.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/thread>
+#else
+/* STL Includes */
+#include <mutex>
+#endif
+
+namespace Adesto::Workload
+{
+  /*-------------------------------------------------------------------------------
+  Constants
+  -------------------------------------------------------------------------------*/
+  static constexpr size_t MAX_WORKERS     = 8;        /**< Upper limit of threads * queueDepth */
+  static constexpr size_t WORKER_STACK_KB = 2;        /**< Stack given to each worker task on target */
+  static constexpr size_t MAX_ZIPF_ITEMS  = 1u << 20; /**< Largest address space a Zipf job may span */
+
+  /*-------------------------------------------------------------------------------
+  Enumerations
+  -------------------------------------------------------------------------------*/
+  enum class Pattern : uint8_t
+  {
+    SEQUENTIAL,
+    RANDOM,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  enum class Distribution : uint8_t
+  {
+    UNIFORM,
+    ZIPF, /**< Low addresses are hot, skew set by Job::zipfTheta */
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  enum class OpType : uint8_t
+  {
+    READ,
+    WRITE,
+    ERASE,
+
+    NUM_OPTIONS,
+    UNKNOWN
+  };
+
+  /*-------------------------------------------------------------------------------
+  Structures
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Declarative description of a workload. Zero values for the region and the
+   *  limits mean "whole device" and "unlimited" respectively, though at least
+   *  one of durationUs or maxOps must be set.
+   */
+  struct Job
+  {
+    const char *name;
+    uint8_t readPercent;       /**< Share of operations that are reads */
+    uint8_t writePercent;      /**< Share of operations that are writes, remainder are erases */
+    Pattern pattern;           /**< How addresses advance */
+    Distribution distribution; /**< Address distribution for random patterns */
+    float zipfTheta;           /**< Skew in (0, 1), larger is more skewed */
+    size_t regionStart;        /**< First byte the job may touch */
+    size_t regionSize;         /**< Bytes the job may touch, zero for the rest of the device */
+    size_t requestMin;         /**< Smallest request in bytes, also the address alignment */
+    size_t requestMax;         /**< Largest request in bytes, multiple of requestMin */
+    size_t threads;            /**< Independent workers */
+    size_t queueDepth;         /**< Workers per thread sharing the device lock, see Runner */
+    uint64_t durationUs;       /**< How long to run, measured on the job clock */
+    size_t maxOps;             /**< Stop after this many operations across all workers */
+    uint32_t seed;             /**< Makes random runs repeatable */
+  };
+
+  struct OpStats
+  {
+    LatencyHistogram latency;
+    uint64_t bytes;
+    size_t errors;
+  };
+
+  struct Result
+  {
+    std::array<OpStats, static_cast<size_t>( OpType::NUM_OPTIONS )> ops;
+    uint64_t elapsedUs;
+    size_t workers;
+
+    void clear();
+    uint64_t totalOps() const;
+    uint64_t totalBytes() const;
+    size_t totalErrors() const;
+  };
+
+  /**
+   *  Receives one line of report text at a time, without a trailing newline
+   */
+  using EmitFunc = void ( * )( const char *const line );
+
+  /*-------------------------------------------------------------------------------
+  Classes
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Executes a single job. The runner owns all per worker state, while the
+   *  platform layer (see run()) decides how workers get scheduled.
+   *
+   *  Generic devices complete one request at a time and signal it through a
+   *  shared event, so workers take turns on the device: each holds it from
+   *  issuing a request until its completion has been collected. queueDepth
+   *  therefore doesn't model a device queue. It only adds workers, and all
+   *  threads * queueDepth of them contend for one lock. IOPS don't scale past
+   *  a single worker, and with more than one the latency percentiles are
+   *  mostly time spent waiting on that lock.
+   */
+  class Runner
+  {
+  public:
+    Runner( Aurora::Memory::IGenericDevice_sPtr device, ClockFunc clock, void *clockContext );
+    ~Runner();
+
+    /**
+     *  Validates a job against the device and allocates worker resources
+     *
+     *  @param[in]  job       Job to prepare
+     *  @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status prepare( const Job &job );
+
+    /**
+     *  Number of workers the prepared job needs (threads * queueDepth)
+     *
+     *  @return size_t
+     */
+    size_t numWorkers() const;
+
+    /**
+     *  Body of one worker. Returns once the job's limits have been reached.
+     *  Safe to call concurrently with different indices.
+     *
+     *  @param[in]  worker    Worker index, less than numWorkers()
+     *  @return void
+     */
+    void runWorker( const size_t worker );
+
+    /**
+     *  Merges the per worker statistics. Call after every worker has returned.
+     *
+     *  @param[out] result    Merged statistics
+     *  @return void
+     */
+    void collect( Result &result );
+
+  private:
+    struct Worker;
+    struct Zipf;
+
+    Aurora::Memory::IGenericDevice_sPtr mDevice;
+    Aurora::Memory::Properties mProps;
+    ClockFunc mClock;
+    void *mClockContext;
+    Job mJob;
+    size_t mNumWorkers;
+    size_t mEraseSize;
+    std::unique_ptr<Worker[]> mWorkers;
+    std::unique_ptr<Zipf> mZipf;
+    std::atomic<size_t> mIssued;
+    uint64_t mStart;
+    uint64_t mEnd;
+
+#if defined( EMBEDDED )
+    Chimera::Threading::Mutex mDeviceLock;
+#else
+    std::mutex mDeviceLock;
+#endif
+
+    void release();
+  };
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  /**
+   *  Runs a job to completion, spreading the workers across RTOS tasks on the
+   *  target or std::threads on the host. Blocks the caller until done.
+   *
+   *  @param[in]  job           Job to run
+   *  @param[in]  device        Device under test
+   *  @param[in]  clock         Time source for latency and duration
+   *  @param[in]  clockContext  Passed through to the clock
+   *  @param[out] result        Collected statistics
+   *  @return Aurora::Memory::Status
+   */
+  Aurora::Memory::Status run( const Job &job, Aurora::Memory::IGenericDevice_sPtr device, ClockFunc clock,
+                              void *clockContext, Result &result );
+
+  /**
+   *  Formats a fio style summary of a job result
+   *
+   *  @param[in]  job       Job that was run
+   *  @param[in]  result    Its results
+   *  @param[in]  emit      Called once per line of output
+   *  @return void
+   */
+  void report( const Job &job, const Result &result, EmitFunc emit );
+
+  /**
+   *  Library of stock jobs shared between the target and host runners
+   *
+   *  @param[out] count     Number of jobs in the returned array
+   *  @return const Job*
+   */
+  const Job *standardJobs( size_t &count );
+}  // namespace Adesto::Workload
+
+#endif /* !ADESTO_WORKLOAD_HPP */
@@ -0,0 +1,45 @@
+/********************************************************************************
+ *  File Name:
+ *    workload_jobs.cpp
+ *
+ *  Description:
+ *    Stock job definitions. These are intentionally short so they fit inside
+ *    a HIL test run, and bounded by operation count so that results from the
+ *    simulator and real hardware cover the same amount of work. Each uses a
+ *    single worker so the latencies are device time, not queueing delay.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <iterator>
+
+/* Adesto Includes */
+#include <src/workload/workload.hpp>
+
+namespace Adesto::Workload
+{
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  /* clang-format off */
+  static const Job sStandardJobs[] = {
+    /* name          rd   wr   pattern              distribution           theta  start  size       min   max   thr  qd  duration  ops    seed */
+    { "seq-read",    100, 0,   Pattern::SEQUENTIAL, Distribution::UNIFORM, 0.0f,  0,     0,         256,  256,  1,   1,  0,        2048,  1 },
+    { "rand-read",   100, 0,   Pattern::RANDOM,     Distribution::UNIFORM, 0.0f,  0,     0,         256,  256,  1,   1,  0,        2048,  2 },
+    { "zipf-read",   100, 0,   Pattern::RANDOM,     Distribution::ZIPF,    0.99f, 0,     0,         256,  256,  1,   1,  0,        2048,  3 },
+    { "seq-write",   0,   100, Pattern::SEQUENTIAL, Distribution::UNIFORM, 0.0f,  0,     64 * 1024, 256,  256,  1,   1,  0,        256,   4 },
+    { "mixed-70-30", 70,  30,  Pattern::RANDOM,     Distribution::ZIPF,    0.9f,  0,     64 * 1024, 256,  1024, 1,   1,  0,        1024,  5 },
+    { "write-erase", 0,   90,  Pattern::RANDOM,     Distribution::UNIFORM, 0.0f,  0,     64 * 1024, 256,  256,  1,   1,  0,        512,   6 },
+  };
+  /* clang-format on */
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  const Job *standardJobs( size_t &count )
+  {
+    count = std::size( sStandardJobs );
+    return sStandardJobs;
+  }
+}  // namespace Adesto::Workload
@@ -0,0 +1,131 @@
+/********************************************************************************
+ *  File Name:
+ *    workload_threads.cpp
+ *
+ *  Description:
+ *    Schedules workload workers onto the platform's threads. Workers are RTOS
+ *    tasks on the target and std::threads everywhere else, created for one run
+ *    and gone once it finishes.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+
+/* Adesto Includes */
+#include <src/workload/workload.hpp>
+
+#if defined( EMBEDDED )
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#else
+/* STL Includes */
+#include <thread>
+#endif
+
+namespace Adesto::Workload
+{
+  using namespace Aurora::Memory;
+
+#if defined( EMBEDDED )
+  /*-------------------------------------------------------------------------------
+  Static Data
+  -------------------------------------------------------------------------------*/
+  /*-------------------------------------------------
+  Tasks only live for the length of a run, so their
+  stacks go back to the RTOS heap between jobs.
+  -------------------------------------------------*/
+  static std::array<Chimera::Threading::Thread, MAX_WORKERS> sThreads;
+  static Chimera::Threading::BinarySemaphore sDone;
+  static Runner *sRunner               = nullptr;
+  static size_t sActive                = 0;
+  static std::atomic<size_t> sFinished = 0;
+
+  /*-------------------------------------------------------------------------------
+  Static Functions
+  -------------------------------------------------------------------------------*/
+  static void workerTask( void *arg )
+  {
+    sRunner->runWorker( reinterpret_cast<size_t>( arg ) );
+
+    /*-------------------------------------------------
+    The last one out wakes run()
+    -------------------------------------------------*/
+    if ( ( sFinished.fetch_add( 1 ) + 1 ) == sActive )
+    {
+      sDone.release();
+    }
+
+    vTaskDelete( nullptr );
+  }
+#endif  /* EMBEDDED */
+
+  /*-------------------------------------------------------------------------------
+  Public Functions
+  -------------------------------------------------------------------------------*/
+  Status run( const Job &job, IGenericDevice_sPtr device, ClockFunc clock, void *clockContext, Result &result )
+  {
+    result.clear();
+
+    if ( !device )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    Runner runner( device, clock, clockContext );
+    const auto prepared = runner.prepare( job );
+    if ( prepared != Status::ERR_OK )
+    {
+      return prepared;
+    }
+
+    /*-------------------------------------------------
+    A single worker doesn't need a thread of its own
+    -------------------------------------------------*/
+    const size_t workers = runner.numWorkers();
+
+    if ( workers == 1 )
+    {
+      runner.runWorker( 0 );
+    }
+    else
+    {
+#if defined( EMBEDDED )
+      using namespace Chimera::Threading;
+
+      sRunner   = &runner;
+      sActive   = workers;
+      sFinished = 0;
+
+      for ( size_t x = 0; x < workers; x++ )
+      {
+        sThreads[ x ].initialize( workerTask, reinterpret_cast<void *>( x ), Priority::LEVEL_2,
+                                  STACK_KILOBYTES( WORKER_STACK_KB ), "wkld" );
+        sThreads[ x ].start();
+      }
+
+      sDone.acquire();
+#else
+      std::array<std::thread, MAX_WORKERS> threads;
+      for ( size_t x = 0; x < workers; x++ )
+      {
+        threads[ x ] = std::thread( [ &runner, x ]() { runner.runWorker( x ); } );
+      }
+
+      for ( size_t x = 0; x < workers; x++ )
+      {
+        threads[ x ].join();
+      }
+#endif  /* EMBEDDED */
+    }
+
+    runner.collect( result );
+    return result.totalErrors() ? Status::ERR_FAIL : Status::ERR_OK;
+  }
+}  // namespace Adesto::Workload
@@ -0,0 +1,116 @@
+/********************************************************************************
+ *  File Name:
+ *    test_async.cpp
+ *
+ *  Description:
+ *    Common test for the coroutine device interface
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <cstring>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/async/async.hpp>
+
+/* Test Driver Includes */
+#include <tests/common/test_common_resources.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Constants
+-------------------------------------------------------------------------------*/
+static constexpr size_t NUM_JOBS = 4;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+/**
+ *  Erases a block, fills part of it with a pattern and reads it back
+ */
+static Adesto::Async::Task eraseWriteVerify( Adesto::Async::Executor &exec, const size_t address, const size_t length,
+                                             const uint8_t seed, size_t &failures )
+{
+  using namespace Aurora::Memory;
+
+  std::array<uint8_t, 256> tx;
+  std::array<uint8_t, 256> rx;
+
+  for ( size_t x = 0; x < tx.size(); x++ )
+  {
+    tx[ x ] = static_cast<uint8_t>( seed + x );
+  }
+
+  if ( ( co_await exec.erase( address, length ) ) != Status::ERR_OK )
+  {
+    failures++;
+    co_return;
+  }
+
+  if ( ( co_await exec.write( address, tx.data(), tx.size() ) ) != Status::ERR_OK )
+  {
+    failures++;
+    co_return;
+  }
+
+  if ( ( ( co_await exec.read( address, rx.data(), rx.size() ) ) != Status::ERR_OK )
+       || ( memcmp( tx.data(), rx.data(), tx.size() ) != 0 ) )
+  {
+    failures++;
+  }
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Async ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Async, ConcurrentJobsOnOneTask )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = getDUT();
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props        = dut->getDeviceProperties();
+  size_t chunk_size = chunkSize( props, props.eraseChunk );
+  size_t failures   = 0;
+
+  Adesto::Async::Executor exec( dut );
+
+  /*-------------------------------------------------
+  Call FUT: Each job owns a different erase unit
+  -------------------------------------------------*/
+  for ( size_t x = 0; x < NUM_JOBS; x++ )
+  {
+    const size_t address = chunkStartAddress( props, props.eraseChunk, x + 1 );
+    CHECK( exec.spawn( eraseWriteVerify( exec, address, chunk_size, static_cast<uint8_t>( x * 17 ), failures ) )
+           == Status::ERR_OK );
+  }
+
+  CHECK_EQUAL( NUM_JOBS, exec.active() );
+  exec.run();
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK_EQUAL( 0, exec.active() );
+  CHECK_EQUAL( 0, failures );
+
+  dut->close();
+}
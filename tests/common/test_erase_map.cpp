@@ -0,0 +1,228 @@
+/********************************************************************************
+ *  File Name:
+ *    test_erase_map.cpp
+ *
+ *  Description:
+ *    Common test for the erase state tracking decorator
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstring>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/erase_map/erase_map.hpp>
+
+/* Test Driver Includes */
+#include <tests/common/test_common_resources.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( EraseMap ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( EraseMap, SkipsKnownCleanUnits )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = std::make_shared<Adesto::EraseMap::Device>( getDUT() );
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props           = dut->getDeviceProperties();
+  const size_t unit    = 3;
+  size_t chunk_address = chunkStartAddress( props, props.eraseChunk, unit );
+  size_t chunk_size    = chunkSize( props, props.eraseChunk );
+
+  /*-------------------------------------------------
+  Call FUT: First erase must hit the device, the
+  second is redundant and must be filtered.
+  -------------------------------------------------*/
+  CHECK( dut->erase( chunk_address, chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+  dut->clearStats();
+
+  CHECK( dut->erase( chunk_address, chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  auto stats = dut->getStats();
+  CHECK( stats.erasesRequested == 1 );
+  CHECK( stats.erasesSkipped == 1 );
+  CHECK( stats.erasesIssued == 0 );
+
+  dut->close();
+}
+
+
+TEST( EraseMap, WriteDirtiesUnit )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = std::make_shared<Adesto::EraseMap::Device>( getDUT() );
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props           = dut->getDeviceProperties();
+  const size_t unit    = 4;
+  size_t chunk_address = chunkStartAddress( props, props.eraseChunk, unit );
+  size_t chunk_size    = chunkSize( props, props.eraseChunk );
+
+  writeBuffer.fill( 0xA5 );
+  dut->erase( chunk_address, chunk_size );
+  dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  dut->write( chunk_address, writeBuffer.data(), props.pageSize );
+  dut->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  dut->clearStats();
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  CHECK( dut->erase( chunk_address, chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify:
+    - The dirty unit was really erased
+    - No blank check was needed, the map knew the unit
+      was dirty
+  -------------------------------------------------*/
+  auto stats = dut->getStats();
+  CHECK( stats.erasesIssued == 1 );
+  CHECK( stats.blankChecks == 0 );
+
+  readBuffer.fill( 0x00 );
+  CHECK( dut->read( chunk_address, readBuffer.data(), props.pageSize ) == Status::ERR_OK );
+  for ( size_t x = 0; x < props.pageSize; x++ )
+  {
+    if ( readBuffer[ x ] != 0xFF )
+    {
+      FAIL( "Chunk not erased" );
+    }
+  }
+
+  dut->close();
+}
+
+
+TEST( EraseMap, EraseAfterEraseChipIsNoOp )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = std::make_shared<Adesto::EraseMap::Device>( getDUT() );
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props           = dut->getDeviceProperties();
+  const size_t unit    = 5;
+  size_t chunk_address = chunkStartAddress( props, props.eraseChunk, unit );
+  size_t chunk_size    = chunkSize( props, props.eraseChunk );
+
+  CHECK( dut->eraseChip() == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+  CHECK( dut->getStats().erasesIssued == 1 );
+  dut->clearStats();
+
+  /*-------------------------------------------------
+  Call FUT: Both address and chunk forms are filtered
+  -------------------------------------------------*/
+  CHECK( dut->erase( chunk_address, chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+  CHECK( dut->erase( props.eraseChunk, unit + 1 ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  auto stats = dut->getStats();
+  CHECK( stats.erasesRequested == 2 );
+  CHECK( stats.erasesSkipped == 2 );
+  CHECK( stats.erasesIssued == 0 );
+  CHECK( stats.blankChecks == 0 );
+
+  dut->close();
+}
+
+
+TEST( EraseMap, BlankCheckSeedsMap )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Put one unit in each state behind the
+  decorator's back, so the fresh map knows neither.
+  -------------------------------------------------*/
+  auto raw             = getDUT();
+  auto props           = raw->getDeviceProperties();
+  const size_t clean   = 6;
+  const size_t dirty   = 7;
+  size_t clean_address = chunkStartAddress( props, props.eraseChunk, clean );
+  size_t dirty_address = chunkStartAddress( props, props.eraseChunk, dirty );
+  size_t chunk_size    = chunkSize( props, props.eraseChunk );
+
+  CHECK( raw->open() == Status::ERR_OK );
+  CHECK( raw->erase( clean_address, 2 * chunk_size ) == Status::ERR_OK );
+  CHECK( raw->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  writeBuffer.fill( 0x5A );
+  CHECK( raw->write( dirty_address + props.pageSize, writeBuffer.data(), props.pageSize ) == Status::ERR_OK );
+  CHECK( raw->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+  raw->close();
+
+  auto dut = std::make_shared<Adesto::EraseMap::Device>( raw );
+  CHECK( dut->open() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Call FUT: The blank check finds the clean unit and
+  lets the dirty one through
+  -------------------------------------------------*/
+  CHECK( dut->erase( clean_address, 2 * chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  auto stats = dut->getStats();
+  CHECK( stats.erasesRequested == 2 );
+  CHECK( stats.blankChecks == 2 );
+  CHECK( stats.erasesSkipped == 1 );
+  CHECK( stats.erasesIssued == 1 );
+
+  /*-------------------------------------------------
+  Verify: Both units are now seeded, so repeating the
+  erase needs neither reads nor erases
+  -------------------------------------------------*/
+  dut->clearStats();
+  CHECK( dut->erase( clean_address, 2 * chunk_size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  stats = dut->getStats();
+  CHECK( stats.erasesSkipped == 2 );
+  CHECK( stats.erasesIssued == 0 );
+  CHECK( stats.blankChecks == 0 );
+
+  dut->close();
+}
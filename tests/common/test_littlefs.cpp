@@ -0,0 +1,131 @@
+/********************************************************************************
+ *  File Name:
+ *    test_littlefs.cpp
+ *
+ *  Description:
+ *    Common test for the littlefs block device adapter and benchmark
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstring>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Chimera Includes */
+#include <Chimera/common>
+
+/* Adesto Includes */
+#include <src/littlefs/littlefs.hpp>
+#include <src/littlefs/littlefs_bench.hpp>
+
+/* Test Driver Includes */
+#include <tests/common/test_common_resources.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t systemClock( void *context )
+{
+  return Chimera::micros();
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( LittleFS ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( LittleFS, FileSurvivesRemount )
+{
+  using namespace Adesto::LittleFS;
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = getDUT();
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props = dut->getDeviceProperties();
+  Adapter adapter( dut );
+  CHECK( adapter.configure() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Geometry follows the device
+  -------------------------------------------------*/
+  auto cfg = adapter.config();
+  CHECK( cfg != nullptr );
+  CHECK( cfg->block_size == chunkSize( props, props.eraseChunk ) );
+  CHECK( cfg->block_count == ( props.pageSize * props.numPages ) / cfg->block_size );
+  CHECK( cfg->cache_size == props.pageSize );
+  CHECK( ( cfg->lookahead_size % 8 ) == 0 );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  auto fs           = std::make_unique<lfs_t>();
+  auto file         = std::make_unique<lfs_file_t>();
+  const char text[] = "littlefs on AT25";
+  char readback[ sizeof( text ) ];
+
+  CHECK( lfs_format( fs.get(), cfg ) == LFS_ERR_OK );
+  CHECK( lfs_mount( fs.get(), cfg ) == LFS_ERR_OK );
+  CHECK( lfs_file_open( fs.get(), file.get(), "hello", LFS_O_WRONLY | LFS_O_CREAT ) == LFS_ERR_OK );
+  CHECK( lfs_file_write( fs.get(), file.get(), text, sizeof( text ) ) == sizeof( text ) );
+  CHECK( lfs_file_close( fs.get(), file.get() ) == LFS_ERR_OK );
+  CHECK( lfs_unmount( fs.get() ) == LFS_ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( lfs_mount( fs.get(), cfg ) == LFS_ERR_OK );
+  CHECK( lfs_file_open( fs.get(), file.get(), "hello", LFS_O_RDONLY ) == LFS_ERR_OK );
+  CHECK( lfs_file_read( fs.get(), file.get(), readback, sizeof( readback ) ) == sizeof( readback ) );
+  CHECK( memcmp( text, readback, sizeof( text ) ) == 0 );
+  CHECK( lfs_file_close( fs.get(), file.get() ) == LFS_ERR_OK );
+  CHECK( lfs_unmount( fs.get() ) == LFS_ERR_OK );
+
+  dut->close();
+}
+
+
+TEST( LittleFS, BenchmarkCompletes )
+{
+  using namespace Adesto::LittleFS;
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut           = getDUT();
+  BenchConfig config = { 4, 4096, 256 };
+  BenchResult result;
+
+  CHECK( dut->open() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  CHECK( runBenchmark( config, dut, systemClock, nullptr, result ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( result.errors == 0 );
+  CHECK( result.phases[ static_cast<size_t>( Phase::APPEND ) ].bytes == config.numFiles * config.fileSize );
+  CHECK( result.phases[ static_cast<size_t>( Phase::READ ) ].bytes == config.numFiles * config.fileSize );
+  CHECK( result.phases[ static_cast<size_t>( Phase::MOUNT ) ].elapsedUs > 0 );
+
+  dut->close();
+}
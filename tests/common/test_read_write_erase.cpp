@@ -24,17 +24,19 @@
 #include <Chimera/common>
 #include <Chimera/serial>
 
+/* Stream Includes */
+#include <src/stream/stream.hpp>
+#include <src/stream/stream_spi.hpp>
+
+/* Trace Includes */
+#include <src/trace/trace_buffer.hpp>
+
 /* Test Driver Includes */
 #include <tests/common/test_common_resources.hpp>
 
 /* CppUTest Includes  */
 #include <CppUTest/TestHarness.h>
 
-#define CONSOLE_WRITE( serial, buffer, length ) \
-  serial->lock();                               \
-  serial->write( buffer, length );              \
-  serial->unlock();
-
 /*-------------------------------------------------------------------------------
 Base Test Groups
 -------------------------------------------------------------------------------*/
@@ -57,6 +59,7 @@ Test Cases
 -------------------------------------------------------------------------------*/
 TEST( MemoryInterfacing, ReadWriteErase_Minimal )
 {
+  using namespace Adesto;
   using namespace Adesto::Testing;
   using namespace Aurora::Memory;
 
@@ -87,8 +90,10 @@ TEST( MemoryInterfacing, ReadWriteErase_Minimal )
     /*-------------------------------------------------
     Call
     -------------------------------------------------*/
+    auto traceId     = Trace::begin( Trace::Operation::ERASE, chunk_address, chunk_size );
     auto eraseResult = dut->erase( chunk_address, chunk_size );
     auto pendResult  = dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    Trace::end( traceId, Trace::Operation::ERASE, chunk_address, chunk_size, static_cast<uint8_t>( eraseResult ) );
 
     /*-------------------------------------------------
     Verify
@@ -99,7 +104,9 @@ TEST( MemoryInterfacing, ReadWriteErase_Minimal )
     while ( bytesToRead )
     {
       // Read a page of memory
+      traceId    = Trace::begin( Trace::Operation::READ, chunk_address, props.pageSize );
       readResult = dut->read( chunk_address, readBuffer.data(), props.pageSize );
+      Trace::end( traceId, Trace::Operation::READ, chunk_address, props.pageSize, static_cast<uint8_t>( readResult ) );
       CHECK( readResult == Status::ERR_OK );
 
       // Make sure the data equals the erased state
@@ -136,8 +143,10 @@ TEST( MemoryInterfacing, ReadWriteErase_Minimal )
     /*-------------------------------------------------
     Call
     -------------------------------------------------*/
+    auto traceId     = Trace::begin( Trace::Operation::WRITE, chunk_address, chunk_size );
     auto writeResult = dut->write( chunk_address, writeBuffer.data(), chunk_size );
     auto pendResult  = dut->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    Trace::end( traceId, Trace::Operation::WRITE, chunk_address, chunk_size, static_cast<uint8_t>( writeResult ) );
 
     /*-------------------------------------------------
     Verify
@@ -155,6 +164,7 @@ TEST( MemoryInterfacing, ReadWriteErase_Minimal )
 
 TEST( MemoryInterfacing, WriteChip )
 {
+  using namespace Adesto;
   using namespace Adesto::Testing;
   using namespace Aurora::Memory;
 
@@ -167,8 +177,10 @@ TEST( MemoryInterfacing, WriteChip )
   /*-------------------------------------------------
   Erase the whole chip in prep for writing new data
   -------------------------------------------------*/
-  dut->eraseChip();
+  auto traceId     = Trace::begin( Trace::Operation::ERASE_CHIP, 0, 0 );
+  auto eraseResult = dut->eraseChip();
   dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  Trace::end( traceId, Trace::Operation::ERASE_CHIP, 0, 0, static_cast<uint8_t>( eraseResult ) );
 
   /*-------------------------------------------------
   Write every page on the device, then read it back
@@ -193,10 +205,16 @@ TEST( MemoryInterfacing, WriteChip )
     Write the data to the current page and ensure it can
     be read back properly
     -------------------------------------------------*/
-    dut->write( currentAddress, writeBuffer.data(), props.pageSize );
+    traceId          = Trace::begin( Trace::Operation::WRITE, currentAddress, props.pageSize );
+    auto writeResult = dut->write( currentAddress, writeBuffer.data(), props.pageSize );
     dut->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
-    dut->read( currentAddress, readBuffer.data(), props.pageSize );
+    Trace::end( traceId, Trace::Operation::WRITE, currentAddress, props.pageSize, static_cast<uint8_t>( writeResult ) );
+
+    traceId         = Trace::begin( Trace::Operation::READ, currentAddress, props.pageSize );
+    auto readResult = dut->read( currentAddress, readBuffer.data(), props.pageSize );
     dut->pendEvent( Event::MEM_READ_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    Trace::end( traceId, Trace::Operation::READ, currentAddress, props.pageSize, static_cast<uint8_t>( readResult ) );
+
     CHECK( memcmp( readBuffer.data(), writeBuffer.data(), props.pageSize ) == 0 );
 
     /*-------------------------------------------------
@@ -209,6 +227,7 @@ TEST( MemoryInterfacing, WriteChip )
 
 TEST( MemoryInterfacing, EraseChip )
 {
+  using namespace Adesto;
   using namespace Adesto::Testing;
   using namespace Aurora::Memory;
 
@@ -243,33 +262,28 @@ TEST( MemoryInterfacing, EraseChip )
   /*-------------------------------------------------
   Erase the whole chip
   -------------------------------------------------*/
+  auto traceId     = Trace::begin( Trace::Operation::ERASE_CHIP, 0, 0 );
   auto eraseResult = dut->eraseChip();
   dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  Trace::end( traceId, Trace::Operation::ERASE_CHIP, 0, 0, static_cast<uint8_t>( eraseResult ) );
 
   /*-------------------------------------------------
-  Verify the whole chip has been erased
+  Verify the whole chip has been erased with a single
+  continuous read. readBuffer is free again, its two
+  halves alternate between the bus and the compare.
   -------------------------------------------------*/
-  auto readResult       = Status::ERR_OK;
-  int bytesToRead       = props.pageSize * props.numPages;
-  size_t currentAddress = 0;
+  Stream::SPIContext context = Stream::spiContext( getSPIChannelConfig() );
+  const size_t chipSize      = props.pageSize * props.numPages;
+  size_t mismatch            = Stream::NO_MISMATCH;
+  Stream::Buffers ring       = { readBuffer.data(), readBuffer.size() / 2, 2 };
 
-  while ( bytesToRead )
-  {
-    readBuffer.fill( 0x00 );
-    readResult = dut->read( currentAddress, readBuffer.data(), props.pageSize );
-    CHECK( readResult == Status::ERR_OK );
-
-    // Make sure the data equals the erased state
-    for ( auto x = 0; x < props.pageSize; x++ )
-    {
-      if ( readBuffer[ x ] != 0xFF )
-      {
-        FAIL( "Chunk not erased" );
-      }
-    }
+  traceId         = Trace::begin( Trace::Operation::READ, 0, chipSize );
+  auto readResult = Stream::verify( Stream::spiTransport(), &context, 0, chipSize, ring, 0xFF, mismatch );
+  Trace::end( traceId, Trace::Operation::READ, 0, chipSize, static_cast<uint8_t>( readResult ) );
 
-    // Update read counters
-    bytesToRead -= props.pageSize;
-    currentAddress += props.pageSize;
+  CHECK( readResult == Status::ERR_OK );
+  if ( mismatch != Stream::NO_MISMATCH )
+  {
+    FAIL( "Chunk not erased" );
   }
 }
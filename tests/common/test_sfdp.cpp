@@ -0,0 +1,84 @@
+/********************************************************************************
+ *  File Name:
+ *    test_sfdp.cpp
+ *
+ *  Description:
+ *    Common test for SFDP discovery on the real part
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Chimera Includes */
+#include <Chimera/spi>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/sfdp/sfdp_device.hpp>
+#include <src/sfdp/sfdp_spi.hpp>
+#include <src/stream/stream_spi.hpp>
+
+/* Test Driver Includes */
+#include <tests/common/test_common_resources.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( SFDP ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( SFDP, DiscoveredGeometryMatchesDriver )
+{
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto channel = getSPIChannelConfig();
+  auto dut     = std::make_shared<Adesto::SFDP::Device>( getDUT(), Adesto::SFDP::readSPI, &channel );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  CHECK( dut->open() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify:
+    - The part publishes SFDP
+    - Size and page layout agree with the driver
+    - Every part supports at least a 4K erase
+  -------------------------------------------------*/
+  auto expected = getDUT()->getDeviceProperties();
+  auto props    = dut->getDeviceProperties();
+  auto &info    = dut->getInfo();
+
+  CHECK( dut->discovered() );
+  CHECK_EQUAL( expected.jedec, props.jedec );
+  CHECK_EQUAL( expected.pageSize, props.pageSize );
+  CHECK_EQUAL( expected.pageSize * expected.numPages, props.endAddress );
+  CHECK( Adesto::SFDP::findErase( info, 4 * 1024 ) != nullptr );
+  CHECK( info.reads[ static_cast<size_t>( info.fastestRead ) ].supported );
+
+  /*-------------------------------------------------
+  Verify: The single lane read the stream transport
+  picks is the Read Array every part implements
+  -------------------------------------------------*/
+  Adesto::Stream::SPIContext context;
+  CHECK( Adesto::Stream::spiContext( channel, info, context ) == Status::ERR_OK );
+  CHECK( context.opcode == Adesto::Stream::CMD_FAST_READ );
+  CHECK( context.addressBytes == info.addressBytes );
+  CHECK( context.dummyBytes == 1 );
+
+  dut->close();
+}
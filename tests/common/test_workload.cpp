@@ -0,0 +1,93 @@
+/********************************************************************************
+ *  File Name:
+ *    test_workload.cpp
+ *
+ *  Description:
+ *    Common test for the synthetic workload engine
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Chimera Includes */
+#include <Chimera/common>
+
+/* Adesto Includes */
+#include <src/workload/workload.hpp>
+
+/* Test Driver Includes */
+#include <tests/common/test_common_resources.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t systemClock( void *context )
+{
+  return Chimera::micros();
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Workload ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Workload, MixedJobCompletes )
+{
+  using namespace Adesto::Testing;
+  using namespace Adesto::Workload;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto dut = getDUT();
+  CHECK( dut->open() == Status::ERR_OK );
+
+  auto props = dut->getDeviceProperties();
+  Job job    = { "test-mixed", 60, 30, Pattern::RANDOM, Distribution::ZIPF, 0.9f, 0, 0, 256, 512, 1, 1, 0, 64, 42 };
+
+  job.regionSize = 4 * chunkSize( props, props.eraseChunk );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  auto result = std::make_unique<Result>();
+  CHECK( run( job, dut, systemClock, nullptr, *result ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( result->totalOps() == job.maxOps );
+  CHECK( result->totalErrors() == 0 );
+  CHECK( result->ops[ static_cast<size_t>( OpType::READ ) ].latency.count() > 0 );
+
+  dut->close();
+}
+
+
+TEST( Workload, RejectsInvalidJob )
+{
+  using namespace Adesto::Testing;
+  using namespace Adesto::Workload;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Call FUT: No limits and a max request that isn't
+  a multiple of the minimum.
+  -------------------------------------------------*/
+  Job job     = { "test-bad", 100, 0, Pattern::SEQUENTIAL, Distribution::UNIFORM, 0.0f, 0, 0, 256, 300, 1, 1, 0, 0, 0 };
+  auto result = std::make_unique<Result>();
+
+  CHECK( run( job, getDUT(), systemClock, nullptr, *result ) == Status::ERR_BAD_ARG );
+}
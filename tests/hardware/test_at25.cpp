@@ -36,8 +36,20 @@
 /* Memory Driver Includes */
 #include <Adesto/at25/at25_driver.hpp>
 
+/* SFDP Includes */
+#include <src/sfdp/sfdp_device.hpp>
+#include <src/sfdp/sfdp_spi.hpp>
+
+/* Stream Includes */
+#include <src/stream/stream.hpp>
+#include <src/stream/stream_spi.hpp>
+
+/* Trace Includes */
+#include <src/trace/trace_buffer.hpp>
+
 /* Test Framework Includes */
 #include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
 
 /* Test Driver Includes */
 #include <tests/common/test_common_resources.hpp>
@@ -54,6 +66,7 @@ Forward Declarations
 static void test_thread( void *arg );
 static void initializeSPI();
 static void initializeSerial();
+static void traceSink( const void *const data, const size_t length );
 
 /*-------------------------------------------------------------------------------
 Public Data
@@ -80,6 +93,12 @@ static boost::circular_buffer<uint8_t> sTXCircularBuffer( CircularBufferSize );
 static std::array<uint8_t, HWBufferSize> sRXHWBuffer;
 static boost::circular_buffer<uint8_t> sRXCircularBuffer( CircularBufferSize );
 
+/*-------------------------------------------------
+Streaming Read Buffers
+-------------------------------------------------*/
+// Two halves, filled alternately by the stream helpers
+static std::array<uint8_t, 2048> sStreamBuffer;
+
 /*-------------------------------------------------------------------------------
 Public Functions
 -------------------------------------------------------------------------------*/
@@ -215,6 +234,25 @@ static void initializeSerial()
   result |= Serial->begin( PeripheralMode::INTERRUPT, PeripheralMode::INTERRUPT );
 }
 
+/**
+ *  Ships framed trace data out the serial port. Only ever called from the
+ *  low priority trace drain thread, so blocking here doesn't disturb timing
+ *  of the code under test.
+ *
+ *  @param[in]  data      Framed trace data
+ *  @param[in]  length    Number of bytes to send
+ *  @return void
+ */
+static void traceSink( const void *const data, const size_t length )
+{
+  auto serial = Chimera::Serial::getDriver( serialChannel );
+
+  serial->lock();
+  serial->write( data, length );
+  serial->await( Chimera::Event::TRIGGER_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  serial->unlock();
+}
+
 /**
  *  Primary thread for intializing test resources and then executing tests.
  *  Will never exit.
@@ -260,8 +298,25 @@ static void test_thread( void *arg )
   serial->await( Chimera::Event::TRIGGER_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
   serial->unlock();
 
+  Adesto::Trace::startDrainThread( traceSink );
   int rcode = CommandLineTestRunner::RunAllTests( 2, av_override );
 
+  /*-------------------------------------------------
+  Let the trace thread catch up so the exit message
+  lands after the last of the recorded events.
+  -------------------------------------------------*/
+  while ( Adesto::Trace::pending() )
+  {
+    Chimera::delayMilliseconds( Adesto::Trace::DRAIN_PERIOD_MS );
+  }
+
+  snprintf( printBuffer.data(), printBuffer.size(), "Trace records dropped: %u\n",
+            static_cast<unsigned>( Adesto::Trace::dropped() ) );
+  serial->lock();
+  serial->write( printBuffer.data(), strlen( printBuffer.data() ) );
+  serial->await( Chimera::Event::TRIGGER_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+  serial->unlock();
+
   snprintf(printBuffer.data(), printBuffer.size(), "Test exit with code: %d\n", rcode );
   serial->lock();
   serial->write( printBuffer.data(), strlen( printBuffer.data() ) );
@@ -272,4 +327,70 @@ static void test_thread( void *arg )
   {
     Chimera::insert_debug_breakpoint();
   }
-}
\ No newline at end of file
+}
+
+
+/*-------------------------------------------------------------------------------
+AT25 Specific Tests
+  These drive the SPI bus directly, so they can't live with the common tests
+  that run against any driver.
+-------------------------------------------------------------------------------*/
+TEST_GROUP( AT25Stream ){};
+
+TEST( AT25Stream, SPIStreamMatchesDriverReads )
+{
+  using namespace Adesto;
+  using namespace Adesto::Testing;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: One erased unit followed by one holding
+  a page of data
+  -------------------------------------------------*/
+  auto dut          = getDUT();
+  auto props        = dut->getDeviceProperties();
+  const size_t unit = 8;
+  size_t address    = chunkStartAddress( props, props.eraseChunk, unit );
+  size_t size       = chunkSize( props, props.eraseChunk );
+
+  for ( size_t x = 0; x < writeBuffer.size(); x++ )
+  {
+    writeBuffer[ x ] = static_cast<uint8_t>( x );
+  }
+
+  CHECK( dut->erase( address, 2 * size ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+  CHECK( dut->write( address + size, writeBuffer.data(), props.pageSize ) == Status::ERR_OK );
+  CHECK( dut->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Read command as published in the part's SFDP tables
+  -------------------------------------------------*/
+  auto channel = getSPIChannelConfig();
+  auto sfdp    = std::make_shared<SFDP::Device>( dut, SFDP::readSPI, &channel );
+  auto context = Stream::spiContext( channel );
+
+  CHECK( sfdp->open() == Status::ERR_OK );
+  CHECK( sfdp->discovered() );
+  CHECK( Stream::spiContext( channel, sfdp->getInfo(), context ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Call FUT: Stream both units in one read command
+  -------------------------------------------------*/
+  Stream::Buffers ring = { sStreamBuffer.data(), sStreamBuffer.size() / 2, 2 };
+  size_t mismatch      = Stream::NO_MISMATCH;
+  uint32_t spiCRC      = 0;
+  uint32_t deviceCRC   = 0;
+
+  CHECK( Stream::verify( Stream::spiTransport(), &context, address, size, ring, 0xFF, mismatch ) == Status::ERR_OK );
+  CHECK( Stream::crc32( Stream::spiTransport(), &context, address, 2 * size, ring, spiCRC ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify: Same bytes as the driver's page reads
+  -------------------------------------------------*/
+  Stream::DeviceContext device = { dut.get(), 0 };
+  CHECK( Stream::crc32( Stream::deviceTransport(), &device, address, 2 * size, ring, deviceCRC ) == Status::ERR_OK );
+
+  CHECK( mismatch == Stream::NO_MISMATCH );
+  CHECK_EQUAL( deviceCRC, spiCRC );
+}
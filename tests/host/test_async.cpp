@@ -0,0 +1,183 @@
+/********************************************************************************
+ *  File Name:
+ *    test_async.cpp
+ *
+ *  Description:
+ *    Coroutine executor scheduling and teardown against a simulated part
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/async/async.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Constants
+-------------------------------------------------------------------------------*/
+static constexpr size_t NUM_JOBS = 3;
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+/**
+ *  Lives in a job's frame and counts the frame being torn down
+ */
+struct FrameGuard
+{
+  size_t &destroyed;
+
+  ~FrameGuard()
+  {
+    destroyed++;
+  }
+};
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+/**
+ *  Erase, program and read back one unit, logging its id after each step
+ */
+static Adesto::Async::Task eraseWriteVerify( Adesto::Async::Executor &exec, const size_t id, const size_t address,
+                                             const size_t length, std::vector<size_t> &log,
+                                             std::vector<Aurora::Memory::Status> &results, size_t &destroyed )
+{
+  using namespace Aurora::Memory;
+
+  FrameGuard guard{ destroyed };
+  std::array<uint8_t, 64> tx;
+  std::array<uint8_t, 64> rx;
+  tx.fill( static_cast<uint8_t>( 0x10 + id ) );
+  rx.fill( 0 );
+
+  auto result = co_await exec.erase( address, length );
+  log.push_back( id );
+
+  if ( result == Status::ERR_OK )
+  {
+    result = co_await exec.write( address, tx.data(), tx.size() );
+    log.push_back( id );
+  }
+
+  if ( result == Status::ERR_OK )
+  {
+    result = co_await exec.read( address, rx.data(), rx.size() );
+    log.push_back( id );
+  }
+
+  if ( ( result == Status::ERR_OK ) && ( memcmp( tx.data(), rx.data(), tx.size() ) != 0 ) )
+  {
+    result = Status::ERR_FAIL;
+  }
+
+  results[ id ] = result;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Async ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Async, JobsTakeTurnsAndFailuresStayLocal )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim          = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t unit = sim->getDeviceProperties().blockSize;
+  size_t destroyed  = 0;
+
+  std::vector<size_t> log;
+  std::vector<Status> results( NUM_JOBS, Status::ERR_FAIL );
+
+  /*-------------------------------------------------
+  Job 1 asks for a misaligned erase, which the part
+  rejects
+  -------------------------------------------------*/
+  Async::Executor exec( sim );
+  for ( size_t id = 0; id < NUM_JOBS; id++ )
+  {
+    const size_t address = ( ( id + 1 ) * unit ) + ( ( id == 1 ) ? 1 : 0 );
+    CHECK( exec.spawn( eraseWriteVerify( exec, id, address, unit, log, results, destroyed ) ) == Status::ERR_OK );
+  }
+
+  CHECK_EQUAL( NUM_JOBS, exec.active() );
+  exec.run();
+
+  /*-------------------------------------------------
+  Verify: Operations went out in the order the jobs
+  asked for them, one step of each job per round
+  -------------------------------------------------*/
+  const std::vector<size_t> expected = { 0, 1, 2, 0, 2, 0, 2 };
+  CHECK( log == expected );
+
+  CHECK( results[ 0 ] == Status::ERR_OK );
+  CHECK( results[ 1 ] == Status::ERR_BAD_ARG );
+  CHECK( results[ 2 ] == Status::ERR_OK );
+  CHECK_EQUAL( 0, exec.active() );
+  CHECK_EQUAL( NUM_JOBS, destroyed );
+}
+
+
+TEST( Async, DestroysSuspendedFrames )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim          = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t unit = sim->getDeviceProperties().blockSize;
+  size_t destroyed  = 0;
+
+  std::vector<size_t> log;
+  std::vector<Status> results( NUM_JOBS + 1, Status::ERR_FAIL );
+
+  {
+    Async::Executor exec( sim );
+
+    /*-------------------------------------------------
+    One job never spawned, the rest left suspended with
+    one operation in flight, some queued behind it, and
+    one job ready but not yet started
+    -------------------------------------------------*/
+    {
+      auto unused = eraseWriteVerify( exec, NUM_JOBS, 0, unit, log, results, destroyed );
+      CHECK( unused.valid() );
+    }
+    CHECK_EQUAL( 0, destroyed );
+
+    for ( size_t id = 0; id < NUM_JOBS; id++ )
+    {
+      CHECK( exec.spawn( eraseWriteVerify( exec, id, ( id + 1 ) * unit, unit, log, results, destroyed ) )
+             == Status::ERR_OK );
+    }
+
+    CHECK( exec.poll( Async::DONT_WAIT ) );
+    CHECK( log.empty() );
+    CHECK( exec.spawn( eraseWriteVerify( exec, 0, 0, unit, log, results, destroyed ) ) == Status::ERR_OK );
+    CHECK_EQUAL( NUM_JOBS + 1, exec.active() );
+  }
+
+  /*-------------------------------------------------
+  Verify: Every started frame was torn down and none
+  resumed. Frames that never started hold no guard,
+  leaks of those show up under the sanitizers.
+  -------------------------------------------------*/
+  CHECK_EQUAL( NUM_JOBS, destroyed );
+  CHECK( log.empty() );
+}
@@ -0,0 +1,163 @@
+/********************************************************************************
+ *  File Name:
+ *    test_batch.cpp
+ *
+ *  Description:
+ *    Command lists run by the batch engine against a simulated part
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/batch/batch.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Batch ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Batch, RunsListWithOneCompletion )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim          = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t page = sim->getDeviceProperties().pageSize;
+  const size_t base = sim->getDeviceProperties().blockSize;
+
+  std::array<uint8_t, 256> pattern;
+  std::array<uint8_t, 256> readback;
+  for ( size_t x = 0; x < pattern.size(); x++ )
+  {
+    pattern[ x ] = static_cast<uint8_t>( x ^ 0x5A );
+  }
+  readback.fill( 0 );
+
+  /*-------------------------------------------------
+  Erase, program two pages, read the second one back
+  -------------------------------------------------*/
+  Batch::Command commands[] = {
+    { Batch::CmdType::ERASE, base, nullptr, sim->getDeviceProperties().blockSize, Status::ERR_FAIL },
+    { Batch::CmdType::WRITE, base, pattern.data(), pattern.size(), Status::ERR_FAIL },
+    { Batch::CmdType::WRITE, base + page, pattern.data(), pattern.size(), Status::ERR_FAIL },
+    { Batch::CmdType::READ, base + page, readback.data(), readback.size(), Status::ERR_FAIL },
+  };
+  Batch::List list = { commands, 4, 0, 0 };
+
+  Batch::Engine engine( sim );
+  CHECK( engine.start() == Status::ERR_OK );
+  CHECK( engine.execute( list, Batch::WAIT_FOREVER ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( list.executed == 4 );
+  for ( auto &cmd : commands )
+  {
+    CHECK( cmd.status == Status::ERR_OK );
+  }
+  CHECK( readback == pattern );
+
+  engine.stop();
+  CHECK( engine.getStats().lists == 1 );
+  CHECK( engine.getStats().commands == 4 );
+  CHECK( engine.getStats().failedLists == 0 );
+}
+
+
+TEST( Batch, StopsAtFirstFailure )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim           = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t block = sim->getDeviceProperties().blockSize;
+  std::array<uint8_t, 16> data;
+  data.fill( 0xC3 );
+
+  Batch::Command good[] = {
+    { Batch::CmdType::ERASE, 0, nullptr, block, Status::ERR_FAIL },
+    { Batch::CmdType::WRITE, 0, data.data(), data.size(), Status::ERR_FAIL },
+  };
+  Batch::Command bad[] = {
+    { Batch::CmdType::ERASE, 0, nullptr, block, Status::ERR_FAIL },
+    { Batch::CmdType::ERASE, 1, nullptr, block, Status::ERR_FAIL },
+    { Batch::CmdType::WRITE, 0, data.data(), data.size(), Status::ERR_FAIL },
+  };
+  Batch::List first  = { good, 2, 0, 0 };
+  Batch::List second = { bad, 3, 0, 0 };
+  Batch::List third  = { good, 2, 0, 0 };
+
+  /*-------------------------------------------------
+  Queue all three before waiting on any of them
+  -------------------------------------------------*/
+  Batch::Engine engine( sim );
+  CHECK( engine.submit( first ) == Status::ERR_FAIL );
+  CHECK( engine.start() == Status::ERR_OK );
+  CHECK( engine.submit( first ) == Status::ERR_OK );
+  CHECK( engine.submit( second ) == Status::ERR_OK );
+  CHECK( engine.submit( third ) == Status::ERR_OK );
+
+  CHECK( engine.wait( third, Batch::WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( engine.wait( second, Batch::WAIT_FOREVER ) == Status::ERR_BAD_ARG );
+  CHECK( engine.wait( first, Batch::WAIT_FOREVER ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  The misaligned erase ends its list
+  -------------------------------------------------*/
+  CHECK( second.executed == 2 );
+  CHECK( bad[ 0 ].status == Status::ERR_OK );
+  CHECK( bad[ 1 ].status == Status::ERR_BAD_ARG );
+  CHECK( bad[ 2 ].status == Status::ERR_FAIL );
+
+  engine.stop();
+  CHECK( engine.getStats().lists == 3 );
+  CHECK( engine.getStats().commands == 6 );
+  CHECK( engine.getStats().failedLists == 1 );
+}
+
+
+TEST( Batch, DeviceLockHoldsOffLists )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim           = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t block = sim->getDeviceProperties().blockSize;
+
+  Batch::Command commands[] = {
+    { Batch::CmdType::ERASE, 0, nullptr, block, Status::ERR_FAIL },
+  };
+  Batch::List list = { commands, 1, 0, 0 };
+
+  Batch::Engine engine( sim );
+  CHECK( engine.start() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  A queued list waits while the device is taken
+  -------------------------------------------------*/
+  engine.lockDevice();
+  CHECK( engine.submit( list ) == Status::ERR_OK );
+  CHECK( engine.wait( list, 20 ) == Status::ERR_TIMEOUT );
+  CHECK( list.executed == 0 );
+
+  engine.unlockDevice();
+  CHECK( engine.wait( list, Batch::WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( list.executed == 1 );
+
+  engine.stop();
+}
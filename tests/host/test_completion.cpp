@@ -0,0 +1,271 @@
+/********************************************************************************
+ *  File Name:
+ *    test_completion.cpp
+ *
+ *  Description:
+ *    Completion queue matching and wake-up behavior, with a second thread
+ *    standing in for the driver's interrupt handler
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/completion/completion_queue.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static Adesto::Completion::Record makeRecord( const uint16_t id, const Aurora::Memory::Status status )
+{
+  Adesto::Completion::Record record;
+  record.id        = id;
+  record.event     = static_cast<uint8_t>( Aurora::Memory::Event::MEM_WRITE_COMPLETE );
+  record.status    = static_cast<uint8_t>( status );
+  record.timestamp = id;
+  return record;
+}
+
+
+static uint32_t hostUs()
+{
+  using namespace std::chrono;
+  return static_cast<uint32_t>( duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count() );
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Completion ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Completion, MatchesOutOfOrderCompletions )
+{
+  using namespace Adesto::Completion;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Three requests in flight
+  -------------------------------------------------*/
+  Queue queue;
+  const uint16_t first  = queue.nextId();
+  const uint16_t second = queue.nextId();
+  const uint16_t third  = queue.nextId();
+
+  /*-------------------------------------------------
+  Call FUT: They finish in reverse order
+  -------------------------------------------------*/
+  std::thread producer( [ & ]() {
+    queue.postFromISR( makeRecord( third, Status::ERR_OK ) );
+    queue.postFromISR( makeRecord( second, Status::ERR_FAIL ) );
+    queue.postFromISR( makeRecord( first, Status::ERR_OK ) );
+  } );
+
+  /*-------------------------------------------------
+  Verify: Each waiter gets its own result
+  -------------------------------------------------*/
+  Record record;
+  CHECK( queue.waitFor( first, record, WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( record.id == first );
+  CHECK( record.status == static_cast<uint8_t>( Status::ERR_OK ) );
+
+  CHECK( queue.waitFor( second, record, WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( record.id == second );
+  CHECK( record.status == static_cast<uint8_t>( Status::ERR_FAIL ) );
+
+  CHECK( queue.waitFor( third, record, WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( record.id == third );
+
+  producer.join();
+  CHECK( queue.dropped() == 0 );
+}
+
+
+TEST( Completion, WakesBlockedWaiter )
+{
+  using namespace Adesto::Completion;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  Queue queue;
+  const uint16_t id = queue.nextId();
+  Record record;
+
+  /*-------------------------------------------------
+  Call FUT: Nothing posted, then a late completion
+  -------------------------------------------------*/
+  CHECK( queue.waitFor( id, record, 5 ) == Status::ERR_TIMEOUT );
+
+  std::thread producer( [ & ]() {
+    std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+    queue.postFromISR( makeRecord( id, Status::ERR_OK ) );
+  } );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( queue.waitFor( id, record, 1000 ) == Status::ERR_OK );
+  CHECK( record.id == id );
+
+  producer.join();
+}
+
+
+TEST( Completion, OverflowFailsWaiterInsteadOfHanging )
+{
+  using namespace Adesto::Completion;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Fill the queue with completions nobody
+  has collected, some of them pulled into the hold
+  area by a waiter looking for another request
+  -------------------------------------------------*/
+  Queue queue;
+  Record record;
+  const uint16_t first  = queue.nextId();
+  const uint16_t unused = 0xFFFF;
+
+  for ( size_t x = 0; x < QUEUE_DEPTH; x++ )
+  {
+    CHECK( queue.post( makeRecord( queue.nextId(), Status::ERR_OK ) ) );
+  }
+
+  CHECK( queue.waitFor( unused, record, 0 ) == Status::ERR_TIMEOUT );
+
+  /*-------------------------------------------------
+  Call FUT: The poster is told, and a waiter whose
+  completion was refused returns instead of hanging
+  -------------------------------------------------*/
+  CHECK( !queue.post( makeRecord( first, Status::ERR_OK ) ) );
+  CHECK( queue.dropped() == 1 );
+  CHECK( queue.waitFor( first, record, WAIT_FOREVER ) == Status::ERR_FAIL );
+
+  /*-------------------------------------------------
+  Verify: Queued completions are still handed out,
+  and reset() makes the queue usable again
+  -------------------------------------------------*/
+  CHECK( queue.waitFor( first + 1, record, WAIT_FOREVER ) == Status::ERR_OK );
+  CHECK( record.id == first + 1 );
+
+  queue.reset();
+  const uint16_t next = queue.nextId();
+  CHECK( queue.post( makeRecord( next, Status::ERR_OK ) ) );
+  CHECK( queue.waitFor( next, record, WAIT_FOREVER ) == Status::ERR_OK );
+}
+
+
+TEST( Completion, SimInterruptsCompleteInFlightRequests )
+{
+  using namespace Adesto;
+  using namespace Adesto::Completion;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Eight requests in flight against the
+  simulated part, one of them a misaligned erase. A
+  second thread plays the SPI completion interrupt,
+  finishing them out of order with a gap between
+  each so the consumer is really asleep when woken.
+  -------------------------------------------------*/
+  static constexpr size_t NUM_REQUESTS  = 8;
+  static constexpr size_t POST_GAP_MS   = 2;
+  static constexpr uint32_t MAX_LATENCY = 20000; /**< Microseconds, loose enough for sanitizer builds */
+  static constexpr size_t FAILING       = 6;
+
+  static constexpr std::array<size_t, NUM_REQUESTS> order     = { 2, 0, 3, 1, 6, 4, 7, 5 };
+  static constexpr std::array<bool, NUM_REQUESTS> wokenByPost = { true, true, false, false, true, true, false, false };
+
+  Sim::Device sim( Sim::Model::AT25SF081 );
+  CHECK( sim.open() == Status::ERR_OK );
+
+  const size_t pageSize = sim.getGeometry().pageSize;
+  Queue queue;
+  std::array<uint16_t, NUM_REQUESTS> ids;
+  for ( auto &id : ids )
+  {
+    id = queue.nextId();
+  }
+
+  /*-------------------------------------------------
+  Call FUT: Each interrupt finishes one operation and
+  posts its completion straight from that context
+  -------------------------------------------------*/
+  std::thread isr( [ & ]() {
+    std::vector<uint8_t> page( pageSize );
+    for ( const size_t request : order )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( POST_GAP_MS ) );
+
+      Record record;
+      Status status;
+      if ( request == FAILING )
+      {
+        status       = sim.erase( 1, pageSize );
+        record.event = static_cast<uint8_t>( Event::MEM_ERASE_COMPLETE );
+      }
+      else
+      {
+        memset( page.data(), static_cast<int>( request ), page.size() );
+        status       = sim.write( request * pageSize, page.data(), page.size() );
+        record.event = static_cast<uint8_t>( Event::MEM_WRITE_COMPLETE );
+      }
+
+      record.id        = ids[ request ];
+      record.status    = static_cast<uint8_t>( status );
+      record.timestamp = hostUs();
+      queue.postFromISR( record );
+    }
+  } );
+
+  /*-------------------------------------------------
+  Verify: Waiting in request order, each waiter gets
+  its own operation's result. Completions that woke a
+  sleeping waiter did so promptly; the others were
+  already held when their turn came.
+  -------------------------------------------------*/
+  for ( size_t request = 0; request < NUM_REQUESTS; request++ )
+  {
+    Record record;
+    CHECK( queue.waitFor( ids[ request ], record, 1000 ) == Status::ERR_OK );
+    const uint32_t latency = hostUs() - record.timestamp;
+
+    CHECK( record.id == ids[ request ] );
+    if ( request == FAILING )
+    {
+      CHECK( record.status == static_cast<uint8_t>( Status::ERR_BAD_ARG ) );
+    }
+    else
+    {
+      uint8_t data = 0;
+      CHECK( record.status == static_cast<uint8_t>( Status::ERR_OK ) );
+      CHECK( sim.read( request * pageSize, &data, 1 ) == Status::ERR_OK );
+      CHECK( data == request );
+    }
+
+    if ( wokenByPost[ request ] )
+    {
+      CHECK( latency < MAX_LATENCY );
+    }
+  }
+
+  isr.join();
+  CHECK( queue.dropped() == 0 );
+}
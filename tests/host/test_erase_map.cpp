@@ -0,0 +1,166 @@
+/********************************************************************************
+ *  File Name:
+ *    test_erase_map.cpp
+ *
+ *  Description:
+ *    Erase state tracking decorator against a simulated part
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <memory>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/erase_map/erase_map.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( EraseMap ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( EraseMap, SkipsCleanAndCoalescesDirtyUnits )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  EraseMap::Device dut( sim );
+  CHECK( dut.open() == Status::ERR_OK );
+
+  const size_t unit = sim->getDeviceProperties().blockSize;
+  std::vector<uint8_t> data( sim->getDeviceProperties().pageSize, 0x3C );
+
+  /*-------------------------------------------------
+  Dirty units 2, 3 and 5, leave 4 blank
+  -------------------------------------------------*/
+  CHECK( dut.write( 2 * unit, data.data(), data.size() ) == Status::ERR_OK );
+  CHECK( dut.write( 3 * unit, data.data(), data.size() ) == Status::ERR_OK );
+  CHECK( dut.write( 5 * unit, data.data(), data.size() ) == Status::ERR_OK );
+  sim->clearStats();
+
+  CHECK( dut.erase( 2 * unit, 4 * unit ) == Status::ERR_OK );
+  CHECK( dut.pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify: 2-3 go out as one command, 4 is skipped
+  -------------------------------------------------*/
+  CHECK( sim->eraseCount( 2 ) == 1 );
+  CHECK( sim->eraseCount( 3 ) == 1 );
+  CHECK( sim->eraseCount( 4 ) == 0 );
+  CHECK( sim->eraseCount( 5 ) == 1 );
+  CHECK( dut.getStats().erasesRequested == 4 );
+  CHECK( dut.getStats().erasesSkipped == 1 );
+  CHECK( dut.getStats().erasesIssued == 2 );
+
+  /*-------------------------------------------------
+  Erasing the same range again costs nothing
+  -------------------------------------------------*/
+  sim->clearStats();
+  CHECK( dut.erase( 2 * unit, 4 * unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().erases == 0 );
+  CHECK( sim->getStats().reads == 0 );
+}
+
+
+TEST( EraseMap, BlankCheckProbesBeforeReadingTheUnit )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim          = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t unit = sim->getDeviceProperties().blockSize;
+  const size_t page = sim->getDeviceProperties().pageSize;
+  std::vector<uint8_t> data( page, 0x00 );
+
+  /*-------------------------------------------------
+  Data written behind the decorator's back
+  -------------------------------------------------*/
+  CHECK( sim->write( 0, data.data(), data.size() ) == Status::ERR_OK );
+
+  EraseMap::Device dut( sim );
+  CHECK( dut.open() == Status::ERR_OK );
+  sim->clearStats();
+
+  /*-------------------------------------------------
+  A dirty unit costs one probe, a blank one a full read
+  -------------------------------------------------*/
+  CHECK( dut.erase( 0, unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().bytesRead == EraseMap::BLANK_CHECK_CHUNK );
+  CHECK( sim->getStats().erases == 1 );
+
+  sim->clearStats();
+  CHECK( dut.erase( unit, unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().bytesRead == unit );
+  CHECK( sim->getStats().erases == 0 );
+
+  /*-------------------------------------------------
+  Pages seen blank through read() aren't read again
+  -------------------------------------------------*/
+  std::vector<uint8_t> readback( unit );
+  CHECK( dut.read( 2 * unit, readback.data(), readback.size() ) == Status::ERR_OK );
+
+  sim->clearStats();
+  CHECK( dut.erase( 2 * unit, unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().reads == 0 );
+  CHECK( sim->getStats().erases == 0 );
+  CHECK( dut.getStats().blankChecks == 2 );
+}
+
+
+TEST( EraseMap, WritesAndInvalidateForgetCleanUnits )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  EraseMap::Device dut( sim );
+  CHECK( dut.open() == Status::ERR_OK );
+
+  const size_t unit = sim->getDeviceProperties().blockSize;
+  std::vector<uint8_t> data( sim->getDeviceProperties().pageSize, 0x81 );
+
+  CHECK( dut.eraseChip() == Status::ERR_OK );
+  CHECK( dut.pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  A write through the decorator dirties its unit. The
+  chip erase already counted once against every unit.
+  -------------------------------------------------*/
+  CHECK( dut.write( unit, data.data(), data.size() ) == Status::ERR_OK );
+  sim->clearStats();
+  CHECK( dut.erase( 0, 2 * unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().erases == 1 );
+  CHECK( sim->eraseCount( 0 ) == 1 );
+  CHECK( sim->eraseCount( 1 ) == 2 );
+
+  /*-------------------------------------------------
+  One behind its back is only caught after invalidate()
+  -------------------------------------------------*/
+  CHECK( sim->write( 3 * unit, data.data(), data.size() ) == Status::ERR_OK );
+  sim->clearStats();
+  CHECK( dut.erase( 3 * unit, unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().erases == 0 );
+
+  dut.invalidate();
+  CHECK( dut.erase( 3 * unit, unit ) == Status::ERR_OK );
+  CHECK( sim->getStats().erases == 1 );
+
+  std::vector<uint8_t> readback( data.size() );
+  CHECK( dut.read( 3 * unit, readback.data(), readback.size() ) == Status::ERR_OK );
+  CHECK( readback == std::vector<uint8_t>( data.size(), 0xFF ) );
+}
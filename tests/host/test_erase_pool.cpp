@@ -0,0 +1,174 @@
+/********************************************************************************
+ *  File Name:
+ *    test_erase_pool.cpp
+ *
+ *  Description:
+ *    Pre-erased sector pool against a simulated part, with the test thread
+ *    acting as both the writer and the foreground traffic
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/erase_pool/erase_pool.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static bool waitForDepth( Adesto::ErasePool::Service &service, const size_t depth )
+{
+  for ( size_t x = 0; x < 2000; x++ )
+  {
+    if ( service.depth() >= depth )
+    {
+      return true;
+    }
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+  }
+
+  return false;
+}
+
+
+static std::shared_ptr<Adesto::Sim::Device> dirtyDevice( const size_t length )
+{
+  auto sim = std::make_shared<Adesto::Sim::Device>( Adesto::Sim::Model::AT25SF081 );
+  std::vector<uint8_t> data( length, 0x00 );
+
+  sim->write( 0, data.data(), data.size() );
+  return sim;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( ErasePool ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( ErasePool, HandsOutErasedSectors )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto probe                  = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t sector         = chunkSize( probe->getDeviceProperties(), probe->getDeviceProperties().eraseChunk );
+  const ErasePool::Config cfg = { 2 * sector, 8, 3, 0 };
+
+  auto sim = dirtyDevice( 12 * sector );
+  ErasePool::Service service( sim );
+
+  CHECK( service.open( { 1, 8, 3, 0 } ) == Status::ERR_BAD_ARG );
+  CHECK( service.open( { 0, 8, 9, 0 } ) == Status::ERR_BAD_ARG );
+  CHECK( service.open( cfg ) == Status::ERR_OK );
+  CHECK( service.start() == Status::ERR_OK );
+  CHECK( waitForDepth( service, cfg.depth ) );
+
+  /*-------------------------------------------------
+  Cycle through the region several times over, each
+  sector written full before going back to the pool
+  -------------------------------------------------*/
+  std::vector<uint8_t> data( sector );
+  for ( size_t x = 0; x < ( 5 * cfg.numSectors ); x++ )
+  {
+    size_t address = 0;
+    CHECK( service.acquire( address, ErasePool::WAIT_FOREVER ) == Status::ERR_OK );
+    CHECK( address >= cfg.baseAddress );
+    CHECK( address < ( cfg.baseAddress + ( cfg.numSectors * sector ) ) );
+
+    CHECK( service.read( address, data.data(), data.size() ) == Status::ERR_OK );
+    for ( auto byte : data )
+    {
+      CHECK( byte == 0xFF );
+    }
+
+    data.assign( data.size(), static_cast<uint8_t>( x ) );
+    CHECK( service.write( address, data.data(), data.size() ) == Status::ERR_OK );
+    CHECK( service.release( address ) == Status::ERR_OK );
+    CHECK( waitForDepth( service, cfg.depth ) );
+  }
+
+  CHECK( service.release( cfg.baseAddress + 1 ) == Status::ERR_BAD_ARG );
+  CHECK( service.release( 0 ) == Status::ERR_BAD_ARG );
+
+  service.stop();
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  auto stats = service.getStats();
+  CHECK( stats.acquired == ( 5 * cfg.numSectors ) );
+  CHECK( stats.released == stats.acquired );
+  CHECK( stats.stalls == 0 );
+  CHECK( stats.failedErases == 0 );
+  CHECK( stats.erases >= stats.acquired );
+  CHECK( stats.lowWater == ( cfg.depth - 1 ) );
+}
+
+
+TEST( ErasePool, YieldsToForegroundUntilStalled )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto probe                  = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t sector         = chunkSize( probe->getDeviceProperties(), probe->getDeviceProperties().eraseChunk );
+  const ErasePool::Config cfg = { 0, 4, 2, 60 * 1000 };
+
+  auto sim = dirtyDevice( 4 * sector );
+  ErasePool::Service service( sim );
+  CHECK( service.open( cfg ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Fresh foreground traffic keeps the worker off the
+  bus for the whole holdoff
+  -------------------------------------------------*/
+  uint8_t byte = 0;
+  CHECK( service.read( 0, &byte, 1 ) == Status::ERR_OK );
+  CHECK( service.start() == Status::ERR_OK );
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+  CHECK( service.depth() == 0 );
+  CHECK( service.getStats().yields > 0 );
+  CHECK( service.getStats().erases == 0 );
+
+  /*-------------------------------------------------
+  A stalled writer overrides it
+  -------------------------------------------------*/
+  size_t address = SIZE_MAX;
+  CHECK( service.acquire( address, 5000 ) == Status::ERR_OK );
+  CHECK( address < ( cfg.numSectors * sector ) );
+  CHECK( service.getStats().stalls == 1 );
+
+  CHECK( service.read( address, &byte, 1 ) == Status::ERR_OK );
+  CHECK( byte == 0xFF );
+
+  /*-------------------------------------------------
+  Every sector held, nothing left to erase
+  -------------------------------------------------*/
+  for ( size_t x = 1; x < cfg.numSectors; x++ )
+  {
+    CHECK( service.acquire( address, 5000 ) == Status::ERR_OK );
+  }
+
+  CHECK( service.acquire( address, 10 ) == Status::ERR_TIMEOUT );
+
+  service.stop();
+  CHECK( service.acquire( address, 10 ) == Status::ERR_FAIL );
+  CHECK( service.getStats().acquired == cfg.numSectors );
+}
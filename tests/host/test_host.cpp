@@ -0,0 +1,21 @@
+/********************************************************************************
+ *  File Name:
+ *    test_host.cpp
+ *
+ *  Description:
+ *    Entry point for tests that run on the development PC against the
+ *    simulated devices. No hardware required.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* Test Framework Includes */
+#include <CppUTest/CommandLineTestRunner.h>
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  return CommandLineTestRunner::RunAllTests( argc, argv );
+}
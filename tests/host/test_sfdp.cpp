@@ -0,0 +1,180 @@
+/********************************************************************************
+ *  File Name:
+ *    test_sfdp.cpp
+ *
+ *  Description:
+ *    SFDP parsing against the tables served by the simulated parts
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sfdp/sfdp.hpp>
+#include <src/sfdp/sfdp_device.hpp>
+#include <src/sim/sim_device.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( SFDP ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( SFDP, DecodesEveryModeledPart )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    /*-------------------------------------------------
+    Initialize
+    -------------------------------------------------*/
+    const auto model = static_cast<Sim::Model>( x );
+    auto &geometry   = Sim::getGeometry( model );
+    auto &timing     = Sim::getTiming( model );
+    Sim::Device sim( model );
+
+    /*-------------------------------------------------
+    Call FUT
+    -------------------------------------------------*/
+    SFDP::Info info;
+    CHECK( SFDP::parse( Sim::readSFDP, &sim, info ) == Status::ERR_OK );
+
+    /*-------------------------------------------------
+    Verify: Geometry matches the model and the timing
+    is the modeled value rounded up by the encoding.
+    -------------------------------------------------*/
+    CHECK( info.majorRev == 1 );
+    CHECK( info.addressBytes == 3 );
+    CHECK( info.density == geometry.deviceSize );
+    CHECK( info.pageSize == geometry.pageSize );
+    CHECK( info.numEraseTypes == 3 );
+
+    auto erase4K  = SFDP::findErase( info, 4 * 1024 );
+    auto erase64K = SFDP::findErase( info, 64 * 1024 );
+    CHECK( erase4K && ( erase4K->opcode == 0x20 ) );
+    CHECK( erase64K && ( erase64K->opcode == 0xD8 ) );
+    CHECK( SFDP::findErase( info, 32 * 1024 ) != nullptr );
+
+    CHECK( info.timingValid );
+    CHECK( erase4K->typicalUs >= timing.erase4K );
+    CHECK( erase4K->maxUs > erase4K->typicalUs );
+    CHECK( info.pageProgramTypUs >= timing.pageProgram );
+    CHECK( info.chipEraseTypUs >= timing.eraseChip );
+
+    CHECK( info.reads[ static_cast<size_t>( SFDP::ReadMode::READ_1_1_1 ) ].supported );
+    CHECK( info.reads[ static_cast<size_t>( SFDP::ReadMode::READ_1_4_4 ) ].supported );
+    CHECK( info.reads[ static_cast<size_t>( SFDP::ReadMode::READ_1_4_4 ) ].opcode == 0xEB );
+
+    const bool qpi = geometry.readModes & ( 1u << static_cast<uint8_t>( SFDP::ReadMode::READ_4_4_4 ) );
+    CHECK( info.fastestRead == ( qpi ? SFDP::ReadMode::READ_4_4_4 : SFDP::ReadMode::READ_1_4_4 ) );
+    CHECK( SFDP::fastestRead( info, 1, info.pageSize ) == SFDP::ReadMode::READ_1_1_1 );
+    CHECK( SFDP::fastestRead( info, 0, info.pageSize ) == SFDP::ReadMode::UNKNOWN );
+  }
+}
+
+
+TEST( SFDP, DeviceReportsDiscoveredGeometry )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize
+  -------------------------------------------------*/
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF641 );
+  SFDP::Device dut( sim, Sim::readSFDP, sim.get() );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  CHECK( dut.open() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  auto props = dut.getDeviceProperties();
+
+  CHECK( dut.discovered() );
+  CHECK_EQUAL( sim->getDeviceProperties().jedec, props.jedec );
+  CHECK_EQUAL( 8u * 1024u * 1024u, props.endAddress );
+  CHECK_EQUAL( 4u * 1024u, props.blockSize );
+  CHECK_EQUAL( 64u * 1024u, props.sectorSize );
+  CHECK_EQUAL( 128u, props.numSectors );
+  CHECK( props.eraseChunk == Chunk::BLOCK );
+
+  dut.close();
+}
+
+
+TEST( SFDP, RejectsMissingSignature )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Call FUT: A blank SFDP space reads back as 0xFF
+  -------------------------------------------------*/
+  auto blank = []( void *context, const uint32_t address, void *const data, const size_t length ) {
+    memset( data, 0xFF, length );
+    return Status::ERR_OK;
+  };
+
+  SFDP::Info info;
+  CHECK( SFDP::parse( blank, nullptr, info ) == Status::ERR_FAIL );
+
+  /*-------------------------------------------------
+  Verify: The decorator falls back to the driver
+  -------------------------------------------------*/
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  SFDP::Device dut( sim, blank, nullptr );
+
+  CHECK( dut.open() == Status::ERR_OK );
+  CHECK_FALSE( dut.discovered() );
+  CHECK_EQUAL( sim->getDeviceProperties().endAddress, dut.getDeviceProperties().endAddress );
+}
+
+
+TEST( SFDP, MaxTimesSaturate )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: An 8 Mbit part with a 4K erase and the
+  longest chip erase and multiplier JESD216 encodes
+  -------------------------------------------------*/
+  uint32_t dwords[ SFDP::BFPT_TIMING_DWORDS ] = {};
+  dwords[ 1 ]                                 = ( 8u * 1024u * 1024u ) - 1u;
+  dwords[ 7 ]                                 = 0x200C;
+  dwords[ 9 ]                                 = 0xF;
+  dwords[ 10 ]                                = ( 0x3u << 29 ) | ( 0x1Fu << 24 ) | ( 0x8u << 4 );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  SFDP::Info info;
+  CHECK( SFDP::parseBFPT( dwords, SFDP::BFPT_TIMING_DWORDS, info ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify: 32 x 64 s x 32 doesn't fit, so it clamps
+  -------------------------------------------------*/
+  CHECK( info.timingValid );
+  CHECK( info.chipEraseTypUs == ( 32u * 64000000u ) );
+  CHECK( info.chipEraseMaxUs == std::numeric_limits<uint32_t>::max() );
+  CHECK( info.erase[ 0 ].maxUs == ( 32u * info.erase[ 0 ].typicalUs ) );
+}
@@ -0,0 +1,184 @@
+/********************************************************************************
+ *  File Name:
+ *    test_sim_endurance.cpp
+ *
+ *  Description:
+ *    Fast forward endurance model: sparse storage, wear counting, error
+ *    injection past the rating and concurrent use
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <thread>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_endurance.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( SimEndurance ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( SimEndurance, OnlyProgrammedUnitsCostMemory )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  Sim::EnduranceDevice device( Sim::Model::AT25SF641 );
+  const size_t unit = device.getGeometry().blockSize;
+
+  std::vector<uint8_t> data( unit + 64, 0x3C );
+  std::vector<uint8_t> check( data.size() );
+
+  /*-------------------------------------------------
+  Programming across a unit boundary touches two
+  -------------------------------------------------*/
+  CHECK( device.residentBytes() == 0 );
+  CHECK( device.write( 5 * unit, data.data(), data.size() ) == Status::ERR_OK );
+  CHECK( device.getStats().residentUnits == 2 );
+
+  data[ 0 ] = 0x0F;
+  CHECK( device.write( 5 * unit, data.data(), 1 ) == Status::ERR_OK );
+  CHECK( device.read( 5 * unit, check.data(), check.size() ) == Status::ERR_OK );
+  CHECK( check[ 0 ] == ( 0x3C & 0x0F ) );
+  CHECK( check[ unit + 63 ] == 0x3C );
+
+  CHECK( device.read( 100 * unit, check.data(), check.size() ) == Status::ERR_OK );
+  CHECK( check[ 0 ] == 0xFF );
+  CHECK( check[ unit ] == 0xFF );
+
+  /*-------------------------------------------------
+  Erasing hands the memory back
+  -------------------------------------------------*/
+  CHECK( device.erase( 5 * unit, unit / 2 ) == Status::ERR_BAD_ARG );
+  CHECK( device.erase( 5 * unit, 2 * unit ) == Status::ERR_OK );
+  CHECK( device.residentBytes() == 0 );
+  CHECK( device.getStats().peakResidentUnits == 2 );
+  CHECK( device.eraseCount( 5 ) == 1 );
+  CHECK( device.eraseCount( 6 ) == 1 );
+  CHECK( device.eraseCount( 7 ) == 0 );
+
+  CHECK( device.read( 5 * unit, check.data(), check.size() ) == Status::ERR_OK );
+  CHECK( check[ 0 ] == 0xFF );
+}
+
+
+TEST( SimEndurance, InjectsErrorsPastRating )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  const Sim::EnduranceProfile profile = { 50, 1e-2, 1234 };
+  Sim::EnduranceDevice device( Sim::getGeometry( Sim::Model::AT25SF081 ), profile );
+  const size_t unit = device.getGeometry().blockSize;
+
+  std::vector<uint8_t> data( unit, 0xA5 );
+  std::vector<uint8_t> check( unit );
+  size_t corrupt = 0;
+
+  for ( size_t cycle = 1; cycle <= 200; cycle++ )
+  {
+    CHECK( device.erase( 0, unit ) == Status::ERR_OK );
+    CHECK( device.write( 0, data.data(), data.size() ) == Status::ERR_OK );
+    CHECK( device.read( 0, check.data(), check.size() ) == Status::ERR_OK );
+
+    /*-------------------------------------------------
+    Clean right up to the rating, then degrading
+    -------------------------------------------------*/
+    if ( cycle <= profile.ratedCycles )
+    {
+      CHECK( check == data );
+      CHECK( device.getStats().bitErrors == 0 );
+    }
+
+    corrupt += ( check != data );
+  }
+
+  CHECK( corrupt > 100 );
+  CHECK( device.getStats().bitErrors > corrupt );
+
+  /*-------------------------------------------------
+  Projection for the run
+  -------------------------------------------------*/
+  const auto projection = device.project( 200 * data.size(), 3 );
+  CHECK( projection.maxErases == 200 );
+  CHECK( projection.minErases == 0 );
+  CHECK( projection.unitsPastRating == 1 );
+  CHECK( projection.lifetimeHostBytes == ( 50 * data.size() ) );
+  CHECK( projection.remainingHostBytes == 0 );
+  CHECK( projection.writeAmplification == 1.0 );
+  CHECK( projection.hottest.size() == 3 );
+  CHECK( projection.hottest[ 0 ].unit == 0 );
+  CHECK( projection.hottest[ 1 ].erases == 0 );
+}
+
+
+TEST( SimEndurance, CountsExactlyAcrossThreads )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  static constexpr size_t THREADS = 4;
+  static constexpr size_t CYCLES  = 5000;
+
+  Sim::EnduranceDevice device( Sim::Model::AT25SF081 );
+  const size_t unit = device.getGeometry().blockSize;
+
+  /*-------------------------------------------------
+  Each thread cycles its own unit plus a shared one
+  -------------------------------------------------*/
+  std::vector<std::thread> threads;
+  std::vector<size_t> mismatches( THREADS, 0 );
+
+  for ( size_t x = 0; x < THREADS; x++ )
+  {
+    threads.emplace_back( [ &, x ]() {
+      std::vector<uint8_t> data( 256, static_cast<uint8_t>( x ) );
+      std::vector<uint8_t> check( data.size() );
+      const size_t address = ( x + 1 ) * unit;
+
+      for ( size_t cycle = 0; cycle < CYCLES; cycle++ )
+      {
+        device.erase( address, unit );
+        device.write( address, data.data(), data.size() );
+        device.read( address, check.data(), check.size() );
+        device.erase( 0, unit );
+
+        mismatches[ x ] += ( check != data );
+      }
+    } );
+  }
+
+  for ( auto &thread : threads )
+  {
+    thread.join();
+  }
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( device.eraseCount( 0 ) == ( THREADS * CYCLES ) );
+  for ( size_t x = 0; x < THREADS; x++ )
+  {
+    CHECK( device.eraseCount( x + 1 ) == CYCLES );
+    CHECK( mismatches[ x ] == 0 );
+  }
+
+  const auto stats = device.getStats();
+  CHECK( stats.erases == ( 2 * THREADS * CYCLES ) );
+  CHECK( stats.writes == ( THREADS * CYCLES ) );
+  CHECK( stats.reads == ( THREADS * CYCLES ) );
+  CHECK( stats.bytesProgrammed == ( THREADS * CYCLES * 256 ) );
+  CHECK( stats.residentUnits == THREADS );
+}
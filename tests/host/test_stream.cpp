@@ -0,0 +1,178 @@
+/********************************************************************************
+ *  File Name:
+ *    test_stream.cpp
+ *
+ *  Description:
+ *    Continuous read streaming against the simulated parts
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/stream/stream.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static std::array<uint8_t, 3 * 1000> ringBuffer; /**< Deliberately not a multiple of the page size */
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static bool copySink( void *context, const size_t address, const uint8_t *const data, const size_t length )
+{
+  auto image = static_cast<std::vector<uint8_t> *>( context );
+  memcpy( image->data() + address, data, length );
+  return true;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Stream ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Stream, DumpsWholeDeviceInOneCommand )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Scatter some data across the part
+  -------------------------------------------------*/
+  Sim::Device sim( Sim::Model::AT25SF081 );
+  auto props            = sim.getDeviceProperties();
+  const size_t chipSize = props.pageSize * props.numPages;
+
+  std::vector<uint8_t> page( props.pageSize );
+  for ( size_t x = 0; x < props.numPages; x += 37 )
+  {
+    memset( page.data(), static_cast<int>( x ), page.size() );
+    CHECK( sim.write( chunkStartAddress( props, Chunk::PAGE, x ), page.data(), page.size() ) == Status::ERR_OK );
+  }
+
+  std::vector<uint8_t> expected( chipSize );
+  CHECK( sim.read( 0, expected.data(), chipSize ) == Status::ERR_OK );
+  sim.clearStats();
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  std::vector<uint8_t> image( chipSize );
+  Stream::Buffers ring = { ringBuffer.data(), ringBuffer.size() / 3, 3 };
+
+  const uint64_t start = sim.now();
+  CHECK( Stream::read( Sim::streamTransport(), &sim, 0, chipSize, ring, copySink, &image ) == Status::ERR_OK );
+  const uint64_t elapsed = sim.now() - start;
+
+  /*-------------------------------------------------
+  Verify: Same bytes, one command, and no more time
+  than the bus needs plus a single command overhead.
+  -------------------------------------------------*/
+  auto &timing = Sim::getTiming( Sim::Model::AT25SF081 );
+  auto stats   = sim.getStats();
+
+  CHECK( memcmp( image.data(), expected.data(), chipSize ) == 0 );
+  CHECK_EQUAL( 1, stats.reads );
+  CHECK_EQUAL( chipSize, stats.bytesRead );
+  CHECK( elapsed <= timing.commandOverhead + ( ( chipSize * 8u * 1000000u ) / timing.busClockHz ) );
+}
+
+
+TEST( Stream, CRCMatchesPageReads )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  Sim::Device sim( Sim::Model::AT25SF081 );
+  auto props = sim.getDeviceProperties();
+
+  std::vector<uint8_t> page( props.pageSize );
+  for ( size_t x = 0; x < page.size(); x++ )
+  {
+    page[ x ] = static_cast<uint8_t>( x * 7 );
+  }
+  CHECK( sim.write( 0x1234 & ~( props.pageSize - 1 ), page.data(), page.size() ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Reference over page reads, starting mid-page
+  -------------------------------------------------*/
+  const size_t address = 0x1000 + 17;
+  const size_t length  = 64 * 1024 + 5;
+  uint32_t expected    = 0;
+
+  for ( size_t offset = 0; offset < length; offset += page.size() )
+  {
+    const size_t chunk = std::min( page.size(), length - offset );
+    CHECK( sim.read( address + offset, page.data(), chunk ) == Status::ERR_OK );
+    expected = Stream::crc32Update( expected, page.data(), chunk );
+  }
+
+  /*-------------------------------------------------
+  Both transports, single and double buffered
+  -------------------------------------------------*/
+  for ( size_t count = 1; count <= 2; count++ )
+  {
+    Stream::Buffers ring = { ringBuffer.data(), ringBuffer.size() / count, count };
+    uint32_t crc         = 0;
+
+    CHECK( Stream::crc32( Sim::streamTransport(), &sim, address, length, ring, crc ) == Status::ERR_OK );
+    CHECK_EQUAL( expected, crc );
+
+    Stream::DeviceContext device = { &sim, 0 };
+    CHECK( Stream::crc32( Stream::deviceTransport(), &device, address, length, ring, crc ) == Status::ERR_OK );
+    CHECK_EQUAL( expected, crc );
+  }
+
+  /*-------------------------------------------------
+  Known answer for the polynomial
+  -------------------------------------------------*/
+  const char *check = "123456789";
+  CHECK_EQUAL( 0xCBF43926u, Stream::crc32Update( 0, reinterpret_cast<const uint8_t *>( check ), 9 ) );
+}
+
+
+TEST( Stream, VerifyStopsAtFirstMismatch )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  Sim::Device sim( Sim::Model::AT25SF081 );
+  auto props            = sim.getDeviceProperties();
+  const size_t chipSize = props.pageSize * props.numPages;
+  Stream::Buffers ring  = { ringBuffer.data(), ringBuffer.size() / 2, 2 };
+  size_t mismatch       = 0;
+
+  CHECK( Stream::verify( Sim::streamTransport(), &sim, 0, chipSize, ring, 0xFF, mismatch ) == Status::ERR_OK );
+  CHECK_EQUAL( Stream::NO_MISMATCH, mismatch );
+
+  /*-------------------------------------------------
+  Clear one byte well into the part. The stream has
+  to end there, with the part deselected again.
+  -------------------------------------------------*/
+  const size_t bad   = ( chipSize / 2 ) + 3;
+  const uint8_t zero = 0;
+  CHECK( sim.write( bad, &zero, 1 ) == Status::ERR_OK );
+  sim.clearStats();
+
+  CHECK( Stream::verify( Sim::streamTransport(), &sim, 0, chipSize, ring, 0xFF, mismatch ) == Status::ERR_FAIL );
+  CHECK_EQUAL( bad, mismatch );
+  CHECK( sim.getStats().bytesRead < chipSize );
+  CHECK( sim.beginStream( 0 ) == Status::ERR_OK );
+  sim.endStream();
+}
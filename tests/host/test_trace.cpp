@@ -0,0 +1,273 @@
+/********************************************************************************
+ *  File Name:
+ *    test_trace.cpp
+ *
+ *  Description:
+ *    Trace recorder framing, drop accounting, the recording decorator and
+ *    paced replay, all on the host
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <memory>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/trace/trace_buffer.hpp>
+#include <src/trace/trace_device.hpp>
+#include <src/trace/trace_reader.hpp>
+#include <src/trace/trace_replay.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static std::vector<uint8_t> sCapture;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static void captureSink( const void *const data, const size_t length )
+{
+  auto bytes = reinterpret_cast<const uint8_t *>( data );
+  sCapture.insert( sCapture.end(), bytes, bytes + length );
+}
+
+
+static void vectorSink( void *context, const void *const data, const size_t length )
+{
+  auto bytes = reinterpret_cast<const uint8_t *>( data );
+  auto out   = static_cast<std::vector<uint8_t> *>( context );
+  out->insert( out->end(), bytes, bytes + length );
+}
+
+
+static uint64_t simClock( void *context )
+{
+  return static_cast<Adesto::Sim::Device *>( context )->now();
+}
+
+
+static void simIdle( void *context, const uint64_t us )
+{
+  static_cast<Adesto::Sim::Device *>( context )->advance( us );
+}
+
+
+static std::vector<Adesto::Trace::Record> parseAll( const std::vector<uint8_t> &stream )
+{
+  using namespace Adesto::Trace;
+
+  std::vector<Record> records;
+  parseStream( stream.data(), stream.size(), [ & ]( const Record &rec ) { records.push_back( rec ); } );
+  return records;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( TraceBuffer )
+{
+  void setup()
+  {
+    sCapture.clear();
+    Adesto::Trace::enable( true );
+    Adesto::Trace::drain( captureSink );
+    sCapture.clear();
+  }
+};
+
+TEST_GROUP( TraceDevice ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( TraceBuffer, PairsBeginWithEnd )
+{
+  using namespace Adesto::Trace;
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  const uint8_t first  = begin( Operation::WRITE, 0x100, 256 );
+  const uint8_t second = begin( Operation::READ, 0x100, 256 );
+  end( second, Operation::READ, 0x100, 256, 0 );
+  end( first, Operation::WRITE, 0x100, 256, 0 );
+
+  CHECK( first != second );
+  CHECK( pending() == 4 );
+  CHECK( drain( captureSink ) == 4 );
+  CHECK( pending() == 0 );
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  std::vector<Record> records;
+  auto stats = parseStream( sCapture.data(), sCapture.size(), [ & ]( const Record &rec ) { records.push_back( rec ); } );
+
+  CHECK( stats.frames == 1 );
+  CHECK( stats.rejected == 0 );
+  CHECK( records.size() == 4 );
+  CHECK( records[ 0 ].sequence == records[ 3 ].sequence );
+  CHECK( records[ 1 ].sequence == records[ 2 ].sequence );
+  CHECK( records[ 3 ].phase == static_cast<uint8_t>( Phase::END ) );
+  CHECK( records[ 3 ].timestamp >= records[ 0 ].timestamp );
+}
+
+
+TEST( TraceBuffer, CountsDropsWhenFull )
+{
+  using namespace Adesto::Trace;
+
+  /*-------------------------------------------------
+  Overfill the ring without draining
+  -------------------------------------------------*/
+  const size_t before = dropped();
+
+  for ( size_t x = 0; x < BUFFER_DEPTH + 10; x++ )
+  {
+    mark( static_cast<uint32_t>( x ) );
+  }
+
+  CHECK( dropped() > before );
+
+  /*-------------------------------------------------
+  Everything that fit comes out intact and in order
+  -------------------------------------------------*/
+  const size_t kept = drain( captureSink );
+  CHECK( kept + ( dropped() - before ) == BUFFER_DEPTH + 10 );
+
+  uint32_t expect = 0;
+  auto stats      = parseStream( sCapture.data(), sCapture.size(), [ & ]( const Record &rec ) {
+    CHECK( rec.address == expect );
+    expect++;
+  } );
+
+  CHECK( stats.records == kept );
+  CHECK( stats.rejected == 0 );
+}
+
+
+TEST( TraceBuffer, DisabledRecorderIsSilent )
+{
+  using namespace Adesto::Trace;
+
+  enable( false );
+  mark( 1 );
+  enable( true );
+
+  CHECK( pending() == 0 );
+}
+
+
+TEST( TraceDevice, RecordersKeepSeparateStreams )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Two recorders on their own devices
+  -------------------------------------------------*/
+  auto simA = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  auto simB = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  std::vector<uint8_t> captureA;
+  std::vector<uint8_t> captureB;
+
+  Trace::RecordingDevice devA( simA, vectorSink, &captureA, simClock, simA.get() );
+  Trace::RecordingDevice devB( simB, vectorSink, &captureB, simClock, simB.get() );
+  CHECK( devA.open() == Status::ERR_OK );
+  CHECK( devB.open() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Call FUT
+  -------------------------------------------------*/
+  std::array<uint8_t, 256> data;
+  data.fill( 0x3C );
+
+  CHECK( devA.erase( 0, 4096 ) == Status::ERR_OK );
+  CHECK( devA.pendEvent( Event::MEM_ERASE_COMPLETE, 1000 ) == Status::ERR_OK );
+  CHECK( devA.write( 0, data.data(), data.size() ) == Status::ERR_OK );
+  CHECK( devA.pendEvent( Event::MEM_WRITE_COMPLETE, 1000 ) == Status::ERR_OK );
+  CHECK( devB.read( 0x100, data.data(), data.size() ) == Status::ERR_OK );
+  CHECK( devA.read( 0, data.data(), data.size() ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify: Nothing reaches the sink until a frame fills
+  or the recorder is flushed
+  -------------------------------------------------*/
+  CHECK( captureA.empty() );
+  CHECK( devA.close() == Status::ERR_OK );
+  CHECK( devB.close() == Status::ERR_OK );
+
+  auto recA = parseAll( captureA );
+  auto recB = parseAll( captureB );
+
+  CHECK( recA.size() == 6 );
+  CHECK( recB.size() == 2 );
+  CHECK( recA[ 0 ].operation == static_cast<uint8_t>( Trace::Operation::ERASE ) );
+  CHECK( recA[ 1 ].phase == static_cast<uint8_t>( Trace::Phase::END ) );
+  CHECK( recA[ 1 ].timestamp > recA[ 0 ].timestamp );
+  CHECK( recA[ 4 ].sequence == recA[ 5 ].sequence );
+  CHECK( recB[ 0 ].address == 0x100 );
+  CHECK( recB[ 1 ].status == static_cast<uint8_t>( Status::ERR_OK ) );
+}
+
+
+TEST( TraceDevice, PacedReplayKeepsIdleTime )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  /*-------------------------------------------------
+  Initialize: Two reads 10 ms apart
+  -------------------------------------------------*/
+  std::vector<Trace::Record> records;
+  for ( uint32_t x = 0; x < 2; x++ )
+  {
+    const uint32_t begin = x * 10000;
+    records.push_back( { begin, 0, 256, static_cast<uint8_t>( Trace::Operation::READ ),
+                         static_cast<uint8_t>( Trace::Phase::BEGIN ), 0, static_cast<uint8_t>( x ) } );
+    records.push_back( { begin + 100, 0, 256, static_cast<uint8_t>( Trace::Operation::READ ),
+                         static_cast<uint8_t>( Trace::Phase::END ), 0, static_cast<uint8_t>( x ) } );
+  }
+
+  std::array<uint8_t, 256> scratch;
+  auto result = std::make_unique<Trace::ReplayResult>();
+  uint64_t elapsed[ 2 ];
+
+  /*-------------------------------------------------
+  Call FUT: Back to back, then paced
+  -------------------------------------------------*/
+  for ( size_t paced = 0; paced < 2; paced++ )
+  {
+    auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+    CHECK( sim->open() == Status::ERR_OK );
+
+    Trace::ReplayConfig cfg;
+    cfg.clock         = simClock;
+    cfg.clockContext  = sim.get();
+    cfg.idle          = paced ? simIdle : nullptr;
+    cfg.idleContext   = sim.get();
+    cfg.scratch       = scratch.data();
+    cfg.scratchSize   = scratch.size();
+    cfg.addressOffset = 0;
+
+    CHECK( Trace::replay( records.data(), records.size(), *sim, cfg, *result ) == Status::ERR_OK );
+    CHECK( result->replayed == 2 );
+    elapsed[ paced ] = result->elapsed;
+  }
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  CHECK( elapsed[ 0 ] < 9900 );
+  CHECK( elapsed[ 1 ] >= ( elapsed[ 0 ] + 9900 ) );
+}
@@ -0,0 +1,218 @@
+/********************************************************************************
+ *  File Name:
+ *    test_txn.cpp
+ *
+ *  Description:
+ *    Transactional update store against the simulated parts, including power
+ *    loss at every step of a transaction
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <memory>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/txn/txn.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static Aurora::Memory::Status updateAll( Adesto::Txn::Store &store, const uint8_t value, const size_t length )
+{
+  using namespace Aurora::Memory;
+
+  std::vector<uint8_t> data( length, value );
+  auto result = store.begin();
+
+  for ( size_t slot = 0; ( slot < store.numSlots() ) && ( result == Status::ERR_OK ); slot++ )
+  {
+    result = store.write( slot, data.data(), data.size() );
+  }
+
+  return ( result == Status::ERR_OK ) ? store.commit() : result;
+}
+
+
+static bool slotHolds( Adesto::Txn::Store &store, const size_t slot, const uint8_t value, const size_t length )
+{
+  std::vector<uint8_t> data( length );
+  if ( store.read( slot, 0, data.data(), data.size() ) != Aurora::Memory::Status::ERR_OK )
+  {
+    return false;
+  }
+
+  for ( auto byte : data )
+  {
+    if ( byte != value )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ *  Cuts power at each step of one update in turn, after `history` updates
+ *  have been committed, until a run gets all the way through. Returns the
+ *  number of steps the update took and the commit area swaps seen by the
+ *  run that completed.
+ */
+static size_t cutPowerAtEachStep( const Adesto::Txn::Config &config, const size_t history, size_t &swaps )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  const uint8_t before = 0xA1;
+  const uint8_t after  = 0x5E;
+
+  size_t step = 0;
+  for ( ; step < 1000; step++ )
+  {
+    auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+    Txn::Store store( sim );
+
+    CHECK( store.open( config ) == Status::ERR_OK );
+    for ( size_t x = 0; x < history; x++ )
+    {
+      CHECK( updateAll( store, before, config.slotSize ) == Status::ERR_OK );
+    }
+
+    sim->armPowerLoss( step );
+    const bool completed = ( updateAll( store, after, config.slotSize ) == Status::ERR_OK ) && !sim->powerLost();
+    sim->disarmPowerLoss();
+    sim->powerOn();
+
+    /*-------------------------------------------------
+    Every slot agrees on which version survived
+    -------------------------------------------------*/
+    Txn::Store recovered( sim );
+    CHECK( recovered.open( config ) == Status::ERR_OK );
+
+    const uint8_t expect = slotHolds( recovered, 0, after, config.slotSize ) ? after : before;
+    for ( size_t slot = 0; slot < config.numSlots; slot++ )
+    {
+      CHECK( slotHolds( recovered, slot, expect, config.slotSize ) );
+    }
+
+    if ( completed )
+    {
+      CHECK( expect == after );
+      swaps = store.getStats().swaps;
+      break;
+    }
+  }
+
+  return step;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Txn ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Txn, AllOrNothingUnderPowerLoss )
+{
+  using namespace Adesto;
+
+  const Txn::Config config = { 0, 3, 6000 };
+  size_t swaps             = 0;
+  const size_t steps       = cutPowerAtEachStep( config, 1, swaps );
+
+  CHECK( steps > ( 2 * config.numSlots ) );
+  CHECK( steps < 1000 );
+  CHECK( swaps == 0 );
+}
+
+
+TEST( Txn, AllOrNothingWhenCommitAreaSwaps )
+{
+  using namespace Adesto;
+
+  auto sim                 = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t perUnit     = sim->getDeviceProperties().blockSize / Txn::RECORD_SIZE;
+  const Txn::Config config = { 0, 2, 256 };
+
+  /*-------------------------------------------------
+  The final update is the first record past a full
+  commit unit: once moving to the blank unit, once
+  wrapping back over the oldest records.
+  -------------------------------------------------*/
+  for ( size_t wraps = 1; wraps <= Txn::COMMIT_UNITS; wraps++ )
+  {
+    size_t swaps       = 0;
+    const size_t steps = cutPowerAtEachStep( config, wraps * perUnit, swaps );
+
+    CHECK( steps > ( ( 2 * config.numSlots ) + 1 ) );
+    CHECK( steps < 1000 );
+    CHECK_EQUAL( wraps, swaps );
+  }
+}
+
+
+TEST( Txn, RecoveryOnlyReadsCommitArea )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim                 = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  const size_t unit        = sim->getDeviceProperties().blockSize;
+  const size_t commits     = 3 * ( unit / Txn::RECORD_SIZE );
+  const Txn::Config config = { 4 * unit, 8, 256 };
+
+  /*-------------------------------------------------
+  Enough commits to wrap the commit area twice over
+  -------------------------------------------------*/
+  Txn::Store store( sim );
+  CHECK( store.open( config ) == Status::ERR_OK );
+
+  std::vector<uint8_t> data( config.slotSize );
+  for ( size_t x = 0; x < commits; x++ )
+  {
+    const size_t slot = x % config.numSlots;
+    data.assign( data.size(), static_cast<uint8_t>( x ) );
+
+    CHECK( store.begin() == Status::ERR_OK );
+    CHECK( store.write( slot, data.data(), data.size() ) == Status::ERR_OK );
+    CHECK( store.write( slot, data.data(), data.size() ) == Status::ERR_BAD_ARG );
+    CHECK( store.commit() == Status::ERR_OK );
+  }
+
+  CHECK( store.getStats().swaps >= 2 );
+  CHECK( store.write( 0, data.data(), data.size() ) == Status::ERR_FAIL );
+
+  /*-------------------------------------------------
+  An aborted update leaves the committed data alone
+  -------------------------------------------------*/
+  data.assign( data.size(), 0x00 );
+  CHECK( store.begin() == Status::ERR_OK );
+  CHECK( store.write( 0, data.data(), data.size() ) == Status::ERR_OK );
+  store.abort();
+
+  /*-------------------------------------------------
+  Verify
+  -------------------------------------------------*/
+  Txn::Store recovered( sim );
+  CHECK( recovered.open( config ) == Status::ERR_OK );
+  CHECK( recovered.getStats().recoveryReads <= ( Txn::COMMIT_UNITS * unit ) );
+  CHECK( recovered.sequence() == commits );
+
+  for ( size_t slot = 0; slot < config.numSlots; slot++ )
+  {
+    const size_t last = commits - config.numSlots + slot;
+    CHECK( slotHolds( recovered, slot, static_cast<uint8_t>( last ), config.slotSize ) );
+  }
+}
@@ -0,0 +1,282 @@
+/********************************************************************************
+ *  File Name:
+ *    test_wear.cpp
+ *
+ *  Description:
+ *    Wear aware allocator against the simulated parts
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/stream/stream.hpp>
+#include <src/wear/wear.hpp>
+
+/* CppUTest Includes  */
+#include <CppUTest/TestHarness.h>
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static std::vector<size_t> owners; /**< Unit index -> tag of the data stored there */
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static Adesto::Wear::Config makeConfig( const bool relocate )
+{
+  Adesto::Wear::Config config;
+  config.bucketSize      = Adesto::Wear::DEFAULT_BUCKET_SIZE;
+  config.staticThreshold = Adesto::Wear::DEFAULT_THRESHOLD;
+  config.staticInterval  = Adesto::Wear::DEFAULT_INTERVAL;
+  config.relocate        = nullptr;
+  config.relocateContext = nullptr;
+
+  if ( relocate )
+  {
+    config.relocate = []( void *context, const size_t from, const size_t to ) {
+      owners[ to ]   = owners[ from ];
+      owners[ from ] = 0;
+    };
+  }
+
+  return config;
+}
+
+/*-------------------------------------------------------------------------------
+Base Test Groups
+-------------------------------------------------------------------------------*/
+TEST_GROUP( Wear ){};
+
+/*-------------------------------------------------
+Test Cases
+-------------------------------------------------*/
+TEST( Wear, HandsOutLeastWornAndPersists )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  Wear::Allocator allocator( sim );
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+  CHECK( allocator.freeUnits() == allocator.numUnits() - allocator.firstUnit() );
+
+  /*-------------------------------------------------
+  Every unit handed out is within a bucket of the
+  least worn one, even while one unit is kept busy.
+  -------------------------------------------------*/
+  size_t held = 0;
+  CHECK( allocator.allocate( held ) == Status::ERR_OK );
+
+  for ( size_t x = 0; x < 1000; x++ )
+  {
+    const uint32_t least = allocator.minEraseCount();
+
+    size_t unit = 0;
+    CHECK( allocator.allocate( unit ) == Status::ERR_OK );
+    CHECK( unit != held );
+    CHECK( ( allocator.eraseCount( unit ) - 1 ) < ( least + Wear::DEFAULT_BUCKET_SIZE ) );
+    CHECK( allocator.eraseCount( unit ) <= sim->eraseCount( unit ) );
+    CHECK( allocator.release( unit ) == Status::ERR_OK );
+  }
+
+  CHECK( allocator.release( held ) == Status::ERR_OK );
+  CHECK( allocator.release( held ) == Status::ERR_BAD_ARG );
+  CHECK( allocator.allocate( held ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  A fresh open picks up the counts and states
+  -------------------------------------------------*/
+  std::vector<uint32_t> counts;
+  for ( size_t unit = 0; unit < allocator.numUnits(); unit++ )
+  {
+    counts.push_back( allocator.eraseCount( unit ) );
+  }
+
+  CHECK( allocator.close() == Status::ERR_OK );
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+  CHECK( allocator.isUsed( held ) );
+  CHECK( allocator.freeUnits() == allocator.numUnits() - allocator.firstUnit() - 1 );
+
+  for ( size_t unit = allocator.firstUnit(); unit < allocator.numUnits(); unit++ )
+  {
+    CHECK_EQUAL( counts[ unit ], allocator.eraseCount( unit ) );
+  }
+}
+
+
+TEST( Wear, SurvivesTornTableWrite )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  Wear::Allocator allocator( sim );
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+
+  size_t unit = 0;
+  CHECK( allocator.allocate( unit ) == Status::ERR_OK );
+  CHECK( allocator.sync() == Status::ERR_OK );
+  CHECK( allocator.sync() == Status::ERR_OK );
+  CHECK( allocator.close() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Wipe the copy written last, as if power was lost
+  right after erasing it.
+  -------------------------------------------------*/
+  const size_t copyUnits = allocator.firstUnit() / 2;
+  const size_t lastCopy  = ( allocator.getStats().tableWrites % 2 ) ? 0 : 1;
+  CHECK( sim->erase( lastCopy * copyUnits * allocator.unitSize(), copyUnits * allocator.unitSize() ) == Status::ERR_OK );
+
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+  CHECK( allocator.isUsed( unit ) );
+  CHECK( allocator.eraseCount( unit ) == 1 );
+}
+
+
+TEST( Wear, TableKeepsLargeWearGaps )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  Wear::Allocator allocator( sim );
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+
+  const size_t numUnits  = allocator.numUnits();
+  const size_t unitSize  = allocator.unitSize();
+  const size_t worn      = allocator.firstUnit() + 1;
+  const uint32_t gap     = 40000; /**< Past what a 15-bit delta could hold */
+  const uint32_t tableAt = 70000;
+  CHECK( allocator.close() == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Initialize: Plant a table where one unit and the
+  table copies sit far above the rest, as years of
+  syncs would leave it
+  -------------------------------------------------*/
+  std::vector<uint32_t> counts( numUnits, 0 );
+  for ( size_t unit = 0; unit < allocator.firstUnit(); unit++ )
+  {
+    counts[ unit ] = tableAt;
+  }
+  counts[ worn ] = gap;
+
+  std::vector<uint8_t> table( Wear::TABLE_HEADER_SIZE + ( Wear::ENTRY_SIZE * numUnits ), 0 );
+  auto put = [ & ]( const size_t offset, const uint32_t value ) { memcpy( &table[ offset ], &value, sizeof( value ) ); };
+
+  put( 0, Wear::TABLE_MAGIC );
+  put( 4, 1 );
+  put( 8, 0 );
+  put( 12, static_cast<uint32_t>( numUnits ) );
+  for ( size_t unit = 0; unit < numUnits; unit++ )
+  {
+    put( Wear::TABLE_HEADER_SIZE + ( Wear::ENTRY_SIZE * unit ), counts[ unit ] );
+  }
+
+  uint32_t crc = Stream::crc32Update( 0, table.data(), 16 );
+  crc          = Stream::crc32Update( crc, table.data() + Wear::TABLE_HEADER_SIZE, table.size() - Wear::TABLE_HEADER_SIZE );
+  put( 16, crc );
+
+  const size_t pageSize = sim->getDeviceProperties().pageSize;
+  CHECK( sim->erase( 0, allocator.firstUnit() * unitSize ) == Status::ERR_OK );
+  for ( size_t offset = 0; offset < table.size(); offset += pageSize )
+  {
+    const size_t chunk = std::min( pageSize, table.size() - offset );
+    CHECK( sim->write( offset, table.data() + offset, chunk ) == Status::ERR_OK );
+  }
+
+  /*-------------------------------------------------
+  Call FUT: Load it, write it back, load it again
+  -------------------------------------------------*/
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+  CHECK( allocator.eraseCount( worn ) == gap );
+  CHECK( allocator.sync() == Status::ERR_OK );
+  CHECK( allocator.close() == Status::ERR_OK );
+  CHECK( allocator.open( makeConfig( false ) ) == Status::ERR_OK );
+
+  /*-------------------------------------------------
+  Verify: Nothing clamped, and the table units' wear
+  is reported rather than hidden behind firstUnit()
+  -------------------------------------------------*/
+  CHECK( allocator.eraseCount( worn ) == gap );
+  CHECK( allocator.maxEraseCount() == gap );
+  CHECK( allocator.minEraseCount() == 0 );
+  CHECK( allocator.tableEraseCount() > tableAt );
+}
+
+
+TEST( Wear, MovesColdDataOffFreshUnits )
+{
+  using namespace Adesto;
+  using namespace Aurora::Memory;
+
+  auto sim = std::make_shared<Sim::Device>( Sim::Model::AT25SF081 );
+  Wear::Allocator allocator( sim );
+  CHECK( allocator.open( makeConfig( true ) ) == Status::ERR_OK );
+  owners.assign( allocator.numUnits(), 0 );
+
+  /*-------------------------------------------------
+  Fill most of the part with data that never changes,
+  tagging each unit so moves can be checked.
+  -------------------------------------------------*/
+  std::vector<uint8_t> page( sim->getDeviceProperties().pageSize );
+  const size_t coldUnits = ( allocator.freeUnits() * 3 ) / 4;
+
+  for ( size_t tag = 1; tag <= coldUnits; tag++ )
+  {
+    size_t unit = 0;
+    CHECK( allocator.allocate( unit ) == Status::ERR_OK );
+    memset( page.data(), static_cast<int>( tag ), page.size() );
+    CHECK( sim->write( allocator.unitAddress( unit ), page.data(), page.size() ) == Status::ERR_OK );
+    owners[ unit ] = tag;
+  }
+
+  /*-------------------------------------------------
+  Churn one hot unit through the rest
+  -------------------------------------------------*/
+  size_t hot = 0;
+  CHECK( allocator.allocate( hot ) == Status::ERR_OK );
+
+  for ( size_t x = 0; x < 20000; x++ )
+  {
+    size_t next = 0;
+    CHECK( allocator.allocate( next ) == Status::ERR_OK );
+    CHECK( allocator.release( hot ) == Status::ERR_OK );
+    hot = next;
+  }
+
+  /*-------------------------------------------------
+  Verify: Cold data moved intact, and wear is spread
+  over the whole part instead of the free quarter.
+  -------------------------------------------------*/
+  CHECK( allocator.getStats().relocations > 0 );
+  CHECK( ( allocator.maxEraseCount() - allocator.minEraseCount() ) <= ( 2 * Wear::DEFAULT_THRESHOLD ) );
+
+  size_t found = 0;
+  for ( size_t unit = allocator.firstUnit(); unit < allocator.numUnits(); unit++ )
+  {
+    if ( !owners[ unit ] )
+    {
+      continue;
+    }
+
+    found++;
+    CHECK( allocator.isUsed( unit ) );
+    CHECK( sim->read( allocator.unitAddress( unit ), page.data(), page.size() ) == Status::ERR_OK );
+    CHECK( page[ 0 ] == static_cast<uint8_t>( owners[ unit ] ) );
+    CHECK( page[ page.size() - 1 ] == static_cast<uint8_t>( owners[ unit ] ) );
+  }
+
+  CHECK_EQUAL( coldUnits, found );
+}
@@ -0,0 +1,543 @@
+/********************************************************************************
+ *  File Name:
+ *    perf_gate.cpp
+ *
+ *  Description:
+ *    Performance regression gate for the host build. Runs a fixed suite of
+ *    operations against the simulator and compares two numbers per benchmark
+ *    to a checked-in baseline:
+ *      - Device time on the simulator's virtual clock: throughput for the
+ *        transfer benchmarks, microseconds per call for the mount. Either is
+ *        deterministic, so the tolerance can be tight and any regression
+ *        means more device time for the same work.
+ *      - Host CPU time per operation, best of several runs, as a ratio to a
+ *        memcpy reference loop timed alongside it in the same run. Catches
+ *        overhead added to the software path. Dividing by the reference
+ *        cancels most of the difference between machines and clock speeds,
+ *        but a shared host still swings it by a third now and then.
+ *
+ *    Usage: perf_gate --baseline FILE [--update] [--gate-cpu]
+ *
+ *    Exits non-zero if any benchmark's simulated time regressed past its
+ *    tolerance. CPU time is only reported, with WARN past its tolerance,
+ *    unless --gate-cpu makes that a failure too; a CPU regression then only
+ *    counts if it survives a few re-measurements. The CPU baseline is taken
+ *    from an optimized build. With --update, the measured values are
+ *    written back to the baseline file.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Aurora Includes */
+#include <Aurora/memory>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/stream/stream.hpp>
+#include <src/wear/wear.hpp>
+
+using namespace Adesto;
+using namespace Aurora::Memory;
+
+/*-------------------------------------------------------------------------------
+Constants
+-------------------------------------------------------------------------------*/
+static constexpr Sim::Model MODEL       = Sim::Model::AT25SF081;
+static constexpr size_t REPETITIONS     = 25;
+static constexpr double DEFAULT_SIM_TOL = 1.0;   /**< Percent */
+static constexpr double DEFAULT_CPU_TOL = 25.0;  /**< Percent */
+static constexpr size_t STREAM_BUFFER   = 1024;
+static constexpr size_t REF_BLOCK       = 4096; /**< Bytes per reference op */
+static constexpr size_t REF_OPS         = 2048;
+static constexpr size_t CPU_RETRIES     = 3;   /**< Re-measures before a CPU regression counts */
+static constexpr size_t RETRY_PAUSE_MS  = 500;
+static constexpr size_t WRITE_REGION    = 256 * 1024;
+static constexpr size_t ERASE_REGION    = 1024 * 1024;
+
+/*-------------------------------------------------------------------------------
+Enumerations
+-------------------------------------------------------------------------------*/
+/**
+ *  How a benchmark's simulated time is reported and gated
+ */
+enum class Metric : uint8_t
+{
+  THROUGHPUT, /**< Kilobytes per second of virtual time, lower is a regression */
+  LATENCY,    /**< Microseconds of virtual time per op, higher is a regression */
+};
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+/**
+ *  What one pass of a benchmark did
+ */
+struct Sample
+{
+  uint64_t simUs; /**< Virtual time spent in the measured section */
+  uint64_t cpuNs; /**< Host CPU time spent in the measured section */
+  size_t bytes;
+  size_t ops;
+};
+
+struct Benchmark
+{
+  const char *name;
+  Metric metric;
+  Sample ( *run )();
+};
+
+struct Entry
+{
+  std::string name;
+  Metric metric;
+  double simValue; /**< kB/s or us per op, see Metric */
+  double simTol;
+  double cpuRatio; /**< CPU time per op over CPU time per reference op */
+  double cpuTol;
+};
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static volatile uint32_t sRefSink;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t cpuNow()
+{
+  timespec ts;
+  clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+  return static_cast<uint64_t>( ts.tv_sec ) * 1000000000ull + static_cast<uint64_t>( ts.tv_nsec );
+}
+
+
+/**
+ *  Brackets a measured section on both clocks
+ */
+class Section
+{
+public:
+  Section( Sim::Device &sim ) : mSim( sim ), mSimStart( sim.now() ), mCpuStart( cpuNow() )
+  {
+  }
+
+  Sample finish( const size_t bytes, const size_t ops )
+  {
+    const uint64_t cpu = cpuNow() - mCpuStart;
+    return { mSim.now() - mSimStart, cpu, bytes, ops };
+  }
+
+private:
+  Sim::Device &mSim;
+  uint64_t mSimStart;
+  uint64_t mCpuStart;
+};
+
+
+/**
+ *  The yardstick CPU time is measured against. Walks a 1 MiB source so it
+ *  leans on the same memory paths as the simulator's array copies.
+ */
+static uint64_t referenceNsPerOp()
+{
+  static std::vector<uint8_t> src( REF_BLOCK * 256, 0xA5 );
+  static std::vector<uint8_t> dst( REF_BLOCK, 0x00 );
+
+  /*-------------------------------------------------
+  Consume the copies so they can't be optimized out
+  -------------------------------------------------*/
+  uint32_t sum         = 0;
+  const uint64_t start = cpuNow();
+
+  for ( size_t x = 0; x < REF_OPS; x++ )
+  {
+    const size_t offset = ( x % 256 ) * REF_BLOCK;
+    memcpy( dst.data(), src.data() + offset, REF_BLOCK );
+    sum += dst[ x % REF_BLOCK ];
+  }
+
+  const uint64_t elapsed = cpuNow() - start;
+  sRefSink               = sum;
+  return elapsed / REF_OPS;
+}
+
+
+static Sample benchPageWrite()
+{
+  Sim::Device sim( MODEL );
+  auto props = sim.getDeviceProperties();
+  std::vector<uint8_t> page( props.pageSize, 0x5A );
+
+  Section section( sim );
+  for ( size_t address = 0; address < WRITE_REGION; address += page.size() )
+  {
+    sim.write( address, page.data(), page.size() );
+  }
+
+  return section.finish( WRITE_REGION, WRITE_REGION / page.size() );
+}
+
+
+static Sample benchSequentialRead()
+{
+  Sim::Device sim( MODEL );
+  auto props        = sim.getDeviceProperties();
+  const size_t size = props.pageSize * props.numPages;
+  std::vector<uint8_t> page( props.pageSize );
+
+  Section section( sim );
+  for ( size_t address = 0; address < size; address += page.size() )
+  {
+    sim.read( address, page.data(), page.size() );
+  }
+
+  return section.finish( size, size / page.size() );
+}
+
+
+static Sample benchSectorErase()
+{
+  Sim::Device sim( MODEL );
+  auto props = sim.getDeviceProperties();
+
+  Section section( sim );
+  for ( size_t address = 0; address < ERASE_REGION; address += props.sectorSize )
+  {
+    sim.erase( address, props.sectorSize );
+  }
+
+  return section.finish( ERASE_REGION, ERASE_REGION / props.sectorSize );
+}
+
+
+static Sample benchFullVerify()
+{
+  Sim::Device sim( MODEL );
+  auto props        = sim.getDeviceProperties();
+  const size_t size = props.pageSize * props.numPages;
+
+  std::array<uint8_t, 2 * STREAM_BUFFER> storage;
+  Stream::Buffers ring = { storage.data(), STREAM_BUFFER, 2 };
+  size_t mismatch      = 0;
+
+  Section section( sim );
+  Stream::verify( Sim::streamTransport(), &sim, 0, size, ring, 0xFF, mismatch );
+  return section.finish( size, size / STREAM_BUFFER );
+}
+
+
+static Sample benchWearMount()
+{
+  auto sim = std::make_shared<Sim::Device>( MODEL );
+
+  Wear::Config config   = {};
+  config.bucketSize     = Wear::DEFAULT_BUCKET_SIZE;
+  config.staticInterval = 0;
+
+  /*-------------------------------------------------
+  Format once so the timed open() has a table to load
+  -------------------------------------------------*/
+  Wear::Allocator allocator( sim );
+  allocator.open( config );
+  allocator.close();
+
+  Section section( *sim );
+  allocator.open( config );
+  return section.finish( 0, 1 );
+}
+
+
+static const Benchmark sSuite[] = {
+  { "page_write", Metric::THROUGHPUT, benchPageWrite },
+  { "seq_read", Metric::THROUGHPUT, benchSequentialRead },
+  { "sector_erase", Metric::THROUGHPUT, benchSectorErase },
+  { "full_verify", Metric::THROUGHPUT, benchFullVerify },
+  { "wear_mount", Metric::LATENCY, benchWearMount },
+};
+
+
+static std::vector<Entry> measureSuite()
+{
+  /*-------------------------------------------------
+  Simulated time never varies between runs. For CPU
+  time the fastest run is the least disturbed one.
+  Passes over the suite are interleaved with the
+  reference so every benchmark's samples are spread
+  over the whole run, and a burst of load elsewhere
+  can't spoil all of any one benchmark's runs.
+  -------------------------------------------------*/
+  constexpr size_t count = sizeof( sSuite ) / sizeof( sSuite[ 0 ] );
+  std::array<Sample, count> samples;
+  std::array<double, count> cpuNs;
+  uint64_t refNs = std::numeric_limits<uint64_t>::max();
+
+  cpuNs.fill( std::numeric_limits<double>::max() );
+
+  for ( size_t x = 0; x < REPETITIONS; x++ )
+  {
+    for ( size_t y = 0; y < count; y++ )
+    {
+      refNs        = std::min( refNs, referenceNsPerOp() );
+      samples[ y ] = sSuite[ y ].run();
+      cpuNs[ y ]   = std::min( cpuNs[ y ], static_cast<double>( samples[ y ].cpuNs ) / samples[ y ].ops );
+    }
+  }
+
+  std::vector<Entry> entries;
+  for ( size_t y = 0; y < count; y++ )
+  {
+    const auto &sample = samples[ y ];
+
+    Entry entry    = { sSuite[ y ].name, sSuite[ y ].metric, 0.0, DEFAULT_SIM_TOL, 0.0, DEFAULT_CPU_TOL };
+    entry.cpuRatio = cpuNs[ y ] / std::max<uint64_t>( refNs, 1 );
+
+    if ( entry.metric == Metric::LATENCY )
+    {
+      entry.simValue = static_cast<double>( sample.simUs ) / sample.ops;
+    }
+    else
+    {
+      entry.simValue = sample.simUs ? ( static_cast<double>( sample.bytes ) * 1000000.0 ) / ( 1024.0 * sample.simUs ) : 0.0;
+    }
+
+    entries.push_back( entry );
+  }
+
+  return entries;
+}
+
+
+static bool loadBaseline( const char *path, std::vector<Entry> &entries )
+{
+  FILE *file = fopen( path, "r" );
+  if ( !file )
+  {
+    return false;
+  }
+
+  char line[ 256 ];
+  while ( fgets( line, sizeof( line ), file ) )
+  {
+    char name[ 64 ];
+    Entry entry;
+
+    if ( line[ 0 ] == '#' )
+    {
+      continue;
+    }
+
+    if ( sscanf( line, "%63s %lf %lf %lf %lf", name, &entry.simValue, &entry.simTol, &entry.cpuRatio, &entry.cpuTol ) != 5 )
+    {
+      continue;
+    }
+
+    entry.name = name;
+    entries.push_back( entry );
+  }
+
+  fclose( file );
+  return true;
+}
+
+
+static bool saveBaseline( const char *path, const std::vector<Entry> &entries )
+{
+  FILE *file = fopen( path, "w" );
+  if ( !file )
+  {
+    return false;
+  }
+
+  fprintf( file, "# Baseline for perf_gate. Regenerate with: perf_gate --baseline <this file> --update\n" );
+  fprintf( file, "# Tolerances are percentages and are kept across updates. cpu_ratio is CPU time\n" );
+  fprintf( file, "# per op over CPU time per %zu byte memcpy, from an optimized (Release) host build.\n", REF_BLOCK );
+  fprintf( file, "# sim is simulated kB/s, or simulated us per open() for wear_mount.\n" );
+  fprintf( file, "#\n" );
+  fprintf( file, "# %-14s %12s %8s %12s %8s\n", "name", "sim", "sim_tol", "cpu_ratio", "cpu_tol" );
+
+  for ( auto &entry : entries )
+  {
+    fprintf( file, "%-16s %12.2f %8.1f %12.3f %8.1f\n", entry.name.c_str(), entry.simValue, entry.simTol, entry.cpuRatio,
+             entry.cpuTol );
+  }
+
+  fclose( file );
+  return true;
+}
+
+
+static const Entry *findEntry( const std::vector<Entry> &entries, const std::string &name )
+{
+  for ( auto &entry : entries )
+  {
+    if ( entry.name == name )
+    {
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+
+static bool cpuRegressed( const std::vector<Entry> &measured, const std::vector<Entry> &baseline )
+{
+  for ( auto &entry : measured )
+  {
+    auto base = findEntry( baseline, entry.name );
+    if ( base && ( entry.cpuRatio > ( base->cpuRatio * ( 1.0 + ( base->cpuTol / 100.0 ) ) ) ) )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  const char *path = nullptr;
+  bool update      = false;
+  bool gateCpu     = false;
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    if ( ( strcmp( argv[ x ], "--baseline" ) == 0 ) && ( ( x + 1 ) < argc ) )
+    {
+      path = argv[ ++x ];
+    }
+    else if ( strcmp( argv[ x ], "--update" ) == 0 )
+    {
+      update = true;
+    }
+    else if ( strcmp( argv[ x ], "--gate-cpu" ) == 0 )
+    {
+      gateCpu = true;
+    }
+    else
+    {
+      path = nullptr;
+      break;
+    }
+  }
+
+  if ( !path )
+  {
+    fprintf( stderr, "Usage: perf_gate --baseline FILE [--update] [--gate-cpu]\n" );
+    return 1;
+  }
+
+  std::vector<Entry> baseline;
+  if ( !loadBaseline( path, baseline ) && !update )
+  {
+    fprintf( stderr, "Could not read baseline %s\n", path );
+    return 1;
+  }
+
+  /*-------------------------------------------------
+  Measure. Real regressions reproduce, while a burst
+  of load from elsewhere on the host rarely outlasts
+  a pause, so re-measure before failing on CPU time.
+  A new baseline always gets every pass, so it isn't
+  recorded during one of those bursts.
+  -------------------------------------------------*/
+  auto results = measureSuite();
+
+  for ( size_t x = 0; ( x < CPU_RETRIES ) && ( update || ( gateCpu && cpuRegressed( results, baseline ) ) ); x++ )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( RETRY_PAUSE_MS ) );
+
+    auto again = measureSuite();
+    for ( size_t y = 0; y < results.size(); y++ )
+    {
+      results[ y ].cpuRatio = std::min( results[ y ].cpuRatio, again[ y ].cpuRatio );
+    }
+  }
+
+  /*-------------------------------------------------
+  Compare
+  -------------------------------------------------*/
+  std::vector<Entry> measured;
+  bool passed = true;
+
+  printf( "%-14s %12s %12s %8s   %12s %12s %8s\n", "benchmark", "sim", "baseline", "delta", "cpu_ratio", "baseline",
+          "delta" );
+
+  for ( auto &entry : results )
+  {
+    auto base = findEntry( baseline, entry.name );
+
+    if ( base )
+    {
+      entry.simTol = base->simTol;
+      entry.cpuTol = base->cpuTol;
+    }
+
+    measured.push_back( entry );
+
+    if ( !base )
+    {
+      printf( "%-14s %12.2f %12s %8s   %12.3f %12s %8s  NEW\n", entry.name.c_str(), entry.simValue, "-", "-",
+              entry.cpuRatio, "-", "-" );
+      passed &= update;
+      continue;
+    }
+
+    /*-------------------------------------------------
+    Lower throughput, longer calls or more CPU time per
+    op regress
+    -------------------------------------------------*/
+    const double simDelta = base->simValue ? ( ( entry.simValue - base->simValue ) * 100.0 ) / base->simValue : 0.0;
+    const double cpuDelta = base->cpuRatio ? ( ( entry.cpuRatio - base->cpuRatio ) * 100.0 ) / base->cpuRatio : 0.0;
+    const double simLoss  = ( entry.metric == Metric::LATENCY ) ? simDelta : -simDelta;
+    const bool simOk      = simLoss <= base->simTol;
+    const bool cpuOk      = cpuDelta <= base->cpuTol;
+
+    const char *verdict = "PASS";
+    if ( !simOk )
+    {
+      verdict = "FAIL (sim)";
+    }
+    else if ( !cpuOk )
+    {
+      verdict = gateCpu ? "FAIL (cpu)" : "WARN (cpu)";
+    }
+
+    printf( "%-14s %12.2f %12.2f %+7.1f%%   %12.3f %12.3f %+7.1f%%  %s\n", entry.name.c_str(), entry.simValue, base->simValue,
+            simDelta, entry.cpuRatio, base->cpuRatio, cpuDelta, verdict );
+
+    passed &= ( simOk && ( cpuOk || !gateCpu ) );
+  }
+
+  if ( update )
+  {
+    if ( !saveBaseline( path, measured ) )
+    {
+      fprintf( stderr, "Could not write baseline %s\n", path );
+      return 1;
+    }
+
+    printf( "Baseline updated: %s\n", path );
+    return 0;
+  }
+
+  return passed ? 0 : 1;
+}
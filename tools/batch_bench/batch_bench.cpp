@@ -0,0 +1,235 @@
+/********************************************************************************
+ *  File Name:
+ *    batch_bench.cpp
+ *
+ *  Description:
+ *    Host tool comparing a fixed flow (erase a unit, program some pages, read
+ *    back a header) issued as direct device calls against the same flow run
+ *    as a Batch::Engine command list. Device time comes from the simulator's
+ *    virtual clock and is the same either way; host wall time per list shows
+ *    what the engine's submit, wake-up and completion round trip costs.
+ *
+ *    Usage: batch_bench [--model NAME] [--lists N] [--pages N]
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/thread>
+
+/* Adesto Includes */
+#include <src/batch/batch.hpp>
+#include <src/sim/sim_device.hpp>
+
+using namespace Adesto;
+using namespace Aurora::Memory;
+
+/*-------------------------------------------------------------------------------
+Constants
+-------------------------------------------------------------------------------*/
+static constexpr size_t HEADER_SIZE = 16;
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+struct Options
+{
+  Sim::Model model;
+  size_t lists;
+  size_t pages;
+};
+
+struct Outcome
+{
+  double wallUs; /**< Host time per list */
+  double simUs;  /**< Device time per list */
+  size_t failures;
+};
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t wallNowUs()
+{
+  using namespace std::chrono;
+  return static_cast<uint64_t>( duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count() );
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/**
+ *  Each step is its own call, the way flows are written today
+ */
+static Outcome runInline( const Options &options )
+{
+  auto sim          = std::make_shared<Sim::Device>( options.model );
+  auto props        = sim->getDeviceProperties();
+  const size_t unit = chunkSize( props, props.eraseChunk );
+
+  std::vector<uint8_t> page( props.pageSize, 0x5A );
+  std::array<uint8_t, HEADER_SIZE> header;
+  Outcome outcome = {};
+
+  const uint64_t simStart  = sim->now();
+  const uint64_t wallStart = wallNowUs();
+
+  for ( size_t list = 0; list < options.lists; list++ )
+  {
+    const size_t address = ( list % sim->numEraseUnits() ) * unit;
+    Status result        = sim->erase( address, unit );
+    if ( result == Status::ERR_OK )
+    {
+      result = sim->pendEvent( Event::MEM_ERASE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+    }
+
+    for ( size_t x = 0; ( x < options.pages ) && ( result == Status::ERR_OK ); x++ )
+    {
+      result = sim->write( address + ( x * page.size() ), page.data(), page.size() );
+      if ( result == Status::ERR_OK )
+      {
+        result = sim->pendEvent( Event::MEM_WRITE_COMPLETE, Chimera::Threading::TIMEOUT_BLOCK );
+      }
+    }
+
+    if ( result == Status::ERR_OK )
+    {
+      result = sim->read( address, header.data(), header.size() );
+    }
+
+    outcome.failures += ( result != Status::ERR_OK );
+  }
+
+  outcome.wallUs = static_cast<double>( wallNowUs() - wallStart ) / options.lists;
+  outcome.simUs  = static_cast<double>( sim->now() - simStart ) / options.lists;
+  return outcome;
+}
+
+
+/**
+ *  The same steps as one command list per flow
+ */
+static Outcome runEngine( const Options &options )
+{
+  auto sim          = std::make_shared<Sim::Device>( options.model );
+  auto props        = sim->getDeviceProperties();
+  const size_t unit = chunkSize( props, props.eraseChunk );
+
+  std::vector<uint8_t> page( props.pageSize, 0x5A );
+  std::array<uint8_t, HEADER_SIZE> header;
+  std::vector<Batch::Command> commands( options.pages + 2 );
+  Outcome outcome = {};
+
+  Batch::Engine engine( sim );
+  if ( engine.start() != Status::ERR_OK )
+  {
+    outcome.failures = options.lists;
+    return outcome;
+  }
+
+  const uint64_t simStart  = sim->now();
+  const uint64_t wallStart = wallNowUs();
+
+  for ( size_t list = 0; list < options.lists; list++ )
+  {
+    const size_t address = ( list % sim->numEraseUnits() ) * unit;
+
+    commands.front() = { Batch::CmdType::ERASE, address, nullptr, unit, Status::ERR_OK };
+    for ( size_t x = 0; x < options.pages; x++ )
+    {
+      commands[ x + 1 ] = { Batch::CmdType::WRITE, address + ( x * page.size() ), page.data(), page.size(), Status::ERR_OK };
+    }
+    commands.back() = { Batch::CmdType::READ, address, header.data(), header.size(), Status::ERR_OK };
+
+    Batch::List batch = { commands.data(), commands.size(), 0, 0 };
+    outcome.failures += ( engine.execute( batch, Batch::WAIT_FOREVER ) != Status::ERR_OK );
+  }
+
+  outcome.wallUs = static_cast<double>( wallNowUs() - wallStart ) / options.lists;
+  outcome.simUs  = static_cast<double>( sim->now() - simStart ) / options.lists;
+
+  engine.stop();
+  return outcome;
+}
+
+
+static void report( const char *name, const Outcome &outcome )
+{
+  printf( "%-8s host %10.2f us/list  device %10.1f us/list  failures %zu\n", name, outcome.wallUs, outcome.simUs,
+          outcome.failures );
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  Options options = { Sim::Model::AT25SF081, 2000, 16 };
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    const bool hasValue = ( x + 1 ) < argc;
+
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && hasValue )
+    {
+      if ( !parseModel( argv[ ++x ], options.model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( ( strcmp( argv[ x ], "--lists" ) == 0 ) && hasValue )
+    {
+      options.lists = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--pages" ) == 0 ) && hasValue )
+    {
+      options.pages = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: batch_bench [--model NAME] [--lists N] [--pages N]\n" );
+      return 1;
+    }
+  }
+
+  const auto &geometry = Sim::getGeometry( options.model );
+  if ( !options.lists || ( ( options.pages * geometry.pageSize ) > geometry.blockSize ) )
+  {
+    fprintf( stderr, "Invalid options\n" );
+    return 1;
+  }
+
+  printf( "%s, %zu lists of erase + %zu pages + header read\n", geometry.name, options.lists, options.pages );
+
+  const auto direct  = runInline( options );
+  const auto batched = runEngine( options );
+
+  report( "inline", direct );
+  report( "engine", batched );
+  printf( "engine overhead %+.2f us/list\n", batched.wallUs - direct.wallUs );
+
+  return 0;
+}
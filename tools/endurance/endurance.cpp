@@ -0,0 +1,379 @@
+/********************************************************************************
+ *  File Name:
+ *    endurance.cpp
+ *
+ *  Description:
+ *    Host tool projecting how long a storage layout lasts in the field. Each
+ *    thread owns a slice of a fast forward simulated part and hammers it with
+ *    skewed updates through the chosen layout. Every update is read back, so
+ *    bit errors injected past the rated endurance show up as corruption.
+ *
+ *      fixed   Slots at fixed addresses, erased and rewritten in place
+ *      txn     Transactional update store, one slot per transaction
+ *
+ *    Usage: endurance [--model NAME] [--layout fixed|txn] [--threads N] [--updates N]
+ *                     [--slots N] [--size BYTES] [--hot PERCENT] [--rated N]
+ *                     [--per-day N] [--top N]
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* Adesto Includes */
+#include <src/sim/sim_endurance.hpp>
+#include <src/txn/txn.hpp>
+
+using namespace Adesto;
+using namespace Aurora::Memory;
+
+/*-------------------------------------------------------------------------------
+Enumerations
+-------------------------------------------------------------------------------*/
+enum class Layout : uint8_t
+{
+  FIXED,
+  TXN,
+
+  NUM_OPTIONS,
+  UNKNOWN
+};
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+struct Options
+{
+  Sim::Model model;
+  Layout layout;
+  size_t threads;
+  size_t updates; /**< Across all threads */
+  size_t slots;   /**< Per thread */
+  size_t size;
+  size_t hotPercent; /**< Share of updates that go to slot zero */
+  uint32_t rated;    /**< Overrides the part's rating when non-zero */
+  size_t perDay;     /**< Field update rate the lifetime is projected for */
+  size_t top;
+};
+
+struct Partition
+{
+  size_t baseAddress;
+  size_t length;
+};
+
+struct Outcome
+{
+  uint64_t hostBytes;
+  size_t updates;
+  size_t corrupt;  /**< Updates that didn't read back as written */
+  size_t failures; /**< Updates the layout reported an error for */
+};
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+static inline uint32_t nextRandom( uint32_t &state )
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+
+static size_t pickSlot( uint32_t &state, const Options &options )
+{
+  return ( ( nextRandom( state ) % 100 ) < options.hotPercent ) ? 0 : ( nextRandom( state ) % options.slots );
+}
+
+
+static void fill( std::vector<uint8_t> &data, const size_t update, const size_t slot )
+{
+  for ( size_t x = 0; x < data.size(); x++ )
+  {
+    data[ x ] = static_cast<uint8_t>( update + slot + x );
+  }
+}
+
+
+static void runFixed( Sim::EnduranceDevice &device, const Options &options, const Partition &part, const size_t updates,
+                      uint32_t seed, Outcome &outcome )
+{
+  const size_t unit     = device.getGeometry().blockSize;
+  const size_t slotSize = ( ( options.size + unit - 1 ) / unit ) * unit;
+
+  std::vector<uint8_t> data( options.size );
+  std::vector<uint8_t> check( options.size );
+
+  for ( size_t x = 0; x < updates; x++ )
+  {
+    const size_t slot    = pickSlot( seed, options );
+    const size_t address = part.baseAddress + ( slot * slotSize );
+    fill( data, x, slot );
+
+    if ( ( device.erase( address, slotSize ) != Status::ERR_OK )
+         || ( device.write( address, data.data(), data.size() ) != Status::ERR_OK )
+         || ( device.read( address, check.data(), check.size() ) != Status::ERR_OK ) )
+    {
+      outcome.failures++;
+      continue;
+    }
+
+    outcome.updates++;
+    outcome.hostBytes += data.size();
+    outcome.corrupt += ( data != check );
+  }
+}
+
+
+static void runTxn( Sim::EnduranceDevice_sPtr device, const Options &options, const Partition &part, const size_t updates,
+                    uint32_t seed, Outcome &outcome )
+{
+  Txn::Store store( device );
+  if ( store.open( { part.baseAddress, options.slots, options.size } ) != Status::ERR_OK )
+  {
+    outcome.failures += updates;
+    return;
+  }
+
+  std::vector<uint8_t> data( options.size );
+  std::vector<uint8_t> check( options.size );
+
+  for ( size_t x = 0; x < updates; x++ )
+  {
+    const size_t slot = pickSlot( seed, options );
+    fill( data, x, slot );
+
+    if ( ( store.begin() != Status::ERR_OK ) || ( store.write( slot, data.data(), data.size() ) != Status::ERR_OK )
+         || ( store.commit() != Status::ERR_OK ) )
+    {
+      /*-------------------------------------------------
+      A failed commit closes the store until recovered
+      -------------------------------------------------*/
+      store.abort();
+      store.open( { part.baseAddress, options.slots, options.size } );
+      outcome.failures++;
+      continue;
+    }
+
+    outcome.updates++;
+    outcome.hostBytes += data.size();
+    outcome.corrupt += ( store.read( slot, 0, check.data(), check.size() ) != Status::ERR_OK ) || ( data != check );
+  }
+}
+
+
+static size_t partitionSize( const Options &options, const Properties &props )
+{
+  const size_t unit = chunkSize( props, props.eraseChunk );
+
+  if ( options.layout == Layout::TXN )
+  {
+    return Txn::Store::footprint( { 0, options.slots, options.size }, props );
+  }
+
+  return options.slots * ( ( options.size + unit - 1 ) / unit ) * unit;
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  Options options    = {};
+  options.model      = Sim::Model::AT25SF081;
+  options.layout     = Layout::TXN;
+  options.threads    = std::clamp<size_t>( std::thread::hardware_concurrency(), 1, 8 );
+  options.updates    = 2000000;
+  options.slots      = 8;
+  options.size       = 256;
+  options.hotPercent = 50;
+  options.rated      = 0;
+  options.perDay     = 10000;
+  options.top        = 5;
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    const bool hasValue = ( x + 1 ) < argc;
+
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && hasValue )
+    {
+      if ( !parseModel( argv[ ++x ], options.model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( ( strcmp( argv[ x ], "--layout" ) == 0 ) && hasValue )
+    {
+      const char *name = argv[ ++x ];
+      options.layout   = ( strcmp( name, "fixed" ) == 0 ) ? Layout::FIXED
+                         : ( strcmp( name, "txn" ) == 0 ) ? Layout::TXN
+                                                          : Layout::UNKNOWN;
+    }
+    else if ( ( strcmp( argv[ x ], "--threads" ) == 0 ) && hasValue )
+    {
+      options.threads = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--updates" ) == 0 ) && hasValue )
+    {
+      options.updates = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--slots" ) == 0 ) && hasValue )
+    {
+      options.slots = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--size" ) == 0 ) && hasValue )
+    {
+      options.size = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--hot" ) == 0 ) && hasValue )
+    {
+      options.hotPercent = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--rated" ) == 0 ) && hasValue )
+    {
+      options.rated = static_cast<uint32_t>( strtoul( argv[ ++x ], nullptr, 0 ) );
+    }
+    else if ( ( strcmp( argv[ x ], "--per-day" ) == 0 ) && hasValue )
+    {
+      options.perDay = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--top" ) == 0 ) && hasValue )
+    {
+      options.top = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: endurance [--model NAME] [--layout fixed|txn] [--threads N] [--updates N]\n"
+                       "                 [--slots N] [--size BYTES] [--hot PERCENT] [--rated N]\n"
+                       "                 [--per-day N] [--top N]\n" );
+      return 1;
+    }
+  }
+
+  /*-------------------------------------------------
+  Build the part and carve it up between threads
+  -------------------------------------------------*/
+  auto profile = Sim::getEnduranceProfile( options.model );
+  if ( options.rated )
+  {
+    profile.ratedCycles = options.rated;
+  }
+
+  const auto &geometry = Sim::getGeometry( options.model );
+  auto device          = std::make_shared<Sim::EnduranceDevice>( geometry, profile );
+  const size_t slice   = partitionSize( options, device->getDeviceProperties() );
+
+  if ( ( options.layout == Layout::UNKNOWN ) || !options.threads || !options.updates || !options.slots || !options.size
+       || ( options.hotPercent > 100 ) || !options.perDay || !slice || ( ( slice * options.threads ) > geometry.deviceSize ) )
+  {
+    fprintf( stderr, "Invalid options\n" );
+    return 1;
+  }
+
+  std::vector<Outcome> outcomes( options.threads, Outcome{} );
+  std::vector<std::thread> workers;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for ( size_t x = 0; x < options.threads; x++ )
+  {
+    const Partition part = { x * slice, slice };
+    const size_t updates = ( options.updates / options.threads ) + ( x < ( options.updates % options.threads ) );
+    const uint32_t seed  = 0x2545F491u + static_cast<uint32_t>( x * 0x9E3779B9u );
+    Outcome &outcome     = outcomes[ x ];
+
+    workers.emplace_back( [ &, part, updates, seed ]() {
+      if ( options.layout == Layout::FIXED )
+      {
+        runFixed( *device, options, part, updates, seed, outcome );
+      }
+      else
+      {
+        runTxn( device, options, part, updates, seed, outcome );
+      }
+    } );
+  }
+
+  for ( auto &worker : workers )
+  {
+    worker.join();
+  }
+
+  const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+  /*-------------------------------------------------
+  Totals and projection
+  -------------------------------------------------*/
+  Outcome total = {};
+  for ( const auto &outcome : outcomes )
+  {
+    total.hostBytes += outcome.hostBytes;
+    total.updates += outcome.updates;
+    total.corrupt += outcome.corrupt;
+    total.failures += outcome.failures;
+  }
+
+  const auto stats      = device->getStats();
+  const auto projection = device->project( total.hostBytes, options.top );
+
+  printf( "%s, %s layout, %zu threads x %zu slots of %zu bytes, %zu%% hot, rated %u cycles\n", geometry.name,
+          ( options.layout == Layout::FIXED ) ? "fixed" : "txn", options.threads, options.slots, options.size,
+          options.hotPercent, profile.ratedCycles );
+  printf( "updates %zu  failed %zu  corrupt %zu  bit errors %llu\n", total.updates, total.failures, total.corrupt,
+          static_cast<unsigned long long>( stats.bitErrors ) );
+  printf( "host MiB %.1f  programmed MiB %.1f  erased MiB %.1f  write amp %.2f  erase amp %.2f\n",
+          total.hostBytes / 1048576.0, stats.bytesProgrammed / 1048576.0, stats.bytesErased / 1048576.0,
+          projection.writeAmplification, projection.eraseAmplification );
+  printf( "erases %llu  per unit min %u  mean %.1f  max %u  units past rating %zu\n",
+          static_cast<unsigned long long>( stats.erases ), projection.minErases, projection.meanErases,
+          projection.maxErases, projection.unitsPastRating );
+
+  if ( projection.lifetimeHostBytes && total.hostBytes )
+  {
+    const double lifetimeUpdates = static_cast<double>( projection.lifetimeHostBytes ) * total.updates / total.hostBytes;
+    const double leftUpdates     = static_cast<double>( projection.remainingHostBytes ) * total.updates / total.hostBytes;
+    const double days            = lifetimeUpdates / options.perDay;
+
+    printf( "projected lifetime %.0f updates, %.1f days (%.2f years) at %zu updates/day, %.0f updates left\n",
+            lifetimeUpdates, days, days / 365.0, options.perDay, leftUpdates );
+  }
+
+  printf( "hottest units:" );
+  for ( const auto &wear : projection.hottest )
+  {
+    printf( " %zu:%u", wear.unit, wear.erases );
+  }
+  printf( "\n" );
+
+  printf( "wall %.2f s  updates/s %.0f  erases/s %.0f  peak RAM %zu KiB of %zu KiB\n", seconds,
+          seconds > 0.0 ? total.updates / seconds : 0.0, seconds > 0.0 ? stats.erases / seconds : 0.0,
+          ( stats.peakResidentUnits * geometry.blockSize ) / 1024, geometry.deviceSize / 1024 );
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+/********************************************************************************
+ *  File Name:
+ *    fs_bench.cpp
+ *
+ *  Description:
+ *    Host runner for the littlefs benchmark. Runs against the simulated parts
+ *    and measures on the simulator's virtual clock, so results track the
+ *    device time the filesystem costs rather than host speed.
+ *
+ *    Usage: fs_bench [--model NAME] [--files N] [--size BYTES] [--append BYTES]
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+/* Adesto Includes */
+#include <src/littlefs/littlefs_bench.hpp>
+#include <src/sim/sim_device.hpp>
+
+using namespace Adesto;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t simClock( void *context )
+{
+  return static_cast<Sim::Device *>( context )->now();
+}
+
+
+static void emitLine( const char *const line )
+{
+  printf( "%s\n", line );
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  Sim::Model model             = Sim::Model::AT25SF081;
+  LittleFS::BenchConfig config = { 16, 16 * 1024, 256 };
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    const bool hasValue = ( x + 1 ) < argc;
+
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && hasValue )
+    {
+      if ( !parseModel( argv[ ++x ], model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( ( strcmp( argv[ x ], "--files" ) == 0 ) && hasValue )
+    {
+      config.numFiles = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--size" ) == 0 ) && hasValue )
+    {
+      config.fileSize = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--append" ) == 0 ) && hasValue )
+    {
+      config.appendSize = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: fs_bench [--model NAME] [--files N] [--size BYTES] [--append BYTES]\n" );
+      return 1;
+    }
+  }
+
+  /*-------------------------------------------------
+  Run on a fresh part
+  -------------------------------------------------*/
+  auto sim = std::make_shared<Sim::Device>( model );
+  printf( "%s\n", Sim::getGeometry( model ).name );
+  sim->open();
+
+  LittleFS::BenchResult result;
+  const auto status = LittleFS::runBenchmark( config, sim, simClock, sim.get(), result );
+  sim->close();
+
+  if ( status == Aurora::Memory::Status::ERR_BAD_ARG )
+  {
+    fprintf( stderr, "Invalid options\n" );
+    return 1;
+  }
+
+  LittleFS::report( config, result, emitLine );
+  return ( status == Aurora::Memory::Status::ERR_OK ) ? 0 : 1;
+}
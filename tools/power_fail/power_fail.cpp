@@ -0,0 +1,267 @@
+/********************************************************************************
+ *  File Name:
+ *    power_fail.cpp
+ *
+ *  Description:
+ *    Host tool running power loss campaigns against the transactional update
+ *    store. Power is cut at every program and erase step of an update in
+ *    turn, then the store is recovered and checked for a torn result.
+ *    Recovery time is measured on the simulator's clock and compared with
+ *    reading back every slot, the cost of validating the data directly.
+ *
+ *    Usage: power_fail [--model NAME] [--slots N] [--size BYTES] [--history N]
+ *
+ *    Without --history the update under test is the first to wrap the commit
+ *    area back over its oldest records, so power is also cut while that unit
+ *    is erased.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/txn/txn.hpp>
+
+using namespace Adesto;
+using namespace Aurora::Memory;
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+struct Options
+{
+  Sim::Model model;
+  Txn::Config config;
+  size_t history; /**< Updates committed before the campaign, to fill the commit area */
+};
+
+struct Outcome
+{
+  size_t runs;
+  size_t torn; /**< Recoveries where slots disagree or hold neither version */
+  size_t rolledBack;
+  size_t rolledForward;
+  uint64_t recoveryMin;
+  uint64_t recoveryMax;
+  uint64_t recoveryTotal;
+};
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+/**
+ *  Contents written by the n-th update, never the erased value so a slot
+ *  left blank can't pass for a committed version
+ */
+static uint8_t updateValue( const size_t update )
+{
+  return static_cast<uint8_t>( update % 0xFF );
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+static Status update( Txn::Store &store, const uint8_t value, const size_t length )
+{
+  std::vector<uint8_t> data( length, value );
+  auto result = store.begin();
+
+  for ( size_t slot = 0; ( slot < store.numSlots() ) && ( result == Status::ERR_OK ); slot++ )
+  {
+    result = store.write( slot, data.data(), data.size() );
+  }
+
+  return ( result == Status::ERR_OK ) ? store.commit() : result;
+}
+
+
+/**
+ *  Which version every slot holds, or -1 if they don't agree
+ */
+static int survivor( Txn::Store &store, const size_t length )
+{
+  std::vector<uint8_t> data( length );
+  int version = -1;
+
+  for ( size_t slot = 0; slot < store.numSlots(); slot++ )
+  {
+    store.read( slot, 0, data.data(), data.size() );
+
+    const bool uniform = std::all_of( data.begin(), data.end(), [&]( uint8_t byte ) { return byte == data[ 0 ]; } );
+    if ( !uniform || ( ( version >= 0 ) && ( data[ 0 ] != version ) ) )
+    {
+      return -1;
+    }
+
+    version = data[ 0 ];
+  }
+
+  return version;
+}
+
+
+/**
+ *  Cuts power at one step of the final update. Returns false once the
+ *  update ran to completion without reaching the armed step.
+ */
+static bool runOnce( const Options &options, const size_t step, Outcome &outcome )
+{
+  auto sim      = std::make_shared<Sim::Device>( options.model );
+  const auto &c = options.config;
+  Txn::Store store( sim );
+
+  store.open( c );
+  for ( size_t x = 0; x < options.history; x++ )
+  {
+    update( store, updateValue( x ), c.slotSize );
+  }
+
+  const uint8_t before = updateValue( options.history - 1 );
+  const uint8_t after  = updateValue( options.history );
+
+  sim->armPowerLoss( step );
+  update( store, after, c.slotSize );
+  sim->disarmPowerLoss();
+
+  const bool lost = sim->powerLost();
+  sim->powerOn();
+
+  /*-------------------------------------------------
+  Recover and check
+  -------------------------------------------------*/
+  Txn::Store recovered( sim );
+  const uint64_t start = sim->now();
+  recovered.open( c );
+  const uint64_t spent = sim->now() - start;
+
+  const int version = survivor( recovered, c.slotSize );
+
+  outcome.runs++;
+  outcome.torn += ( version != before ) && ( version != after );
+  outcome.rolledBack += ( version == before );
+  outcome.rolledForward += ( version == after );
+  outcome.recoveryMin = std::min( outcome.recoveryMin, spent );
+  outcome.recoveryMax = std::max( outcome.recoveryMax, spent );
+  outcome.recoveryTotal += spent;
+
+  return lost;
+}
+
+
+static uint64_t fullScanTime( const Options &options )
+{
+  Sim::Device sim( options.model );
+  std::vector<uint8_t> data( options.config.slotSize );
+
+  const uint64_t start = sim.now();
+  for ( size_t slot = 0; slot < options.config.numSlots; slot++ )
+  {
+    sim.read( options.config.baseAddress + ( slot * data.size() ), data.data(), data.size() );
+  }
+
+  return sim.now() - start;
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  Options options = {};
+  options.model   = Sim::Model::AT25SF081;
+  options.config  = { 0, 4, 16 * 1024 };
+  options.history = 0;
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    const bool hasValue = ( x + 1 ) < argc;
+
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && hasValue )
+    {
+      if ( !parseModel( argv[ ++x ], options.model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( ( strcmp( argv[ x ], "--slots" ) == 0 ) && hasValue )
+    {
+      options.config.numSlots = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--size" ) == 0 ) && hasValue )
+    {
+      options.config.slotSize = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--history" ) == 0 ) && hasValue )
+    {
+      options.history = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: power_fail [--model NAME] [--slots N] [--size BYTES] [--history N]\n" );
+      return 1;
+    }
+  }
+
+  Sim::Device probe( options.model );
+  const auto props       = probe.getDeviceProperties();
+  const size_t footprint = Txn::Store::footprint( options.config, props );
+
+  /*-------------------------------------------------
+  Default to filling every commit unit, so the final
+  update erases the oldest one before its record
+  -------------------------------------------------*/
+  if ( !options.history )
+  {
+    options.history = Txn::COMMIT_UNITS * ( chunkSize( props, props.eraseChunk ) / Txn::RECORD_SIZE );
+  }
+
+  if ( !footprint || ( footprint > probe.getGeometry().deviceSize ) )
+  {
+    fprintf( stderr, "Invalid options\n" );
+    return 1;
+  }
+
+  /*-------------------------------------------------
+  One run per step until the update gets through
+  -------------------------------------------------*/
+  Outcome outcome     = {};
+  outcome.recoveryMin = UINT64_MAX;
+
+  for ( size_t step = 0; runOnce( options, step, outcome ); step++ )
+  {
+  }
+
+  printf( "%s, %zu slots of %zu bytes, %zu updates of history\n", Sim::getGeometry( options.model ).name,
+          options.config.numSlots, options.config.slotSize, options.history );
+  printf( "runs %zu  torn %zu  rolled back %zu  rolled forward %zu\n", outcome.runs, outcome.torn, outcome.rolledBack,
+          outcome.rolledForward );
+  printf( "recovery us min %llu avg %llu max %llu, full data scan %llu\n",
+          static_cast<unsigned long long>( outcome.recoveryMin ),
+          static_cast<unsigned long long>( outcome.recoveryTotal / outcome.runs ),
+          static_cast<unsigned long long>( outcome.recoveryMax ),
+          static_cast<unsigned long long>( fullScanTime( options ) ) );
+
+  return outcome.torn ? 1 : 0;
+}
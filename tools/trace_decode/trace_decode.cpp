@@ -0,0 +1,178 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_decode.cpp
+ *
+ *  Description:
+ *    Host tool that pulls trace frames out of a captured byte stream (serial
+ *    log or simulator stdout), emits every record as CSV and prints latency
+ *    summaries per operation type. Anything that isn't a valid frame, such as
+ *    test runner text, is skipped.
+ *
+ *    Usage: trace_decode [capture_file] > trace.csv
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+/* Trace Includes */
+#include <src/trace/trace_format.hpp>
+#include <src/trace/trace_reader.hpp>
+
+using namespace Adesto::Trace;
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static const char *OpNames[] = { "read", "write", "erase", "erase_chip", "mark" };
+static const char *PhaseNames[] = { "begin", "end", "instant" };
+
+static std::array<std::vector<uint32_t>, static_cast<size_t>( Operation::NUM_OPTIONS )> sLatency;
+static std::array<uint64_t, static_cast<size_t>( Operation::NUM_OPTIONS )> sBytes;
+static std::array<Record, 256> sOpenRecords;
+static std::array<bool, 256> sOpenValid;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static const char *opName( const uint8_t op )
+{
+  return ( op < std::size( OpNames ) ) ? OpNames[ op ] : "unknown";
+}
+
+
+static const char *phaseName( const uint8_t phase )
+{
+  return ( phase < std::size( PhaseNames ) ) ? PhaseNames[ phase ] : "unknown";
+}
+
+
+static void processRecord( const Record &rec )
+{
+  /*-------------------------------------------------
+  Pair up BEGIN/END records to get the latency
+  -------------------------------------------------*/
+  int64_t latency = -1;
+
+  if ( rec.phase == static_cast<uint8_t>( Phase::BEGIN ) )
+  {
+    sOpenRecords[ rec.sequence ] = rec;
+    sOpenValid[ rec.sequence ]   = true;
+  }
+  else if ( ( rec.phase == static_cast<uint8_t>( Phase::END ) ) && sOpenValid[ rec.sequence ]
+            && ( sOpenRecords[ rec.sequence ].operation == rec.operation ) )
+  {
+    // Unsigned math handles the 32-bit microsecond counter rolling over
+    latency                    = static_cast<uint32_t>( rec.timestamp - sOpenRecords[ rec.sequence ].timestamp );
+    sOpenValid[ rec.sequence ] = false;
+
+    if ( rec.operation < sLatency.size() )
+    {
+      sLatency[ rec.operation ].push_back( static_cast<uint32_t>( latency ) );
+      sBytes[ rec.operation ] += rec.length;
+    }
+  }
+
+  /*-------------------------------------------------
+  Emit the CSV row
+  -------------------------------------------------*/
+  printf( "%u,%u,%s,%s,0x%08X,%u,%u,", rec.timestamp, rec.sequence, opName( rec.operation ), phaseName( rec.phase ),
+          rec.address, rec.length, rec.status );
+
+  if ( latency >= 0 )
+  {
+    printf( "%lld\n", static_cast<long long>( latency ) );
+  }
+  else
+  {
+    printf( "\n" );
+  }
+}
+
+
+static uint32_t percentile( const std::vector<uint32_t> &sorted, const double pct )
+{
+  const size_t idx = static_cast<size_t>( pct * static_cast<double>( sorted.size() - 1 ) + 0.5 );
+  return sorted[ std::min( idx, sorted.size() - 1 ) ];
+}
+
+
+static void printSummary()
+{
+  fprintf( stderr, "%-12s %8s %10s %10s %10s %10s %10s %10s %12s\n", "op", "count", "min_us", "mean_us", "p50_us", "p99_us",
+           "max_us", "bytes", "KiB/s" );
+
+  for ( size_t op = 0; op < sLatency.size(); op++ )
+  {
+    auto &samples = sLatency[ op ];
+    if ( samples.empty() )
+    {
+      continue;
+    }
+
+    std::sort( samples.begin(), samples.end() );
+
+    uint64_t total = 0;
+    for ( auto x : samples )
+    {
+      total += x;
+    }
+
+    const double mean = static_cast<double>( total ) / static_cast<double>( samples.size() );
+    const double kibs = total ? ( static_cast<double>( sBytes[ op ] ) / 1024.0 ) / ( static_cast<double>( total ) / 1e6 ) : 0.0;
+
+    fprintf( stderr, "%-12s %8zu %10u %10.1f %10u %10u %10u %10llu %12.1f\n", opName( static_cast<uint8_t>( op ) ),
+             samples.size(), samples.front(), mean, percentile( samples, 0.50 ), percentile( samples, 0.99 ), samples.back(),
+             static_cast<unsigned long long>( sBytes[ op ] ), kibs );
+  }
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  FILE *input = stdin;
+  if ( argc > 1 )
+  {
+    input = fopen( argv[ 1 ], "rb" );
+    if ( !input )
+    {
+      fprintf( stderr, "Unable to open %s\n", argv[ 1 ] );
+      return 1;
+    }
+  }
+
+  /*-------------------------------------------------
+  Slurp the whole capture. These are test logs, so
+  they comfortably fit in memory.
+  -------------------------------------------------*/
+  std::vector<uint8_t> stream;
+  std::array<uint8_t, 4096> chunk;
+  size_t bytesRead = 0;
+
+  while ( ( bytesRead = fread( chunk.data(), 1, chunk.size(), input ) ) > 0 )
+  {
+    stream.insert( stream.end(), chunk.begin(), chunk.begin() + bytesRead );
+  }
+
+  if ( input != stdin )
+  {
+    fclose( input );
+  }
+
+  /*-------------------------------------------------
+  Pull out every valid frame
+  -------------------------------------------------*/
+  printf( "timestamp_us,sequence,op,phase,address,length,status,latency_us\n" );
+  auto stats = parseStream( stream.data(), stream.size(), processRecord );
+
+  fprintf( stderr, "Decoded %zu frames (%zu rejected)\n", stats.frames, stats.rejected );
+  printSummary();
+  return 0;
+}
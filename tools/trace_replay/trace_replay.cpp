@@ -0,0 +1,252 @@
+/********************************************************************************
+ *  File Name:
+ *    trace_replay.cpp
+ *
+ *  Description:
+ *    Host tool that replays a captured I/O trace against simulated devices and
+ *    reports throughput, tail latency and erase counts for each configuration.
+ *    Every configuration sees the identical workload, so the numbers can be
+ *    compared directly.
+ *
+ *    Usage: trace_replay [--model NAME] [--ideal] [--erase-map] [--paced] capture_file
+ *
+ *    With no model given, every modeled part is run, both with and without the
+ *    erase map layer unless --erase-map asks for it alone. Operations are
+ *    issued back to back, ignoring the captured timestamps, unless --paced is
+ *    given to replay the host's idle time between them on the simulated clock.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Adesto Includes */
+#include <src/erase_map/erase_map.hpp>
+#include <src/sim/sim_device.hpp>
+#include <src/trace/trace_reader.hpp>
+#include <src/trace/trace_replay.hpp>
+
+using namespace Adesto;
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+struct RunConfig
+{
+  Sim::Model model;
+  bool ideal;
+  bool eraseMap;
+  bool paced;
+};
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static const char *OpNames[] = { "read", "write", "erase", "erase_chip" };
+static std::array<uint8_t, 4096> sScratch;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t simClock( void *context )
+{
+  return static_cast<Sim::Device *>( context )->now();
+}
+
+
+static void simIdle( void *context, const uint64_t us )
+{
+  static_cast<Sim::Device *>( context )->advance( us );
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+static void runConfig( const RunConfig &run, const std::vector<Trace::Record> &records )
+{
+  /*-------------------------------------------------
+  Build the device stack
+  -------------------------------------------------*/
+  auto &geometry = Sim::getGeometry( run.model );
+  auto &timing   = run.ideal ? Sim::getIdealTiming() : Sim::getTiming( run.model );
+  auto sim       = std::make_shared<Sim::Device>( geometry, timing );
+
+  Aurora::Memory::IGenericDevice_sPtr dut = sim;
+  if ( run.eraseMap )
+  {
+    dut = std::make_shared<EraseMap::Device>( sim );
+  }
+
+  dut->open();
+
+  /*-------------------------------------------------
+  Replay
+  -------------------------------------------------*/
+  Trace::ReplayConfig cfg;
+  cfg.clock         = simClock;
+  cfg.clockContext  = sim.get();
+  cfg.idle          = run.paced ? simIdle : nullptr;
+  cfg.idleContext   = sim.get();
+  cfg.scratch       = sScratch.data();
+  cfg.scratchSize   = sScratch.size();
+  cfg.addressOffset = 0;
+
+  auto result = std::make_unique<Trace::ReplayResult>();
+  Trace::replay( records.data(), records.size(), *dut, cfg, *result );
+  dut->close();
+
+  /*-------------------------------------------------
+  Report
+  -------------------------------------------------*/
+  uint64_t bytes = 0;
+  for ( auto &op : result->ops )
+  {
+    bytes += op.bytes;
+  }
+
+  uint32_t maxWear = 0;
+  for ( size_t x = 0; x < sim->numEraseUnits(); x++ )
+  {
+    maxWear = std::max( maxWear, sim->eraseCount( x ) );
+  }
+
+  const auto devStats  = sim->getStats();
+  const double seconds = static_cast<double>( result->elapsed ) / 1e6;
+
+  printf( "\n== %s / %s timing%s%s ==\n", geometry.name, timing.name, run.eraseMap ? " / erase map" : "",
+          run.paced ? " / paced" : "" );
+  printf( "ops %zu (failed %zu), elapsed %.3f s, throughput %.1f KiB/s\n", result->replayed, result->failed, seconds,
+          seconds > 0.0 ? ( static_cast<double>( bytes ) / 1024.0 ) / seconds : 0.0 );
+  printf( "device erase cmds %zu, chip erases %zu, max unit wear %u\n", devStats.erases, devStats.chipErases, maxWear );
+  printf( "%-12s %8s %10s %10s %10s %10s %10s\n", "op", "count", "mean_us", "p50_us", "p99_us", "p999_us", "max_us" );
+
+  for ( size_t x = 0; x < std::size( OpNames ); x++ )
+  {
+    auto &lat = result->ops[ x ].latency;
+    if ( !lat.count() )
+    {
+      continue;
+    }
+
+    printf( "%-12s %8llu %10.1f %10u %10u %10u %10u\n", OpNames[ x ], static_cast<unsigned long long>( lat.count() ),
+            lat.mean(), lat.percentile( 0.50 ), lat.percentile( 0.99 ), lat.percentile( 0.999 ), lat.max() );
+  }
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  /*-------------------------------------------------
+  Parse the command line
+  -------------------------------------------------*/
+  const char *path = nullptr;
+  bool singleModel = false;
+  RunConfig single = { Sim::Model::AT25SF081, false, false, false };
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && ( ( x + 1 ) < argc ) )
+    {
+      if ( !parseModel( argv[ ++x ], single.model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+
+      singleModel = true;
+    }
+    else if ( strcmp( argv[ x ], "--ideal" ) == 0 )
+    {
+      single.ideal = true;
+    }
+    else if ( strcmp( argv[ x ], "--erase-map" ) == 0 )
+    {
+      single.eraseMap = true;
+    }
+    else if ( strcmp( argv[ x ], "--paced" ) == 0 )
+    {
+      single.paced = true;
+    }
+    else
+    {
+      path = argv[ x ];
+    }
+  }
+
+  if ( !path )
+  {
+    fprintf( stderr, "Usage: %s [--model NAME] [--ideal] [--erase-map] [--paced] capture_file\n", argv[ 0 ] );
+    fprintf( stderr, "  Operations run back to back unless --paced replays the captured idle time\n" );
+    return 1;
+  }
+
+  /*-------------------------------------------------
+  Load the capture
+  -------------------------------------------------*/
+  FILE *input = fopen( path, "rb" );
+  if ( !input )
+  {
+    fprintf( stderr, "Unable to open %s\n", path );
+    return 1;
+  }
+
+  std::vector<uint8_t> stream;
+  std::array<uint8_t, 4096> chunk;
+  size_t bytesRead = 0;
+
+  while ( ( bytesRead = fread( chunk.data(), 1, chunk.size(), input ) ) > 0 )
+  {
+    stream.insert( stream.end(), chunk.begin(), chunk.begin() + bytesRead );
+  }
+  fclose( input );
+
+  std::vector<Trace::Record> records;
+  auto parsed =
+      Trace::parseStream( stream.data(), stream.size(), [ & ]( const Trace::Record &rec ) { records.push_back( rec ); } );
+  printf( "Loaded %zu records from %zu frames (%zu rejected)\n", parsed.records, parsed.frames, parsed.rejected );
+
+  /*-------------------------------------------------
+  Run the requested configurations
+  -------------------------------------------------*/
+  if ( singleModel )
+  {
+    runConfig( single, records );
+    return 0;
+  }
+
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    const auto model = static_cast<Sim::Model>( x );
+
+    if ( !single.eraseMap )
+    {
+      runConfig( { model, single.ideal, false, single.paced }, records );
+    }
+
+    runConfig( { model, single.ideal, true, single.paced }, records );
+  }
+
+  return 0;
+}
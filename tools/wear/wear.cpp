@@ -0,0 +1,306 @@
+/********************************************************************************
+ *  File Name:
+ *    wear.cpp
+ *
+ *  Description:
+ *    Host tool comparing device lifetime with and without the wear aware
+ *    allocator. A few hot files are rewritten over and over while cold data
+ *    fills the rest of the part, until the first erase unit reaches its
+ *    rated endurance. Throughput is measured on the simulator's clock.
+ *
+ *    The erase count spread covers the units files can live in. The
+ *    allocator's table units aren't leveled, they are erased once every
+ *    other sync(), so their wear is reported on its own and ends the run
+ *    too if it reaches the endurance first.
+ *
+ *    Usage: wear [--model NAME] [--endurance N] [--cold PERCENT] [--hot N] [--sync N]
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Adesto Includes */
+#include <src/sim/sim_device.hpp>
+#include <src/wear/wear.hpp>
+
+using namespace Adesto;
+using namespace Aurora::Memory;
+
+/*-------------------------------------------------------------------------------
+Structures
+-------------------------------------------------------------------------------*/
+struct Options
+{
+  Sim::Model model;
+  uint32_t endurance;
+  size_t coldPercent;
+  size_t hotFiles;
+  size_t syncInterval;
+};
+
+struct Outcome
+{
+  size_t rewrites;
+  uint64_t elapsedUs;
+  uint32_t minErase;
+  uint32_t maxErase;
+  uint32_t tableErase; /**< Most worn table unit, allocator only */
+  size_t relocations;
+};
+
+/*-------------------------------------------------------------------------------
+Static Data
+-------------------------------------------------------------------------------*/
+static constexpr size_t CHECK_INTERVAL = 64; /**< Rewrites between endurance checks */
+
+static std::vector<size_t> files; /**< File number -> unit holding it */
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static void wearSpread( Sim::Device &sim, const size_t first, uint32_t &least, uint32_t &most )
+{
+  least = UINT32_MAX;
+  most  = 0;
+
+  for ( size_t unit = first; unit < sim.numEraseUnits(); unit++ )
+  {
+    least = std::min( least, sim.eraseCount( unit ) );
+    most  = std::max( most, sim.eraseCount( unit ) );
+  }
+}
+
+
+static void relocated( void *context, const size_t from, const size_t to )
+{
+  for ( auto &unit : files )
+  {
+    if ( unit == from )
+    {
+      unit = to;
+      return;
+    }
+  }
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+/**
+ *  Files live at fixed addresses, one erase unit each, the way applications
+ *  lay out flash today. Each rewrite erases the file's unit in place.
+ */
+static Outcome runFixed( const Options &options )
+{
+  Sim::Device sim( options.model );
+  auto props           = sim.getDeviceProperties();
+  const size_t unit    = chunkSize( props, props.eraseChunk );
+  const size_t numCold = ( sim.numEraseUnits() * options.coldPercent ) / 100;
+
+  std::vector<uint8_t> page( props.pageSize, 0xA5 );
+  for ( size_t x = 0; x < numCold; x++ )
+  {
+    sim.write( ( options.hotFiles + x ) * unit, page.data(), page.size() );
+  }
+
+  Outcome outcome      = {};
+  const uint64_t start = sim.now();
+
+  while ( true )
+  {
+    const size_t address = ( outcome.rewrites % options.hotFiles ) * unit;
+    sim.erase( address, unit );
+    sim.write( address, page.data(), page.size() );
+    outcome.rewrites++;
+
+    if ( sim.eraseCount( address / props.blockSize ) >= options.endurance )
+    {
+      break;
+    }
+  }
+
+  outcome.elapsedUs = sim.now() - start;
+  wearSpread( sim, 0, outcome.minErase, outcome.maxErase );
+  return outcome;
+}
+
+
+/**
+ *  Every rewrite goes to a freshly allocated unit and the old copy is freed
+ */
+static Outcome runAllocator( const Options &options )
+{
+  auto sim   = std::make_shared<Sim::Device>( options.model );
+  auto props = sim->getDeviceProperties();
+
+  Wear::Config config;
+  config.bucketSize      = Wear::DEFAULT_BUCKET_SIZE;
+  config.staticThreshold = std::max<uint32_t>( options.endurance / 64, Wear::DEFAULT_BUCKET_SIZE );
+  config.staticInterval  = Wear::DEFAULT_INTERVAL;
+  config.relocate        = relocated;
+  config.relocateContext = nullptr;
+
+  Wear::Allocator allocator( sim );
+  Outcome outcome = {};
+
+  if ( allocator.open( config ) != Status::ERR_OK )
+  {
+    return outcome;
+  }
+
+  /*-------------------------------------------------
+  Cold files first, then the hot ones behind them
+  -------------------------------------------------*/
+  const size_t numCold = ( sim->numEraseUnits() * options.coldPercent ) / 100;
+  std::vector<uint8_t> page( props.pageSize, 0xA5 );
+  files.assign( numCold + options.hotFiles, 0 );
+
+  for ( auto &unit : files )
+  {
+    allocator.allocate( unit );
+    sim->write( allocator.unitAddress( unit ), page.data(), page.size() );
+  }
+
+  const uint64_t start = sim->now();
+  const size_t first   = allocator.firstUnit();
+  uint32_t least       = 0;
+  uint32_t most        = 0;
+
+  while ( std::max( most, allocator.tableEraseCount() ) < options.endurance )
+  {
+    auto &file  = files[ numCold + ( outcome.rewrites % options.hotFiles ) ];
+    size_t next = 0;
+
+    if ( allocator.allocate( next ) != Status::ERR_OK )
+    {
+      fprintf( stderr, "Ran out of free units\n" );
+      break;
+    }
+
+    sim->write( allocator.unitAddress( next ), page.data(), page.size() );
+    allocator.release( file );
+    file = next;
+    outcome.rewrites++;
+
+    if ( !( outcome.rewrites % options.syncInterval ) )
+    {
+      allocator.sync();
+    }
+
+    if ( !( outcome.rewrites % CHECK_INTERVAL ) )
+    {
+      wearSpread( *sim, first, least, most );
+    }
+  }
+
+  outcome.elapsedUs   = sim->now() - start;
+  outcome.relocations = allocator.getStats().relocations;
+  outcome.tableErase  = allocator.tableEraseCount();
+  wearSpread( *sim, first, outcome.minErase, outcome.maxErase );
+  return outcome;
+}
+
+
+static void report( const char *name, const Outcome &outcome )
+{
+  const double seconds = static_cast<double>( outcome.elapsedUs ) / 1e6;
+
+  printf( "%-10s rewrites %10zu  sim time %10.1f s  rewrites/s %8.1f  erase min/max %6u/%6u  table %6u  moves %zu\n",
+          name, outcome.rewrites, seconds, seconds > 0.0 ? outcome.rewrites / seconds : 0.0, outcome.minErase,
+          outcome.maxErase, outcome.tableErase, outcome.relocations );
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  /*-------------------------------------------------
+  Parse the command line. Real parts are rated for
+  100k cycles, the default keeps runs short. Lifetime
+  scales linearly with it.
+  -------------------------------------------------*/
+  Options options      = {};
+  options.model        = Sim::Model::AT25SF081;
+  options.endurance    = 2000;
+  options.coldPercent  = 50;
+  options.hotFiles     = 4;
+  options.syncInterval = 1000;
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    const bool hasValue = ( x + 1 ) < argc;
+
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && hasValue )
+    {
+      if ( !parseModel( argv[ ++x ], options.model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( ( strcmp( argv[ x ], "--endurance" ) == 0 ) && hasValue )
+    {
+      options.endurance = static_cast<uint32_t>( strtoul( argv[ ++x ], nullptr, 0 ) );
+    }
+    else if ( ( strcmp( argv[ x ], "--cold" ) == 0 ) && hasValue )
+    {
+      options.coldPercent = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--hot" ) == 0 ) && hasValue )
+    {
+      options.hotFiles = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else if ( ( strcmp( argv[ x ], "--sync" ) == 0 ) && hasValue )
+    {
+      options.syncInterval = strtoul( argv[ ++x ], nullptr, 0 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: wear [--model NAME] [--endurance N] [--cold PERCENT] [--hot N] [--sync N]\n" );
+      return 1;
+    }
+  }
+
+  if ( !options.endurance || !options.hotFiles || !options.syncInterval || ( options.coldPercent > 90 ) )
+  {
+    fprintf( stderr, "Invalid options\n" );
+    return 1;
+  }
+
+  printf( "%s, endurance %u, %zu%% cold, %zu hot files\n", Sim::getGeometry( options.model ).name, options.endurance,
+          options.coldPercent, options.hotFiles );
+
+  const auto fixed     = runFixed( options );
+  const auto allocated = runAllocator( options );
+
+  report( "fixed", fixed );
+  report( "allocator", allocated );
+
+  if ( fixed.rewrites )
+  {
+    printf( "lifetime x%.1f\n", static_cast<double>( allocated.rewrites ) / fixed.rewrites );
+  }
+
+  return 0;
+}
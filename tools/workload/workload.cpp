@@ -0,0 +1,144 @@
+/********************************************************************************
+ *  File Name:
+ *    workload.cpp
+ *
+ *  Description:
+ *    Host tool that runs workload jobs against the simulated devices. Latency
+ *    is measured on the simulator's virtual clock, so results are repeatable
+ *    and reflect the modeled part rather than the host machine.
+ *
+ *    Usage: workload [--model NAME] [--ideal] [--erase-map] [job ...]
+ *
+ *    With no jobs given, every standard job is run.
+ *
+ *  2020 | Brandon Braun | brandonbraun653@gmail.com
+ *******************************************************************************/
+
+/* STL Includes */
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* Adesto Includes */
+#include <src/erase_map/erase_map.hpp>
+#include <src/sim/sim_device.hpp>
+#include <src/workload/workload.hpp>
+
+using namespace Adesto;
+
+/*-------------------------------------------------------------------------------
+Static Functions
+-------------------------------------------------------------------------------*/
+static uint64_t simClock( void *context )
+{
+  return static_cast<Sim::Device *>( context )->now();
+}
+
+
+static void emitLine( const char *const line )
+{
+  printf( "%s\n", line );
+}
+
+
+static bool parseModel( const char *name, Sim::Model &model )
+{
+  for ( size_t x = 0; x < static_cast<size_t>( Sim::Model::NUM_OPTIONS ); x++ )
+  {
+    if ( strcmp( name, Sim::getGeometry( static_cast<Sim::Model>( x ) ).name ) == 0 )
+    {
+      model = static_cast<Sim::Model>( x );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*-------------------------------------------------------------------------------
+Public Functions
+-------------------------------------------------------------------------------*/
+int main( int argc, char **argv )
+{
+  /*-------------------------------------------------
+  Parse the command line
+  -------------------------------------------------*/
+  Sim::Model model = Sim::Model::AT25SF081;
+  bool ideal       = false;
+  bool eraseMap    = false;
+  std::vector<const char *> names;
+
+  for ( int x = 1; x < argc; x++ )
+  {
+    if ( ( strcmp( argv[ x ], "--model" ) == 0 ) && ( ( x + 1 ) < argc ) )
+    {
+      if ( !parseModel( argv[ ++x ], model ) )
+      {
+        fprintf( stderr, "Unknown model %s\n", argv[ x ] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[ x ], "--ideal" ) == 0 )
+    {
+      ideal = true;
+    }
+    else if ( strcmp( argv[ x ], "--erase-map" ) == 0 )
+    {
+      eraseMap = true;
+    }
+    else
+    {
+      names.push_back( argv[ x ] );
+    }
+  }
+
+  /*-------------------------------------------------
+  Run each selected job on a fresh device so earlier
+  jobs can't influence later ones.
+  -------------------------------------------------*/
+  size_t numJobs = 0;
+  auto jobs      = Workload::standardJobs( numJobs );
+  int exitCode   = 0;
+
+  for ( size_t x = 0; x < numJobs; x++ )
+  {
+    bool selected = names.empty();
+    for ( auto name : names )
+    {
+      selected |= ( strcmp( name, jobs[ x ].name ) == 0 );
+    }
+
+    if ( !selected )
+    {
+      continue;
+    }
+
+    auto &geometry = Sim::getGeometry( model );
+    auto &timing   = ideal ? Sim::getIdealTiming() : Sim::getTiming( model );
+    auto sim       = std::make_shared<Sim::Device>( geometry, timing );
+
+    Aurora::Memory::IGenericDevice_sPtr dut = sim;
+    if ( eraseMap )
+    {
+      dut = std::make_shared<EraseMap::Device>( sim );
+    }
+
+    dut->open();
+
+    auto result       = std::make_unique<Workload::Result>();
+    const auto status = Workload::run( jobs[ x ], dut, simClock, sim.get(), *result );
+    dut->close();
+
+    if ( status == Aurora::Memory::Status::ERR_BAD_ARG )
+    {
+      fprintf( stderr, "%s: job is not valid for %s\n", jobs[ x ].name, geometry.name );
+      exitCode = 1;
+      continue;
+    }
+
+    Workload::report( jobs[ x ], *result, emitLine );
+  }
+
+  return exitCode;
+}